@@ -0,0 +1,39 @@
+# Generates a header with every compiled shader as a constexpr array of
+# SPIR-V words, plus a table to look them up by their asset path.
+#
+# Run in script mode:
+#   cmake -DOUTPUT=EmbeddedShaders.hpp -DSHADER_DIR=<dir> -DSHADERS="a.spv;b.spv" -P EmbedShaders.cmake
+
+SET( CONTENTS "// Generated by cmake/EmbedShaders.cmake. Do not edit.\n\n" )
+STRING( APPEND CONTENTS "#ifndef CRIMILD_VULKAN_EMBEDDED_SHADERS_\n#define CRIMILD_VULKAN_EMBEDDED_SHADERS_\n\n" )
+STRING( APPEND CONTENTS "#include <cstddef>\n#include <cstdint>\n\n" )
+STRING( APPEND CONTENTS "namespace crimild {\n\n\tnamespace vulkan {\n\n\t\tnamespace embedded {\n\n" )
+
+SET( TABLE "" )
+SET( INDEX 0 )
+
+FOREACH( SHADER ${SHADERS} )
+	FILE( READ "${SHADER_DIR}/${SHADER}" HEX HEX )
+
+	# SPIR-V is little-endian, so swap bytes to build each 32-bit word
+	STRING( REGEX REPLACE "([0-9a-f][0-9a-f])([0-9a-f][0-9a-f])([0-9a-f][0-9a-f])([0-9a-f][0-9a-f])" "0x\\4\\3\\2\\1," WORDS "${HEX}" )
+	SET( WORD "0x[0-9a-f]+," )
+	STRING( REGEX REPLACE "(${WORD}${WORD}${WORD}${WORD}${WORD}${WORD}${WORD}${WORD})" "\\1\n\t\t\t\t" WORDS "${WORDS}" )
+
+	STRING( APPEND CONTENTS "\t\t\tconstexpr std::uint32_t SHADER_${INDEX}[] = {\n\t\t\t\t${WORDS}\n\t\t\t};\n\n" )
+	STRING( APPEND TABLE "\t\t\t\t{ \"assets/shaders/${SHADER}\", SHADER_${INDEX}, sizeof( SHADER_${INDEX} ) },\n" )
+
+	MATH( EXPR INDEX "${INDEX} + 1" )
+ENDFOREACH()
+
+STRING( APPEND CONTENTS "\t\t\tstruct Shader {\n\t\t\t\tconst char *path;\n\t\t\t\tconst std::uint32_t *code;\n\t\t\t\tstd::size_t size;\n\t\t\t};\n\n" )
+STRING( APPEND CONTENTS "\t\t\tconstexpr Shader SHADERS[] = {\n${TABLE}\t\t\t};\n\n" )
+STRING( APPEND CONTENTS "\t\t}\n\n\t}\n\n}\n\n#endif\n" )
+
+# Only touch the header when shaders change, to avoid needless rebuilds
+IF ( EXISTS "${OUTPUT}" )
+	FILE( READ "${OUTPUT}" PREVIOUS )
+ENDIF ()
+IF ( NOT "${PREVIOUS}" STREQUAL "${CONTENTS}" )
+	FILE( WRITE "${OUTPUT}" "${CONTENTS}" )
+ENDIF ()
@@ -0,0 +1,16 @@
+# Copies compiled shaders over the prebuilt ones in the source tree and
+# records the hash of each GLSL source they were compiled from, so builds
+# without glslc can tell when a prebuilt binary is out of date.
+#
+# Run in script mode:
+#   cmake -DSOURCE_DIR=<src> -DSHADER_DIR=<dir> -DPREBUILT_DIR=<dir> -DSHADERS="a.vert;b.frag" -P UpdatePrebuiltShaders.cmake
+
+SET( MANIFEST "" )
+
+FOREACH( SHADER ${SHADERS} )
+	EXECUTE_PROCESS( COMMAND ${CMAKE_COMMAND} -E copy_if_different "${SHADER_DIR}/${SHADER}.spv" "${PREBUILT_DIR}/${SHADER}.spv" )
+	FILE( SHA256 "${SOURCE_DIR}/${SHADER}" HASH )
+	STRING( APPEND MANIFEST "${HASH}  ${SHADER}\n" )
+ENDFOREACH()
+
+FILE( WRITE "${PREBUILT_DIR}/sources.sha256" "${MANIFEST}" )
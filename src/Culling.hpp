@@ -0,0 +1,394 @@
+/*
+ * Copyright (c) 2002 - present, H. Hernan Saez
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the <organization> nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL <COPYRIGHT HOLDER> BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef CRIMILD_VULKAN_CULLING_
+#define CRIMILD_VULKAN_CULLING_
+
+#include "IndirectDraws.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+namespace crimild {
+
+	namespace vulkan {
+
+		/**
+		   \brief CPU reference for visibility culling
+
+		   Everything here mirrors what the culling compute shaders do (see
+		   cull.comp and depth_pyramid*.comp), so results computed on the GPU can be
+		   validated without reading back anything but the output.
+
+		   Matrices are 16 floats in column-major order (as in GLSL), and clip
+		   space follows Vulkan conventions (depth in [0, 1], y pointing down).
+		 */
+		namespace culling {
+
+			/**
+			   \brief Points p with dot( normal, p ) + distance >= 0 are inside
+			 */
+			struct Plane {
+				float normal[ 3 ];
+				float distance;
+			};
+
+			enum FrustumPlane : std::uint32_t {
+				PLANE_LEFT,
+				PLANE_RIGHT,
+				PLANE_BOTTOM,
+				PLANE_TOP,
+				PLANE_NEAR,
+				PLANE_FAR,
+				PLANE_COUNT,
+			};
+
+			struct Sphere {
+				float center[ 3 ];
+				float radius;
+			};
+
+			/**
+			   \brief One object to be culled, as seen by cull.comp (std430 layout)
+
+			   Visible objects get their command appended to the range of their
+			   batch, starting at batchFirstCommand, and increment the draw count
+			   for that batch.
+			 */
+			struct CullObject {
+				Sphere sphere;
+				DrawIndexedIndirectCommand command;
+				std::uint32_t batch;
+				std::uint32_t batchFirstCommand;
+				std::uint32_t padding;
+			};
+
+			static_assert( sizeof( CullObject ) == 48, "Must match std430 layout in cull.comp" );
+
+			inline void multiply( const float *a, const float *b, float *out )
+			{
+				for ( auto col = 0; col < 4; ++col ) {
+					for ( auto row = 0; row < 4; ++row ) {
+						auto sum = 0.0f;
+						for ( auto k = 0; k < 4; ++k ) {
+							sum += a[ k * 4 + row ] * b[ col * 4 + k ];
+						}
+						out[ col * 4 + row ] = sum;
+					}
+				}
+			}
+
+			/**
+			   \brief Extracts world space frustum planes from a view-projection matrix
+
+			   Planes are normalized, so distances to them are in world units.
+			 */
+			inline void extractFrustumPlanes( const float *viewProj, Plane *planes )
+			{
+				auto row = [ viewProj ]( int r, int c ) { return viewProj[ c * 4 + r ]; };
+
+				// Combines rows of the matrix as in Gribb & Hartmann
+				auto set = [ &row, planes ]( FrustumPlane plane, float wSign, int r, float sign ) {
+					float p[ 4 ];
+					for ( auto c = 0; c < 4; ++c ) {
+						p[ c ] = wSign * row( 3, c ) + sign * row( r, c );
+					}
+					auto length = std::sqrt( p[ 0 ] * p[ 0 ] + p[ 1 ] * p[ 1 ] + p[ 2 ] * p[ 2 ] );
+					planes[ plane ] = Plane { { p[ 0 ] / length, p[ 1 ] / length, p[ 2 ] / length }, p[ 3 ] / length };
+				};
+
+				set( PLANE_LEFT, 1.0f, 0, 1.0f );
+				set( PLANE_RIGHT, 1.0f, 0, -1.0f );
+				set( PLANE_BOTTOM, 1.0f, 1, 1.0f );
+				set( PLANE_TOP, 1.0f, 1, -1.0f );
+
+				// Depth goes from 0 to 1, so the near plane is just z >= 0
+				set( PLANE_NEAR, 0.0f, 2, 1.0f );
+				set( PLANE_FAR, 1.0f, 2, -1.0f );
+			}
+
+			inline bool isSphereInFrustum( const Plane *planes, const Sphere &sphere )
+			{
+				for ( std::uint32_t i = 0; i < PLANE_COUNT; ++i ) {
+					const auto &plane = planes[ i ];
+					auto distance = plane.normal[ 0 ] * sphere.center[ 0 ]
+						+ plane.normal[ 1 ] * sphere.center[ 1 ]
+						+ plane.normal[ 2 ] * sphere.center[ 2 ]
+						+ plane.distance;
+					if ( distance < -sphere.radius ) {
+						return false;
+					}
+				}
+				return true;
+			}
+
+			/**
+			   \brief Transforms a sphere by a model matrix
+
+			   Scale is assumed to be uniform-ish, so the radius grows by the largest
+			   axis scale to stay conservative.
+			 */
+			inline Sphere transformSphere( const float *model, const Sphere &sphere )
+			{
+				Sphere result;
+				for ( auto r = 0; r < 3; ++r ) {
+					result.center[ r ] = model[ 0 * 4 + r ] * sphere.center[ 0 ]
+						+ model[ 1 * 4 + r ] * sphere.center[ 1 ]
+						+ model[ 2 * 4 + r ] * sphere.center[ 2 ]
+						+ model[ 3 * 4 + r ];
+				}
+
+				auto maxScale = 0.0f;
+				for ( auto c = 0; c < 3; ++c ) {
+					auto scale = model[ c * 4 + 0 ] * model[ c * 4 + 0 ] + model[ c * 4 + 1 ] * model[ c * 4 + 1 ] + model[ c * 4 + 2 ] * model[ c * 4 + 2 ];
+					maxScale = std::max( maxScale, scale );
+				}
+				result.radius = sphere.radius * std::sqrt( maxScale );
+
+				return result;
+			}
+
+			inline std::uint32_t previousPowerOfTwo( std::uint32_t value )
+			{
+				std::uint32_t result = 1;
+				while ( result * 2 <= value ) {
+					result *= 2;
+				}
+				return result;
+			}
+
+			/**
+			   \brief Hierarchical depth buffer
+
+			   Each texel holds the farthest depth of the area it covers. Level 0 is
+			   the largest power of two not bigger than the depth buffer, so every
+			   level is exactly half the size of the previous one.
+			 */
+			struct DepthPyramid {
+				std::uint32_t width = 0;
+				std::uint32_t height = 0;
+				std::vector< std::vector< float > > levels;
+
+				static std::uint32_t getLevelCount( std::uint32_t width, std::uint32_t height )
+				{
+					std::uint32_t levels = 1;
+					while ( ( width >> levels ) > 0 || ( height >> levels ) > 0 ) {
+						++levels;
+					}
+					return levels;
+				}
+
+				std::uint32_t getLevelWidth( std::uint32_t level ) const { return std::max( 1u, width >> level ); }
+				std::uint32_t getLevelHeight( std::uint32_t level ) const { return std::max( 1u, height >> level ); }
+
+				float fetch( std::uint32_t level, std::uint32_t x, std::uint32_t y ) const
+				{
+					return levels[ level ][ y * getLevelWidth( level ) + x ];
+				}
+			};
+
+			/**
+			   \brief Reduces a depth buffer into a pyramid (see depth_pyramid_init.comp
+			   and depth_pyramid.comp)
+			 */
+			inline DepthPyramid buildDepthPyramid( const float *depth, std::uint32_t depthWidth, std::uint32_t depthHeight )
+			{
+				DepthPyramid pyramid;
+				pyramid.width = previousPowerOfTwo( depthWidth );
+				pyramid.height = previousPowerOfTwo( depthHeight );
+				pyramid.levels.resize( DepthPyramid::getLevelCount( pyramid.width, pyramid.height ) );
+
+				// Level 0 covers the whole depth buffer, so each texel takes the max of its footprint
+				auto &base = pyramid.levels[ 0 ];
+				base.resize( pyramid.width * pyramid.height );
+				for ( std::uint32_t y = 0; y < pyramid.height; ++y ) {
+					auto y0 = y * depthHeight / pyramid.height;
+					auto y1 = std::min( depthHeight, ( ( y + 1 ) * depthHeight + pyramid.height - 1 ) / pyramid.height );
+					for ( std::uint32_t x = 0; x < pyramid.width; ++x ) {
+						auto x0 = x * depthWidth / pyramid.width;
+						auto x1 = std::min( depthWidth, ( ( x + 1 ) * depthWidth + pyramid.width - 1 ) / pyramid.width );
+						auto farthest = 0.0f;
+						for ( auto sy = y0; sy < y1; ++sy ) {
+							for ( auto sx = x0; sx < x1; ++sx ) {
+								farthest = std::max( farthest, depth[ sy * depthWidth + sx ] );
+							}
+						}
+						base[ y * pyramid.width + x ] = farthest;
+					}
+				}
+
+				for ( std::uint32_t level = 1; level < pyramid.levels.size(); ++level ) {
+					auto width = pyramid.getLevelWidth( level );
+					auto height = pyramid.getLevelHeight( level );
+					auto srcWidth = pyramid.getLevelWidth( level - 1 );
+					auto srcHeight = pyramid.getLevelHeight( level - 1 );
+					pyramid.levels[ level ].resize( width * height );
+					for ( std::uint32_t y = 0; y < height; ++y ) {
+						for ( std::uint32_t x = 0; x < width; ++x ) {
+							auto x0 = std::min( 2 * x, srcWidth - 1 );
+							auto x1 = std::min( 2 * x + 1, srcWidth - 1 );
+							auto y0 = std::min( 2 * y, srcHeight - 1 );
+							auto y1 = std::min( 2 * y + 1, srcHeight - 1 );
+							pyramid.levels[ level ][ y * width + x ] = std::max(
+								std::max( pyramid.fetch( level - 1, x0, y0 ), pyramid.fetch( level - 1, x1, y0 ) ),
+								std::max( pyramid.fetch( level - 1, x0, y1 ), pyramid.fetch( level - 1, x1, y1 ) )
+							);
+						}
+					}
+				}
+
+				return pyramid;
+			}
+
+			/**
+			   \brief Screen space bounds of a sphere
+
+			   Projects the corners of the box enclosing the sphere. Returns false if
+			   the sphere crosses the near plane, in which case there are no
+			   meaningful bounds and the sphere must be considered visible.
+			 */
+			inline bool projectSphere( const float *viewProj, const Sphere &sphere, float *uvMin, float *uvMax, float &nearestDepth )
+			{
+				uvMin[ 0 ] = uvMin[ 1 ] = 1.0f;
+				uvMax[ 0 ] = uvMax[ 1 ] = 0.0f;
+				nearestDepth = 1.0f;
+
+				for ( auto corner = 0; corner < 8; ++corner ) {
+					float p[ 3 ] = {
+						sphere.center[ 0 ] + ( ( corner & 1 ) ? sphere.radius : -sphere.radius ),
+						sphere.center[ 1 ] + ( ( corner & 2 ) ? sphere.radius : -sphere.radius ),
+						sphere.center[ 2 ] + ( ( corner & 4 ) ? sphere.radius : -sphere.radius ),
+					};
+
+					float clip[ 4 ];
+					for ( auto r = 0; r < 4; ++r ) {
+						clip[ r ] = viewProj[ 0 * 4 + r ] * p[ 0 ] + viewProj[ 1 * 4 + r ] * p[ 1 ] + viewProj[ 2 * 4 + r ] * p[ 2 ] + viewProj[ 3 * 4 + r ];
+					}
+
+					if ( clip[ 3 ] <= 0.0f || clip[ 2 ] < 0.0f ) {
+						return false;
+					}
+
+					for ( auto axis = 0; axis < 2; ++axis ) {
+						auto uv = std::clamp( 0.5f * clip[ axis ] / clip[ 3 ] + 0.5f, 0.0f, 1.0f );
+						uvMin[ axis ] = std::min( uvMin[ axis ], uv );
+						uvMax[ axis ] = std::max( uvMax[ axis ], uv );
+					}
+					nearestDepth = std::min( nearestDepth, clip[ 2 ] / clip[ 3 ] );
+				}
+
+				return true;
+			}
+
+			/**
+			   \brief Tests a sphere against a depth pyramid built with the same view-projection
+
+			   Picks the level where the sphere's bounds cover at most 2x2 texels and
+			   compares its nearest depth against the farthest one in them.
+			 */
+			inline bool isSphereOccluded( const DepthPyramid &pyramid, const float *viewProj, const Sphere &sphere )
+			{
+				float uvMin[ 2 ];
+				float uvMax[ 2 ];
+				float nearestDepth;
+				if ( !projectSphere( viewProj, sphere, uvMin, uvMax, nearestDepth ) ) {
+					return false;
+				}
+
+				auto extent = std::max( ( uvMax[ 0 ] - uvMin[ 0 ] ) * pyramid.width, ( uvMax[ 1 ] - uvMin[ 1 ] ) * pyramid.height );
+				auto level = static_cast< std::uint32_t >( std::clamp( std::ceil( std::log2( std::max( extent, 1.0f ) ) ), 0.0f, float( pyramid.levels.size() - 1 ) ) );
+
+				auto width = pyramid.getLevelWidth( level );
+				auto height = pyramid.getLevelHeight( level );
+				auto x0 = std::min( static_cast< std::uint32_t >( uvMin[ 0 ] * width ), width - 1 );
+				auto x1 = std::min( static_cast< std::uint32_t >( uvMax[ 0 ] * width ), width - 1 );
+				auto y0 = std::min( static_cast< std::uint32_t >( uvMin[ 1 ] * height ), height - 1 );
+				auto y1 = std::min( static_cast< std::uint32_t >( uvMax[ 1 ] * height ), height - 1 );
+
+				auto farthest = std::max(
+					std::max( pyramid.fetch( level, x0, y0 ), pyramid.fetch( level, x1, y0 ) ),
+					std::max( pyramid.fetch( level, x0, y1 ), pyramid.fetch( level, x1, y1 ) )
+				);
+
+				return nearestDepth > farthest;
+			}
+
+			/**
+			   \brief Culls objects and compacts visible ones into indirect commands (see cull.comp)
+
+			   Commands are written in object order, while the GPU appends them in any
+			   order. Use sortBatchCommands() before comparing both.
+
+			   \param pyramid Depth pyramid from the previous frame, or null to skip occlusion culling
+			   \param pyramidViewProj View-projection used to render the pyramid
+			 */
+			inline void cullObjects(
+				const CullObject *objects,
+				std::uint32_t objectCount,
+				const Plane *planes,
+				const DepthPyramid *pyramid,
+				const float *pyramidViewProj,
+				DrawIndexedIndirectCommand *commands,
+				std::uint32_t *counts )
+			{
+				for ( std::uint32_t i = 0; i < objectCount; ++i ) {
+					const auto &object = objects[ i ];
+					if ( !isSphereInFrustum( planes, object.sphere ) ) {
+						continue;
+					}
+					if ( pyramid != nullptr && isSphereOccluded( *pyramid, pyramidViewProj, object.sphere ) ) {
+						continue;
+					}
+					commands[ object.batchFirstCommand + counts[ object.batch ]++ ] = object.command;
+				}
+			}
+
+			/**
+			   \brief Orders commands by instance, which is unique for every object
+			 */
+			inline bool compareCommands( const DrawIndexedIndirectCommand &a, const DrawIndexedIndirectCommand &b )
+			{
+				return a.firstInstance != b.firstInstance ? a.firstInstance < b.firstInstance : a.firstIndex < b.firstIndex;
+			}
+
+			/**
+			   \brief Sorts the commands written for a batch, so results can be compared
+			 */
+			inline void sortBatchCommands( DrawIndexedIndirectCommand *commands, std::uint32_t batchFirstCommand, std::uint32_t count )
+			{
+				std::sort( commands + batchFirstCommand, commands + batchFirstCommand + count, compareCommands );
+			}
+
+		}
+
+	}
+
+}
+
+#endif
@@ -0,0 +1,192 @@
+/*
+ * Copyright (c) 2002 - present, H. Hernan Saez
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the <organization> nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL <COPYRIGHT HOLDER> BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef CRIMILD_VULKAN_INDIRECT_DRAWS_
+#define CRIMILD_VULKAN_INDIRECT_DRAWS_
+
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace crimild {
+
+	namespace vulkan {
+
+		/**
+		   \brief Layout matches VkDrawIndexedIndirectCommand, so commands can be
+		   copied into indirect buffers as they are
+		 */
+		struct DrawIndexedIndirectCommand {
+			std::uint32_t indexCount;
+			std::uint32_t instanceCount;
+			std::uint32_t firstIndex;
+			std::int32_t vertexOffset;
+			std::uint32_t firstInstance;
+		};
+
+		static_assert( sizeof( DrawIndexedIndirectCommand ) == 20, "Must match VkDrawIndexedIndirectCommand" );
+
+		/**
+		   \brief Generates indirect draw arguments from a draw list
+
+		   This is the CPU reference for indirect argument generation. It doesn't
+		   depend on Vulkan, so its output can be checked without a GPU and used
+		   to validate arguments produced by compute shaders.
+
+		   Draws sharing a batch key (i.e. a pipeline) must be added one after
+		   the other. Each run of them becomes a batch, which is submitted with
+		   a single indirect draw call. Batches are split so none of them has
+		   more commands than the device can draw with a single call.
+		 */
+		template< typename BatchKey >
+		class IndirectDrawBuilder {
+		public:
+			struct Draw {
+				BatchKey batchKey;
+				std::uint32_t indexCount;
+				std::uint32_t firstIndex;
+				std::int32_t vertexOffset;
+				std::uint32_t instanceCount;
+				std::uint32_t firstInstance;
+			};
+
+			struct Batch {
+				BatchKey batchKey;
+				std::uint32_t firstCommand;
+				std::uint32_t commandCount;
+			};
+
+		public:
+			explicit IndirectDrawBuilder( std::uint32_t maxCommandsPerBatch = UINT32_MAX )
+				: m_maxCommandsPerBatch( maxCommandsPerBatch > 0 ? maxCommandsPerBatch : 1 )
+			{
+			}
+
+			void clear( void )
+			{
+				m_commands.clear();
+				m_batches.clear();
+				m_instanceCount = 0;
+			}
+
+			void setMaxCommandsPerBatch( std::uint32_t maxCommandsPerBatch )
+			{
+				m_maxCommandsPerBatch = maxCommandsPerBatch > 0 ? maxCommandsPerBatch : 1;
+			}
+
+			/**
+			   \brief Appends a draw, starting a new batch if needed
+
+			   Draws without indices or instances produce no work, so they're skipped.
+			 */
+			void add( const Draw &draw )
+			{
+				if ( draw.indexCount == 0 || draw.instanceCount == 0 ) {
+					return;
+				}
+
+				if ( m_batches.empty()
+					 || !( m_batches.back().batchKey == draw.batchKey )
+					 || m_batches.back().commandCount == m_maxCommandsPerBatch ) {
+					m_batches.push_back(
+						Batch {
+							draw.batchKey,
+							static_cast< std::uint32_t >( m_commands.size() ),
+							0,
+						}
+					);
+				}
+
+				m_commands.push_back(
+					DrawIndexedIndirectCommand {
+						draw.indexCount,
+						draw.instanceCount,
+						draw.firstIndex,
+						draw.vertexOffset,
+						draw.firstInstance,
+					}
+				);
+
+				++m_batches.back().commandCount;
+				m_instanceCount += draw.instanceCount;
+			}
+
+			const std::vector< DrawIndexedIndirectCommand > &getCommands( void ) const { return m_commands; }
+			const std::vector< Batch > &getBatches( void ) const { return m_batches; }
+
+			/**
+			   \brief Total number of instances drawn by all commands
+			 */
+			std::uint64_t getInstanceCount( void ) const { return m_instanceCount; }
+
+			/**
+			   \brief Writes the number of commands for each batch, as expected
+			   by vkCmdDrawIndexedIndirectCount
+			 */
+			void writeDrawCounts( std::uint32_t *counts ) const
+			{
+				for ( const auto &batch : m_batches ) {
+					*counts++ = batch.commandCount;
+				}
+			}
+
+		private:
+			std::uint32_t m_maxCommandsPerBatch;
+			std::vector< DrawIndexedIndirectCommand > m_commands;
+			std::vector< Batch > m_batches;
+			std::uint64_t m_instanceCount = 0;
+		};
+
+		/**
+		   \brief Checks that commands only reference existing indices and instances
+
+		   The GPU doesn't validate indirect arguments, so out of range values
+		   end up reading garbage (or worse). Throws on the first invalid command.
+		 */
+		inline void validateIndirectCommands(
+			const DrawIndexedIndirectCommand *commands,
+			std::uint32_t commandCount,
+			std::uint32_t indexBufferCount,
+			std::uint32_t instanceBufferCount )
+		{
+			for ( std::uint32_t i = 0; i < commandCount; ++i ) {
+				const auto &command = commands[ i ];
+				if ( std::uint64_t( command.firstIndex ) + command.indexCount > indexBufferCount ) {
+					throw std::runtime_error( "Indirect command " + std::to_string( i ) + " reads past the end of the index buffer" );
+				}
+				if ( std::uint64_t( command.firstInstance ) + command.instanceCount > instanceBufferCount ) {
+					throw std::runtime_error( "Indirect command " + std::to_string( i ) + " reads past the end of the instance buffer" );
+				}
+			}
+		}
+
+	}
+
+}
+
+#endif
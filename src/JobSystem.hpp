@@ -0,0 +1,549 @@
+/*
+ * Copyright (c) 2002 - present, H. Hernan Saez
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the <organization> nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL <COPYRIGHT HOLDER> BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef CRIMILD_VULKAN_JOB_SYSTEM_
+#define CRIMILD_VULKAN_JOB_SYSTEM_
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <fstream>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace crimild {
+
+	namespace vulkan {
+
+		struct Job;
+
+		/**
+		   \brief Tracks completion of a group of jobs
+
+		   Every job scheduled with a counter increments it, and decrements it
+		   when done. Counters can also be used as dependencies: jobs depending
+		   on a counter are not queued until the counter reaches zero.
+
+		   If a job throws, the first exception is kept in its counter and
+		   rethrown by JobSystem::wait().
+		 */
+		class JobCounter {
+		public:
+			JobCounter( void ) = default;
+
+			JobCounter( const JobCounter & ) = delete;
+			JobCounter &operator=( const JobCounter & ) = delete;
+
+			bool isDone( void ) const { return m_pending.load( std::memory_order_acquire ) == 0; }
+
+		private:
+			friend class JobSystem;
+
+			std::atomic< std::uint32_t > m_pending { 0 };
+			std::mutex m_mutex;
+			std::vector< Job * > m_continuations;
+			std::exception_ptr m_exception;
+		};
+
+		struct Job {
+			const char *name;
+			std::function< void( void ) > fn;
+			JobCounter *counter;
+			bool mainThreadOnly;
+		};
+
+		/**
+		   \brief Work-stealing job scheduler
+
+		   Each worker owns a queue. Workers push and pop jobs at the back of their
+		   own queue (so recently scheduled, cache-warm jobs run first) and steal
+		   from the front of other queues when they run out of work.
+
+		   The thread that creates the system is worker 0 (the main thread). It has
+		   no thread of its own and only runs jobs while inside wait() or
+		   runMainThreadJobs(). Jobs that must run on the main thread (i.e. anything
+		   touching GLFW or presenting) go to a separate queue that only the main
+		   thread drains.
+
+		   When tracing is enabled, every job records its start and end times,
+		   which can be written as a Chrome trace (chrome://tracing or Perfetto).
+		 */
+		class JobSystem {
+		public:
+			using Function = std::function< void( void ) >;
+
+			static constexpr std::uint32_t MAIN_THREAD = 0;
+
+			struct Stats {
+				std::uint32_t workerCount = 0;
+				double elapsedMs = 0.0;
+				std::vector< double > busyMs;
+				std::vector< std::uint64_t > jobs;
+				std::uint64_t steals = 0;
+
+				/**
+				   \brief Fraction of the elapsed time a worker spent running jobs
+				 */
+				double getUtilization( std::uint32_t worker ) const
+				{
+					return elapsedMs > 0.0 ? busyMs[ worker ] / elapsedMs : 0.0;
+				}
+			};
+
+		public:
+			/**
+			   \param workerCount Total number of workers, including the main thread.
+			   Zero means one worker per hardware thread.
+			 */
+			explicit JobSystem( std::uint32_t workerCount = 0 )
+			{
+				if ( workerCount == 0 ) {
+					workerCount = std::thread::hardware_concurrency();
+				}
+				m_workerCount = std::max( 1u, workerCount );
+
+				m_queues = std::make_unique< WorkQueue[] >( m_workerCount );
+				m_workerStats = std::make_unique< WorkerStats[] >( m_workerCount );
+				m_traces.resize( m_workerCount );
+				m_statsStart = Clock::now();
+				m_traceStart = m_statsStart;
+
+				s_currentSystem = this;
+				s_currentWorker = MAIN_THREAD;
+
+				for ( std::uint32_t i = 1; i < m_workerCount; ++i ) {
+					m_threads.emplace_back( [ this, i ] { workerLoop( i ); } );
+				}
+			}
+
+			JobSystem( const JobSystem & ) = delete;
+			JobSystem &operator=( const JobSystem & ) = delete;
+
+			~JobSystem( void )
+			{
+				{
+					std::lock_guard< std::mutex > lock( m_sleepMutex );
+					m_terminate = true;
+				}
+				m_wake.notify_all();
+
+				for ( auto &thread : m_threads ) {
+					thread.join();
+				}
+
+				// Jobs still queued are discarded
+				for ( std::uint32_t i = 0; i < m_workerCount; ++i ) {
+					for ( auto job : m_queues[ i ].jobs ) {
+						delete job;
+					}
+				}
+				for ( auto job : m_mainThreadQueue.jobs ) {
+					delete job;
+				}
+
+				if ( s_currentSystem == this ) {
+					s_currentSystem = nullptr;
+				}
+			}
+
+			std::uint32_t getWorkerCount( void ) const { return m_workerCount; }
+
+			/**
+			   \brief Index of the worker running the calling thread
+			 */
+			std::uint32_t getCurrentWorker( void ) const
+			{
+				return s_currentSystem == this ? s_currentWorker : MAIN_THREAD;
+			}
+
+			/**
+			   \brief Schedules a job to run on any worker
+
+			   \param name Used for tracing. Must outlive the job (i.e. a literal).
+			   \param counter Optional. Incremented now and decremented when the job is done.
+			   \param dependency Optional. The job won't start until this counter reaches zero.
+			 */
+			void schedule( const char *name, Function fn, JobCounter *counter = nullptr, JobCounter *dependency = nullptr )
+			{
+				submit( new Job { name, std::move( fn ), counter, false }, dependency );
+			}
+
+			/**
+			   \brief Schedules a job that only the main thread is allowed to run
+			 */
+			void scheduleOnMainThread( const char *name, Function fn, JobCounter *counter = nullptr, JobCounter *dependency = nullptr )
+			{
+				submit( new Job { name, std::move( fn ), counter, true }, dependency );
+			}
+
+			/**
+			   \brief Runs fn( index ) for every index in [ 0, count ) and waits for all of them
+			 */
+			void parallelFor( const char *name, std::uint32_t count, const std::function< void( std::uint32_t ) > &fn )
+			{
+				JobCounter counter;
+				for ( std::uint32_t i = 0; i < count; ++i ) {
+					schedule( name, [ &fn, i ] { fn( i ); }, &counter );
+				}
+				wait( counter );
+			}
+
+			/**
+			   \brief Blocks until the counter reaches zero
+
+			   The calling thread keeps executing jobs while waiting instead of
+			   sleeping, so waiting from inside a job never deadlocks. Rethrows
+			   the first exception thrown by any job tracked by the counter.
+			 */
+			void wait( JobCounter &counter )
+			{
+				auto worker = getCurrentWorker();
+				while ( !counter.isDone() ) {
+					if ( !runNextJob( worker ) ) {
+						std::this_thread::yield();
+					}
+				}
+
+				// The last job may still be releasing the counter
+				std::exception_ptr exception;
+				{
+					std::lock_guard< std::mutex > lock( counter.m_mutex );
+					std::swap( exception, counter.m_exception );
+				}
+
+				if ( exception != nullptr ) {
+					std::rethrow_exception( exception );
+				}
+			}
+
+			/**
+			   \brief Runs every job currently queued for the main thread
+
+			   Must be called from the main thread (i.e. once per frame).
+			 */
+			void runMainThreadJobs( void )
+			{
+				while ( auto job = m_mainThreadQueue.popBack() ) {
+					execute( job, MAIN_THREAD );
+				}
+			}
+
+			/**
+			   \brief Returns per-worker statistics since the last reset
+			 */
+			Stats getStats( bool reset = true )
+			{
+				auto now = Clock::now();
+
+				Stats stats;
+				stats.workerCount = m_workerCount;
+				stats.elapsedMs = std::chrono::duration< double, std::milli >( now - m_statsStart ).count();
+				stats.busyMs.resize( m_workerCount );
+				stats.jobs.resize( m_workerCount );
+				for ( std::uint32_t i = 0; i < m_workerCount; ++i ) {
+					auto &worker = m_workerStats[ i ];
+					stats.busyMs[ i ] = 1e-6 * ( reset ? worker.busyNs.exchange( 0 ) : worker.busyNs.load() );
+					stats.jobs[ i ] = reset ? worker.jobs.exchange( 0 ) : worker.jobs.load();
+				}
+				stats.steals = reset ? m_steals.exchange( 0 ) : m_steals.load();
+
+				if ( reset ) {
+					m_statsStart = now;
+				}
+
+				return stats;
+			}
+
+			/**
+			   \name Tracing
+			 */
+			//@{
+
+			void setTracingEnabled( bool enabled )
+			{
+				m_tracingEnabled.store( enabled, std::memory_order_relaxed );
+			}
+
+			bool isTracingEnabled( void ) const { return m_tracingEnabled.load( std::memory_order_relaxed ); }
+
+			/**
+			   \brief Writes recorded job timings in Chrome trace event format
+
+			   Must not be called while jobs are running.
+			 */
+			void writeTrace( const std::string &filename ) const
+			{
+				std::ofstream file( filename, std::ios::trunc );
+				if ( !file.is_open() ) {
+					throw std::runtime_error( "Failed to open trace file: " + filename );
+				}
+
+				auto toUs = [ this ]( Clock::time_point t ) {
+					return std::chrono::duration< double, std::micro >( t - m_traceStart ).count();
+				};
+
+				file << "{\"traceEvents\":[";
+				auto first = true;
+				for ( std::uint32_t worker = 0; worker < m_workerCount; ++worker ) {
+					for ( const auto &event : m_traces[ worker ] ) {
+						file << ( first ? "" : "," )
+							 << "{\"name\":\"" << event.name << "\","
+							 << "\"ph\":\"X\",\"pid\":0,"
+							 << "\"tid\":" << worker << ","
+							 << "\"ts\":" << toUs( event.start ) << ","
+							 << "\"dur\":" << toUs( event.end ) - toUs( event.start ) << "}";
+						first = false;
+					}
+				}
+				file << "]}" << std::endl;
+			}
+
+			//@}
+
+		private:
+			using Clock = std::chrono::steady_clock;
+
+			/**
+			   Jobs are few and coarse (hundreds per frame at most), so a locked
+			   deque is cheaper than it looks and much simpler than a lock-free one.
+			 */
+			struct alignas( 64 ) WorkQueue {
+				std::mutex mutex;
+				std::deque< Job * > jobs;
+
+				void pushBack( Job *job )
+				{
+					std::lock_guard< std::mutex > lock( mutex );
+					jobs.push_back( job );
+				}
+
+				Job *popBack( void )
+				{
+					std::lock_guard< std::mutex > lock( mutex );
+					if ( jobs.empty() ) {
+						return nullptr;
+					}
+					auto job = jobs.back();
+					jobs.pop_back();
+					return job;
+				}
+
+				Job *popFront( void )
+				{
+					std::lock_guard< std::mutex > lock( mutex );
+					if ( jobs.empty() ) {
+						return nullptr;
+					}
+					auto job = jobs.front();
+					jobs.pop_front();
+					return job;
+				}
+			};
+
+			struct alignas( 64 ) WorkerStats {
+				std::atomic< std::uint64_t > busyNs { 0 };
+				std::atomic< std::uint64_t > jobs { 0 };
+			};
+
+			struct TraceEvent {
+				const char *name;
+				Clock::time_point start;
+				Clock::time_point end;
+			};
+
+			void submit( Job *job, JobCounter *dependency )
+			{
+				if ( job->counter != nullptr ) {
+					job->counter->m_pending.fetch_add( 1, std::memory_order_relaxed );
+				}
+
+				if ( dependency != nullptr ) {
+					std::lock_guard< std::mutex > lock( dependency->m_mutex );
+					if ( dependency->m_pending.load( std::memory_order_acquire ) > 0 ) {
+						dependency->m_continuations.push_back( job );
+						return;
+					}
+				}
+
+				enqueue( job );
+			}
+
+			void enqueue( Job *job )
+			{
+				if ( job->mainThreadOnly ) {
+					m_mainThreadQueue.pushBack( job );
+					return;
+				}
+
+				m_queues[ getCurrentWorker() ].pushBack( job );
+
+				{
+					std::lock_guard< std::mutex > lock( m_sleepMutex );
+					++m_queuedJobs;
+				}
+				m_wake.notify_one();
+			}
+
+			Job *findJob( std::uint32_t worker )
+			{
+				if ( worker == MAIN_THREAD ) {
+					if ( auto job = m_mainThreadQueue.popBack() ) {
+						return job;
+					}
+				}
+
+				if ( auto job = m_queues[ worker ].popBack() ) {
+					return job;
+				}
+
+				for ( std::uint32_t i = 1; i < m_workerCount; ++i ) {
+					if ( auto job = m_queues[ ( worker + i ) % m_workerCount ].popFront() ) {
+						m_steals.fetch_add( 1, std::memory_order_relaxed );
+						return job;
+					}
+				}
+
+				return nullptr;
+			}
+
+			bool runNextJob( std::uint32_t worker )
+			{
+				auto job = findJob( worker );
+				if ( job == nullptr ) {
+					return false;
+				}
+
+				if ( !job->mainThreadOnly ) {
+					std::lock_guard< std::mutex > lock( m_sleepMutex );
+					--m_queuedJobs;
+				}
+
+				execute( job, worker );
+				return true;
+			}
+
+			void execute( Job *job, std::uint32_t worker )
+			{
+				auto start = Clock::now();
+
+				std::exception_ptr exception;
+				try {
+					job->fn();
+				}
+				catch ( ... ) {
+					if ( job->counter == nullptr ) {
+						// Nobody is waiting for this job, so there's no one to report to
+						throw;
+					}
+					exception = std::current_exception();
+				}
+
+				auto end = Clock::now();
+
+				auto &stats = m_workerStats[ worker ];
+				stats.busyNs.fetch_add( std::chrono::duration_cast< std::chrono::nanoseconds >( end - start ).count(), std::memory_order_relaxed );
+				stats.jobs.fetch_add( 1, std::memory_order_relaxed );
+
+				if ( isTracingEnabled() ) {
+					m_traces[ worker ].push_back( TraceEvent { job->name, start, end } );
+				}
+
+				if ( auto counter = job->counter ) {
+					std::vector< Job * > continuations;
+					{
+						std::lock_guard< std::mutex > lock( counter->m_mutex );
+						if ( exception != nullptr && counter->m_exception == nullptr ) {
+							counter->m_exception = exception;
+						}
+						if ( counter->m_pending.fetch_sub( 1, std::memory_order_acq_rel ) == 1 ) {
+							std::swap( continuations, counter->m_continuations );
+						}
+					}
+
+					for ( auto continuation : continuations ) {
+						enqueue( continuation );
+					}
+				}
+
+				delete job;
+			}
+
+			void workerLoop( std::uint32_t worker )
+			{
+				s_currentSystem = this;
+				s_currentWorker = worker;
+
+				while ( true ) {
+					if ( runNextJob( worker ) ) {
+						continue;
+					}
+
+					std::unique_lock< std::mutex > lock( m_sleepMutex );
+					m_wake.wait( lock, [ this ] { return m_terminate || m_queuedJobs > 0; } );
+					if ( m_terminate ) {
+						return;
+					}
+				}
+			}
+
+		private:
+			std::uint32_t m_workerCount = 1;
+			std::vector< std::thread > m_threads;
+			std::unique_ptr< WorkQueue[] > m_queues;
+			WorkQueue m_mainThreadQueue;
+
+			std::mutex m_sleepMutex;
+			std::condition_variable m_wake;
+			std::int64_t m_queuedJobs = 0;
+			bool m_terminate = false;
+
+			std::unique_ptr< WorkerStats[] > m_workerStats;
+			std::atomic< std::uint64_t > m_steals { 0 };
+			Clock::time_point m_statsStart;
+
+			std::atomic< bool > m_tracingEnabled { false };
+			Clock::time_point m_traceStart;
+			std::vector< std::vector< TraceEvent >> m_traces;
+
+			static inline thread_local JobSystem *s_currentSystem = nullptr;
+			static inline thread_local std::uint32_t s_currentWorker = MAIN_THREAD;
+		};
+
+	}
+
+}
+
+#endif
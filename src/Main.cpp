@@ -39,17 +39,158 @@
 #define TINYOBJLOADER_IMPLEMENTATION
 #include "tiny_obj_loader.h"
 
+#include "TextureContainer.hpp"
+#include "JobSystem.hpp"
+#include "SpirvReflection.hpp"
+#include "MappedFile.hpp"
+#include "IndirectDraws.hpp"
+#include "Culling.hpp"
+#include "SimdCulling.hpp"
+
+#if defined( CRIMILD_VULKAN_EMBEDDED_SHADERS )
+#include <EmbeddedShaders.hpp>
+#endif
+
 #include <set>
 #include <fstream>
 #include <array>
 #include <unordered_map>
+#include <deque>
+#include <tuple>
+#include <numeric>
 
 #define ENABLE_ROTATION 1
 
-const int MAX_FRAMES_IN_FLIGHT = 2;
+/**
+   Use descriptor indexing (when supported) so draws index textures
+   and materials by integer instead of binding a descriptor set each
+ */
+#define ENABLE_BINDLESS 1
+
+/**
+   Track GPU progress with a timeline semaphore (when supported)
+   instead of one fence per submission
+ */
+#define ENABLE_TIMELINE_SEMAPHORES 1
+
+/**
+   Submit the draw list with multi-draw indirect (when supported), writing
+   draw arguments into a buffer instead of recording one draw call each
+ */
+#define ENABLE_MULTI_DRAW_INDIRECT 1
+
+/**
+   Cull objects with a compute shader against the view frustum and the
+   previous frame's depth (requires multi-draw indirect with draw count)
+ */
+#define ENABLE_GPU_CULLING 1
+
+/**
+   Cull renderables against the view frustum on the CPU (using SIMD when
+   available) whenever GPU culling is not supported
+ */
+#define ENABLE_CPU_CULLING 1
+
+/**
+   Number of frames the CPU can get ahead of the GPU. Can be overridden at
+   runtime with CRIMILD_FRAMES_IN_FLIGHT, from 1 (lowest latency) up to
+   MAX_FRAMES_IN_FLIGHT (highest throughput)
+ */
+const crimild::UInt32 DEFAULT_FRAMES_IN_FLIGHT = 2;
+const crimild::UInt32 MAX_FRAMES_IN_FLIGHT = 3;
+
+/**
+   Frames skipped and measured for each setting when running the
+   frames-in-flight benchmark (CRIMILD_FRAMES_IN_FLIGHT_BENCHMARK)
+ */
+const crimild::UInt32 FRAMES_IN_FLIGHT_BENCHMARK_WARMUP = 60;
+const crimild::UInt32 FRAMES_IN_FLIGHT_BENCHMARK_FRAMES = 600;
+
+/**
+   Number of frames between performance reports
+ */
+const crimild::UInt32 STATS_REPORT_INTERVAL = 300;
+
+/**
+   Draw lists smaller than this are recorded on the main thread, since
+   splitting them across threads costs more than it saves
+ */
+const crimild::UInt32 MIN_DRAWS_PER_RECORDING_TASK = 512;
+
+/**
+   Renderables sharing mesh, material and pipeline are merged into a single
+   instanced draw when there are at least this many of them
+ */
+const crimild::UInt32 INSTANCING_MIN_INSTANCES = 2;
+
+/**
+   Initial number of instances per frame. Instance buffers double in size
+   whenever a frame needs more
+ */
+const crimild::UInt32 INSTANCE_BUFFER_INITIAL_CAPACITY = 1024;
+
+/**
+   Initial number of indirect draw commands per frame. Indirect buffers
+   double in size whenever a frame needs more
+ */
+const crimild::UInt32 INDIRECT_BUFFER_INITIAL_CAPACITY = 1024;
+
+/**
+   Workgroup sizes for culling and depth pyramid shaders. Must match
+   local_size in cull.comp and depth_pyramid*.comp
+ */
+const crimild::UInt32 CULLING_WORKGROUP_SIZE = 64;
+const crimild::UInt32 DEPTH_PYRAMID_WORKGROUP_SIZE = 8;
+
+/**
+   Lowest render scale, step and number of frames between adjustments
+   for dynamic resolution
+ */
+const crimild::Real32 DYNAMIC_RESOLUTION_MIN_SCALE = 0.5f;
+const crimild::Real32 DYNAMIC_RESOLUTION_SCALE_STEP = 0.05f;
+const crimild::UInt32 DYNAMIC_RESOLUTION_ADJUST_INTERVAL = 30;
+
+/**
+   Initial number of sets for descriptor pools. Pools grow as needed
+ */
+const crimild::UInt32 DESCRIPTOR_SETS_PER_POOL = 64;
+
+/**
+   Capacity of the bindless texture array and material buffer
+ */
+const crimild::UInt32 BINDLESS_MAX_TEXTURES = 4096;
+const crimild::UInt32 BINDLESS_MAX_MATERIALS = 4096;
+
+/**
+   Marks textures without a slot in the bindless array
+ */
+const crimild::UInt32 NO_BINDLESS_INDEX = std::numeric_limits< crimild::UInt32 >::max();
 
 const std::string MODEL_PATH = "assets/models/chalet/chalet.obj";
 const std::string TEXTURE_PATH = "assets/models/chalet/chalet.tga";
+const std::string TEXTURE_CONTAINER_PATH = "assets/models/chalet/chalet.ctex";
+
+/**
+   Compiled pipelines are stored here between runs
+ */
+const std::string PIPELINE_CACHE_PATH = "pipeline_cache.bin";
+
+/**
+   Pipelines created during a run are listed here, so the next run can
+   compile them in the background while loading
+ */
+const std::string PIPELINE_PREWARM_PATH = "pipeline_prewarm.txt";
+
+/**
+   Mip levels no larger than this (in texels) are always resident
+ */
+const crimild::UInt32 TEXTURE_STREAMING_TAIL_EXTENT = 64;
+
+/**
+   Default VRAM budget for streamed textures. Can be overridden with the
+   CRIMILD_TEXTURE_STREAMING_BUDGET_MB environment variable
+ */
+const crimild::Size TEXTURE_STREAMING_BUDGET = 256 * 1024 * 1024;
 
 namespace crimild {
 
@@ -100,12 +241,318 @@ namespace crimild {
 
 		};
 
-		struct UniformBufferObject {
+		const Matrix4f IDENTITY_MATRIX = Matrix4f(
+			1.0f, 0.0f, 0.0f, 0.0f,
+			0.0f, 1.0f, 0.0f, 0.0f,
+			0.0f, 0.0f, 1.0f, 0.0f,
+			0.0f, 0.0f, 0.0f, 1.0f
+		);
+
+		/**
+		   \brief Per-instance data, streamed as an instance-rate vertex binding
+
+		   Instanced draws get their transforms and materials from here. Other
+		   draws use the identity at index 0 and push their own values instead.
+		   Shaders combine both, so either one can be used.
+		 */
+		struct InstanceData {
 			Matrix4f model;
+			crimild::UInt32 materialIndex;
+
+			static VkVertexInputBindingDescription getBindingDescription( void )
+			{
+				return VkVertexInputBindingDescription {
+					.binding = 1,
+					.stride = sizeof( InstanceData ),
+					.inputRate = VK_VERTEX_INPUT_RATE_INSTANCE,
+				};
+			}
+
+			/**
+			   \brief One attribute per matrix column, followed by the material index
+			 */
+			static std::array< VkVertexInputAttributeDescription, 5 > getAttributeDescriptions( void )
+			{
+				std::array< VkVertexInputAttributeDescription, 5 > attributes;
+				for ( uint32_t column = 0; column < 4; ++column ) {
+					attributes[ column ] = VkVertexInputAttributeDescription {
+						.binding = 1,
+						.location = 3 + column,
+						.format = VK_FORMAT_R32G32B32A32_SFLOAT,
+						.offset = static_cast< uint32_t >( offsetof( InstanceData, model ) + column * 4 * sizeof( crimild::Real32 ) ),
+					};
+				}
+				attributes[ 4 ] = VkVertexInputAttributeDescription {
+					.binding = 1,
+					.location = 7,
+					.format = VK_FORMAT_R32_UINT,
+					.offset = offsetof( InstanceData, materialIndex ),
+				};
+				return attributes;
+			}
+		};
+
+		/**
+		   \brief Per-frame shader data
+		 */
+		struct UniformBufferObject {
 			Matrix4f view;
 			Matrix4f proj;
 		};
 
+		/**
+		   \brief Per-draw shader data, delivered as push constants
+
+		   Must match the push_constant block in the vertex shaders.
+		 */
+		struct DrawPushConstants {
+			Matrix4f model;
+			crimild::UInt32 materialIndex;
+		};
+
+		/**
+		   \brief Material data as seen by bindless shaders (std430 layout)
+		 */
+		struct MaterialRecord {
+			Vector4f color;
+			crimild::UInt32 albedoTextureIndex;
+			crimild::UInt32 padding[ 3 ];
+		};
+
+		/**
+		   \brief Sampler state used as key for the sampler cache
+
+		   Textures don't bake their own mip count into samplers. Instead, the
+		   default maxLod is VK_LOD_CLAMP_NONE and the image view limits which
+		   levels can be sampled, so most textures end up sharing a sampler.
+		 */
+		struct SamplerDescriptor {
+			VkFilter magFilter = VK_FILTER_LINEAR;
+			VkFilter minFilter = VK_FILTER_LINEAR;
+			VkSamplerMipmapMode mipmapMode = VK_SAMPLER_MIPMAP_MODE_LINEAR;
+			VkSamplerAddressMode addressModeU = VK_SAMPLER_ADDRESS_MODE_REPEAT;
+			VkSamplerAddressMode addressModeV = VK_SAMPLER_ADDRESS_MODE_REPEAT;
+			VkSamplerAddressMode addressModeW = VK_SAMPLER_ADDRESS_MODE_REPEAT;
+			crimild::Real32 maxAnisotropy = 16.0f; //< Anisotropy is disabled if 1 or less
+			crimild::Real32 mipLodBias = 0.0f;
+			crimild::Real32 minLod = 0.0f;
+			crimild::Real32 maxLod = VK_LOD_CLAMP_NONE;
+			VkBool32 compareEnable = VK_FALSE;
+			VkCompareOp compareOp = VK_COMPARE_OP_ALWAYS;
+			VkBorderColor borderColor = VK_BORDER_COLOR_INT_OPAQUE_BLACK;
+
+			bool operator==( const SamplerDescriptor &other ) const
+			{
+				return magFilter == other.magFilter
+					&& minFilter == other.minFilter
+					&& mipmapMode == other.mipmapMode
+					&& addressModeU == other.addressModeU
+					&& addressModeV == other.addressModeV
+					&& addressModeW == other.addressModeW
+					&& maxAnisotropy == other.maxAnisotropy
+					&& mipLodBias == other.mipLodBias
+					&& minLod == other.minLod
+					&& maxLod == other.maxLod
+					&& compareEnable == other.compareEnable
+					&& compareOp == other.compareOp
+					&& borderColor == other.borderColor;
+			}
+		};
+
+		/**
+		   \brief A single resource written into a descriptor set binding
+		 */
+		struct DescriptorBinding {
+			uint32_t binding;
+			VkDescriptorType descriptorType;
+			VkBuffer buffer = VK_NULL_HANDLE;
+			VkDeviceSize offset = 0;
+			VkDeviceSize range = 0;
+			VkImageView imageView = VK_NULL_HANDLE;
+			VkSampler sampler = VK_NULL_HANDLE;
+			VkImageLayout imageLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+
+			bool operator==( const DescriptorBinding &other ) const
+			{
+				return binding == other.binding
+					&& descriptorType == other.descriptorType
+					&& buffer == other.buffer
+					&& offset == other.offset
+					&& range == other.range
+					&& imageView == other.imageView
+					&& sampler == other.sampler
+					&& imageLayout == other.imageLayout;
+			}
+		};
+
+		/**
+		   \brief Identifies a descriptor set by its layout and contents
+
+		   Used to reuse descriptor sets when several objects bind exactly
+		   the same resources.
+		 */
+		struct DescriptorSetKey {
+			VkDescriptorSetLayout layout;
+			std::vector< DescriptorBinding > bindings;
+
+			bool operator==( const DescriptorSetKey &other ) const
+			{
+				return layout == other.layout && bindings == other.bindings;
+			}
+		};
+
+		/**
+		   \brief Describes a descriptor set layout
+
+		   Shaders declaring the same bindings share a single layout, which in
+		   turn lets them share descriptor sets.
+		 */
+		struct DescriptorSetLayoutDescriptor {
+			std::vector< VkDescriptorSetLayoutBinding > bindings;
+
+			bool operator==( const DescriptorSetLayoutDescriptor &other ) const
+			{
+				return std::equal(
+					bindings.begin(), bindings.end(),
+					other.bindings.begin(), other.bindings.end(),
+					[]( const auto &a, const auto &b ) {
+						return a.binding == b.binding
+							&& a.descriptorType == b.descriptorType
+							&& a.descriptorCount == b.descriptorCount
+							&& a.stageFlags == b.stageFlags
+							&& a.pImmutableSamplers == b.pImmutableSamplers;
+					}
+				);
+			}
+		};
+
+		/**
+		   \brief Describes a pipeline layout
+
+		   Pipelines with equal layout descriptors share the same VkPipelineLayout.
+		 */
+		struct PipelineLayoutDescriptor {
+			std::vector< VkDescriptorSetLayout > setLayouts;
+			std::vector< VkPushConstantRange > pushConstantRanges;
+
+			bool operator==( const PipelineLayoutDescriptor &other ) const
+			{
+				return setLayouts == other.setLayouts
+					&& std::equal(
+						pushConstantRanges.begin(), pushConstantRanges.end(),
+						other.pushConstantRanges.begin(), other.pushConstantRanges.end(),
+						[]( const auto &a, const auto &b ) {
+							return a.stageFlags == b.stageFlags && a.offset == b.offset && a.size == b.size;
+						}
+					);
+			}
+		};
+
+		/**
+		   \brief Optional shader features
+
+		   Features are toggled with boolean specialization constants, so each
+		   combination compiles into its own pipeline with dead code stripped by
+		   the driver. The constant_id for a feature is its bit index.
+		 */
+		enum ShaderFeature : crimild::UInt32 {
+			SHADER_FEATURE_TEXTURE = 1 << 0,
+			SHADER_FEATURE_VERTEX_COLOR = 1 << 1,
+
+			SHADER_FEATURE_COUNT = 2,
+			SHADER_FEATURE_DEFAULT = SHADER_FEATURE_TEXTURE,
+		};
+
+		/**
+		   \brief Describes every piece of state baked into a graphics pipeline
+
+		   Descriptors that compare equal produce identical pipelines, so they share a
+		   single VkPipeline. Shaders are identified by file name. Render passes are
+		   identified by the properties that make them compatible (attachment formats
+		   and sample count), which lets a pipeline be reused when an equivalent
+		   render pass is recreated.
+
+		   Viewport and scissor are dynamic and not part of the description.
+		 */
+		struct GraphicsPipelineDescriptor {
+			std::string vertexShader;
+			std::string fragmentShader;
+			crimild::UInt32 shaderFeatures = SHADER_FEATURE_DEFAULT;
+
+			std::vector< VkVertexInputBindingDescription > vertexBindings;
+			std::vector< VkVertexInputAttributeDescription > vertexAttributes;
+			VkPrimitiveTopology topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
+
+			VkPolygonMode polygonMode = VK_POLYGON_MODE_FILL;
+			VkCullModeFlags cullMode = VK_CULL_MODE_BACK_BIT;
+			VkFrontFace frontFace = VK_FRONT_FACE_COUNTER_CLOCKWISE;
+
+			VkBool32 depthTestEnable = VK_TRUE;
+			VkBool32 depthWriteEnable = VK_TRUE;
+			VkCompareOp depthCompareOp = VK_COMPARE_OP_LESS;
+
+			VkBool32 blendEnable = VK_FALSE;
+			VkBlendFactor srcColorBlendFactor = VK_BLEND_FACTOR_ONE;
+			VkBlendFactor dstColorBlendFactor = VK_BLEND_FACTOR_ZERO;
+			VkBlendOp colorBlendOp = VK_BLEND_OP_ADD;
+			VkBlendFactor srcAlphaBlendFactor = VK_BLEND_FACTOR_ONE;
+			VkBlendFactor dstAlphaBlendFactor = VK_BLEND_FACTOR_ZERO;
+			VkBlendOp alphaBlendOp = VK_BLEND_OP_ADD;
+
+			VkSampleCountFlagBits rasterizationSamples = VK_SAMPLE_COUNT_1_BIT;
+
+			PipelineLayoutDescriptor layout;
+
+			// Render pass compatibility
+			VkFormat colorFormat = VK_FORMAT_UNDEFINED;
+			VkFormat depthFormat = VK_FORMAT_UNDEFINED;
+			uint32_t subpass = 0;
+
+			bool operator==( const GraphicsPipelineDescriptor &other ) const
+			{
+				auto sameBindings = std::equal(
+					vertexBindings.begin(), vertexBindings.end(),
+					other.vertexBindings.begin(), other.vertexBindings.end(),
+					[]( const auto &a, const auto &b ) {
+						return a.binding == b.binding && a.stride == b.stride && a.inputRate == b.inputRate;
+					}
+				);
+
+				auto sameAttributes = std::equal(
+					vertexAttributes.begin(), vertexAttributes.end(),
+					other.vertexAttributes.begin(), other.vertexAttributes.end(),
+					[]( const auto &a, const auto &b ) {
+						return a.location == b.location && a.binding == b.binding && a.format == b.format && a.offset == b.offset;
+					}
+				);
+
+				return vertexShader == other.vertexShader
+					&& fragmentShader == other.fragmentShader
+					&& shaderFeatures == other.shaderFeatures
+					&& sameBindings
+					&& sameAttributes
+					&& topology == other.topology
+					&& polygonMode == other.polygonMode
+					&& cullMode == other.cullMode
+					&& frontFace == other.frontFace
+					&& depthTestEnable == other.depthTestEnable
+					&& depthWriteEnable == other.depthWriteEnable
+					&& depthCompareOp == other.depthCompareOp
+					&& blendEnable == other.blendEnable
+					&& srcColorBlendFactor == other.srcColorBlendFactor
+					&& dstColorBlendFactor == other.dstColorBlendFactor
+					&& colorBlendOp == other.colorBlendOp
+					&& srcAlphaBlendFactor == other.srcAlphaBlendFactor
+					&& dstAlphaBlendFactor == other.dstAlphaBlendFactor
+					&& alphaBlendOp == other.alphaBlendOp
+					&& rasterizationSamples == other.rasterizationSamples
+					&& layout == other.layout
+					&& colorFormat == other.colorFormat
+					&& depthFormat == other.depthFormat
+					&& subpass == other.subpass;
+			}
+		};
+
 	}
 
 }
@@ -161,12 +608,273 @@ namespace std {
 		}
 	};
 
+	template<> struct hash< crimild::vulkan::SamplerDescriptor > {
+		size_t operator()( crimild::vulkan::SamplerDescriptor const &sampler ) const {
+			size_t seed = 0;
+			crimild::utils::hash_combine( seed, sampler.magFilter );
+			crimild::utils::hash_combine( seed, sampler.minFilter );
+			crimild::utils::hash_combine( seed, sampler.mipmapMode );
+			crimild::utils::hash_combine( seed, sampler.addressModeU );
+			crimild::utils::hash_combine( seed, sampler.addressModeV );
+			crimild::utils::hash_combine( seed, sampler.addressModeW );
+			crimild::utils::hash_combine( seed, sampler.maxAnisotropy );
+			crimild::utils::hash_combine( seed, sampler.mipLodBias );
+			crimild::utils::hash_combine( seed, sampler.minLod );
+			crimild::utils::hash_combine( seed, sampler.maxLod );
+			crimild::utils::hash_combine( seed, sampler.compareEnable );
+			crimild::utils::hash_combine( seed, sampler.compareOp );
+			crimild::utils::hash_combine( seed, sampler.borderColor );
+			return seed;
+		}
+	};
+
+	template<> struct hash< crimild::vulkan::DescriptorBinding > {
+		size_t operator()( crimild::vulkan::DescriptorBinding const &binding ) const {
+			size_t seed = 0;
+			crimild::utils::hash_combine( seed, binding.binding );
+			crimild::utils::hash_combine( seed, binding.descriptorType );
+			crimild::utils::hash_combine( seed, binding.buffer );
+			crimild::utils::hash_combine( seed, binding.offset );
+			crimild::utils::hash_combine( seed, binding.range );
+			crimild::utils::hash_combine( seed, binding.imageView );
+			crimild::utils::hash_combine( seed, binding.sampler );
+			crimild::utils::hash_combine( seed, binding.imageLayout );
+			return seed;
+		}
+	};
+
+	template<> struct hash< crimild::vulkan::DescriptorSetKey > {
+		size_t operator()( crimild::vulkan::DescriptorSetKey const &key ) const {
+			size_t seed = 0;
+			crimild::utils::hash_combine( seed, key.layout );
+			for ( const auto &binding : key.bindings ) {
+				crimild::utils::hash_combine( seed, binding );
+			}
+			return seed;
+		}
+	};
+
+	template<> struct hash< crimild::vulkan::DescriptorSetLayoutDescriptor > {
+		size_t operator()( crimild::vulkan::DescriptorSetLayoutDescriptor const &desc ) const {
+			size_t seed = 0;
+			for ( const auto &binding : desc.bindings ) {
+				crimild::utils::hash_combine( seed, binding.binding );
+				crimild::utils::hash_combine( seed, binding.descriptorType );
+				crimild::utils::hash_combine( seed, binding.descriptorCount );
+				crimild::utils::hash_combine( seed, binding.stageFlags );
+				crimild::utils::hash_combine( seed, binding.pImmutableSamplers );
+			}
+			return seed;
+		}
+	};
+
+	template<> struct hash< crimild::vulkan::PipelineLayoutDescriptor > {
+		size_t operator()( crimild::vulkan::PipelineLayoutDescriptor const &desc ) const {
+			size_t seed = 0;
+			for ( auto layout : desc.setLayouts ) {
+				crimild::utils::hash_combine( seed, layout );
+			}
+			for ( const auto &range : desc.pushConstantRanges ) {
+				crimild::utils::hash_combine( seed, range.stageFlags );
+				crimild::utils::hash_combine( seed, range.offset );
+				crimild::utils::hash_combine( seed, range.size );
+			}
+			return seed;
+		}
+	};
+
+	template<> struct hash< crimild::vulkan::GraphicsPipelineDescriptor > {
+		size_t operator()( crimild::vulkan::GraphicsPipelineDescriptor const &desc ) const {
+			size_t seed = 0;
+			crimild::utils::hash_combine( seed, desc.vertexShader );
+			crimild::utils::hash_combine( seed, desc.fragmentShader );
+			crimild::utils::hash_combine( seed, desc.shaderFeatures );
+			for ( const auto &binding : desc.vertexBindings ) {
+				crimild::utils::hash_combine( seed, binding.binding );
+				crimild::utils::hash_combine( seed, binding.stride );
+				crimild::utils::hash_combine( seed, binding.inputRate );
+			}
+			for ( const auto &attribute : desc.vertexAttributes ) {
+				crimild::utils::hash_combine( seed, attribute.location );
+				crimild::utils::hash_combine( seed, attribute.binding );
+				crimild::utils::hash_combine( seed, attribute.format );
+				crimild::utils::hash_combine( seed, attribute.offset );
+			}
+			crimild::utils::hash_combine( seed, desc.topology );
+			crimild::utils::hash_combine( seed, desc.polygonMode );
+			crimild::utils::hash_combine( seed, desc.cullMode );
+			crimild::utils::hash_combine( seed, desc.frontFace );
+			crimild::utils::hash_combine( seed, desc.depthTestEnable );
+			crimild::utils::hash_combine( seed, desc.depthWriteEnable );
+			crimild::utils::hash_combine( seed, desc.depthCompareOp );
+			crimild::utils::hash_combine( seed, desc.blendEnable );
+			crimild::utils::hash_combine( seed, desc.srcColorBlendFactor );
+			crimild::utils::hash_combine( seed, desc.dstColorBlendFactor );
+			crimild::utils::hash_combine( seed, desc.colorBlendOp );
+			crimild::utils::hash_combine( seed, desc.srcAlphaBlendFactor );
+			crimild::utils::hash_combine( seed, desc.dstAlphaBlendFactor );
+			crimild::utils::hash_combine( seed, desc.alphaBlendOp );
+			crimild::utils::hash_combine( seed, desc.rasterizationSamples );
+			crimild::utils::hash_combine( seed, desc.layout );
+			crimild::utils::hash_combine( seed, desc.colorFormat );
+			crimild::utils::hash_combine( seed, desc.depthFormat );
+			crimild::utils::hash_combine( seed, desc.subpass );
+			return seed;
+		}
+	};
+
 }
 
 namespace crimild {
 
 	namespace vulkan {
 
+		/**
+		   \brief Allocates descriptor sets from a growing list of pools
+
+		   When the current pool runs out of space, a new one is taken from the free
+		   list (or created, doubling the size of the previous one) and allocation is
+		   retried. Resetting the allocator resets every pool at once and moves them
+		   back to the free list, so pools are reused instead of being destroyed.
+
+		   Any layout can be allocated, as long as its descriptor types are covered
+		   by POOL_SIZE_RATIOS.
+		 */
+		class DescriptorAllocator {
+		private:
+			/**
+			   Number of descriptors of each type per set in a pool
+			 */
+			static constexpr std::array< std::pair< VkDescriptorType, crimild::Real32 >, 5 > POOL_SIZE_RATIOS = {
+				std::make_pair( VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, 1.0f ),
+				std::make_pair( VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 1.0f ),
+				std::make_pair( VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC, 0.5f ),
+				std::make_pair( VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 0.5f ),
+				std::make_pair( VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, 0.25f ),
+			};
+
+			static constexpr crimild::UInt32 MAX_SETS_PER_POOL = 4096;
+
+		public:
+			void init( VkDevice device, crimild::UInt32 initialSetsPerPool )
+			{
+				m_device = device;
+				m_setsPerPool = initialSetsPerPool;
+			}
+
+			void cleanup( void )
+			{
+				for ( auto pool : m_usedPools ) {
+					vkDestroyDescriptorPool( m_device, pool, nullptr );
+				}
+				for ( auto pool : m_freePools ) {
+					vkDestroyDescriptorPool( m_device, pool, nullptr );
+				}
+				m_usedPools.clear();
+				m_freePools.clear();
+				m_currentPool = VK_NULL_HANDLE;
+			}
+
+			VkDescriptorSet allocate( VkDescriptorSetLayout layout )
+			{
+				if ( m_currentPool == VK_NULL_HANDLE ) {
+					m_currentPool = grabPool();
+				}
+
+				auto allocInfo = VkDescriptorSetAllocateInfo {
+					.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO,
+					.descriptorPool = m_currentPool,
+					.descriptorSetCount = 1,
+					.pSetLayouts = &layout,
+				};
+
+				VkDescriptorSet descriptorSet;
+				auto result = vkAllocateDescriptorSets( m_device, &allocInfo, &descriptorSet );
+				if ( result == VK_ERROR_OUT_OF_POOL_MEMORY || result == VK_ERROR_FRAGMENTED_POOL ) {
+					// Current pool is full. Try again with a new one
+					m_currentPool = grabPool();
+					allocInfo.descriptorPool = m_currentPool;
+					result = vkAllocateDescriptorSets( m_device, &allocInfo, &descriptorSet );
+				}
+
+				if ( result != VK_SUCCESS ) {
+					throw RuntimeException( "Failed to allocate descriptor sets" );
+				}
+
+				++m_allocatedSets;
+
+				return descriptorSet;
+			}
+
+			/**
+			   \brief Frees every set allocated so far
+
+			   Sets must not be in use by the GPU when this is called.
+			 */
+			void reset( void )
+			{
+				for ( auto pool : m_usedPools ) {
+					vkResetDescriptorPool( m_device, pool, 0 );
+					m_freePools.push_back( pool );
+				}
+				m_usedPools.clear();
+				m_currentPool = VK_NULL_HANDLE;
+				m_allocatedSets = 0;
+			}
+
+			crimild::Size getPoolCount( void ) const { return m_usedPools.size() + m_freePools.size(); }
+			crimild::UInt32 getAllocatedSetCount( void ) const { return m_allocatedSets; }
+
+		private:
+			VkDescriptorPool grabPool( void )
+			{
+				if ( !m_freePools.empty() ) {
+					auto pool = m_freePools.back();
+					m_freePools.pop_back();
+					m_usedPools.push_back( pool );
+					return pool;
+				}
+
+				std::vector< VkDescriptorPoolSize > poolSizes;
+				for ( const auto &ratio : POOL_SIZE_RATIOS ) {
+					poolSizes.push_back(
+						VkDescriptorPoolSize {
+							.type = ratio.first,
+							.descriptorCount = std::max( 1u, static_cast< uint32_t >( ratio.second * m_setsPerPool ) ),
+						}
+					);
+				}
+
+				auto poolInfo = VkDescriptorPoolCreateInfo {
+					.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO,
+					.poolSizeCount = static_cast< uint32_t >( poolSizes.size() ),
+					.pPoolSizes = poolSizes.data(),
+					.maxSets = m_setsPerPool,
+				};
+
+				VkDescriptorPool pool;
+				if ( vkCreateDescriptorPool( m_device, &poolInfo, nullptr, &pool ) != VK_SUCCESS ) {
+					throw RuntimeException( "Failed to create descriptor pool" );
+				}
+
+				CRIMILD_LOG_DEBUG( "Descriptor pool created (", m_setsPerPool, " sets)" );
+
+				// Next pool will be bigger
+				m_setsPerPool = std::min( 2 * m_setsPerPool, MAX_SETS_PER_POOL );
+
+				m_usedPools.push_back( pool );
+				return pool;
+			}
+
+		private:
+			VkDevice m_device = VK_NULL_HANDLE;
+			crimild::UInt32 m_setsPerPool = 0;
+			VkDescriptorPool m_currentPool = VK_NULL_HANDLE;
+			std::vector< VkDescriptorPool > m_usedPools;
+			std::vector< VkDescriptorPool > m_freePools;
+			crimild::UInt32 m_allocatedSets = 0;
+		};
+
 		/**
 		   \todo Move vkEnumerate* code to templates? Maybe using a lambda for the actual function?
 		   \todo Use a single command buffer for transitions and copy of buffers/textures. Create setup/flush command buffer to execute recorded command instead of synchronous operations		   
@@ -185,12 +893,69 @@ namespace crimild {
 			}
 
 			/**
-			   \name Window setup
+			   \name Jobs
+
+			   CPU work that can run in parallel (asset loading, command recording)
+			   is split into jobs. The main thread participates as worker 0 and is
+			   the only one allowed to run jobs touching GLFW or presenting.
+
+			   Set CRIMILD_JOB_TRACE to a file name to record a Chrome trace of
+			   every job, written on exit.
 			 */
 			//@{
 
 		private:
-            static void errorCallback( int error, const char* description )
+			void createJobSystem( void )
+			{
+				m_jobs = std::make_unique< JobSystem >();
+
+				if ( auto filename = std::getenv( "CRIMILD_JOB_TRACE" ) ) {
+					m_jobTraceFilename = filename;
+					m_jobs->setTracingEnabled( true );
+				}
+
+				CRIMILD_LOG_DEBUG( "Job system workers: ", m_jobs->getWorkerCount() );
+			}
+
+			void cleanupJobSystem( void )
+			{
+				if ( !m_jobTraceFilename.empty() ) {
+					m_jobs->writeTrace( m_jobTraceFilename );
+					CRIMILD_LOG_DEBUG( "Job trace written to ", m_jobTraceFilename );
+				}
+
+				m_jobs = nullptr;
+			}
+
+			void reportJobStats( void )
+			{
+				if ( m_frameCounter % STATS_REPORT_INTERVAL != 0 ) {
+					return;
+				}
+
+				auto stats = m_jobs->getStats();
+
+				std::stringstream ss;
+				for ( crimild::UInt32 i = 0; i < stats.workerCount; ++i ) {
+					ss << ( i > 0 ? ", " : "" ) << static_cast< crimild::UInt32 >( 100.0 * stats.getUtilization( i ) ) << "%";
+				}
+
+				CRIMILD_LOG_DEBUG( "Job workers utilization: [ ", ss.str(), " ], steals: ", stats.steals );
+			}
+
+		private:
+			std::unique_ptr< JobSystem > m_jobs;
+			std::string m_jobTraceFilename;
+
+			//@}
+
+			/**
+			   \name Window setup
+			 */
+			//@{
+
+		private:
+            static void errorCallback( int error, const char* description )
             {
                 std::cerr << "GLFW Error: (" << error << ") " << description << std::endl;
             }
@@ -222,31 +987,45 @@ namespace crimild {
 			
 			void initVulkan( void )
 			{
+				createJobSystem();
+				configureFramesInFlight();
+
+				// Parsing the model only touches the CPU, so it can overlap with device setup
+				JobCounter modelLoaded;
+				m_jobs->schedule( "loadModel", [ this ] { loadModel(); }, &modelLoaded );
+
 				createInstance();
 				setupDebugMessenger();
 				createSurface();
 				pickPhysicalDevice();
 				createLogicalDevice();
+				createTimeline();
+				createPipelineCache();
+				configureDynamicResolution();
 				createSwapChain();
 				createImageViews();
 				createRenderPass();
 				createDescriptorSetLayout();
 				createGraphicsPipeline();
+				prewarmPipelines();
+				createCullingPipelines();
 				createCommandPool();
 				createColorResources();
 				createDepthResources();
+				createDepthPyramid();
+				createSceneColorResources();
 				createFramebuffers();
+				configureTextureStreaming();
 				createTextureImage();
 				createTextureImageView();
 				createTextureSampler();
-				loadModel();
+				createBindlessResources();
+				m_jobs->wait( modelLoaded );
+				createRenderables();
 				createVertexBuffer();
 				createIndexBuffer();
-				createUniformBuffers();
-				createDescriptorPool();
-				createDescriptorSets();
-				createCommandBuffers();
-				createSyncObjects();
+				createDescriptorAllocators();
+				createFrameResources();
 			}
 
 			void createInstance( void )
@@ -317,9 +1096,31 @@ namespace crimild {
 					extensions.push_back( VK_EXT_DEBUG_UTILS_EXTENSION_NAME );
 				}
 
+				// Required for querying descriptor indexing features with Vulkan 1.0
+				if ( checkInstanceExtensionSupport( VK_KHR_GET_PHYSICAL_DEVICE_PROPERTIES_2_EXTENSION_NAME ) ) {
+					extensions.push_back( VK_KHR_GET_PHYSICAL_DEVICE_PROPERTIES_2_EXTENSION_NAME );
+					m_physicalDeviceProperties2Enabled = true;
+				}
+
 				return extensions;
 			}
 
+			crimild::Bool checkInstanceExtensionSupport( const char *extensionName ) const
+			{
+				crimild::UInt32 extensionCount = 0;
+				vkEnumerateInstanceExtensionProperties( nullptr, &extensionCount, nullptr );
+				std::vector< VkExtensionProperties > extensions( extensionCount );
+				vkEnumerateInstanceExtensionProperties( nullptr, &extensionCount, extensions.data() );
+
+				for ( const auto &extension : extensions ) {
+					if ( strcmp( extension.extensionName, extensionName ) == 0 ) {
+						return true;
+					}
+				}
+
+				return false;
+			}
+
 			crimild::Bool checkValidationLayerSupport( const std::vector< const char * > &validationLayers )
 			{
 				crimild::UInt32 layerCount;
@@ -388,6 +1189,13 @@ namespace crimild {
 					if ( isDeviceSuitable( device ) ) {
 						m_physicalDevice = device;
 						m_msaaSamples = getMaxUsableSampleCount();
+						m_bindlessEnabled = ENABLE_BINDLESS && checkBindlessSupport( device );
+						m_timelineSemaphoresEnabled = ENABLE_TIMELINE_SEMAPHORES && checkTimelineSemaphoreSupport( device );
+						m_multiDrawIndirectEnabled = ENABLE_MULTI_DRAW_INDIRECT && checkMultiDrawIndirectSupport( device );
+						m_drawIndirectCountEnabled = m_multiDrawIndirectEnabled && checkDrawIndirectCountSupport( device );
+						m_gpuCullingEnabled = ENABLE_GPU_CULLING && m_drawIndirectCountEnabled && checkGpuCullingSupport();
+						m_occlusionCullingEnabled = m_gpuCullingEnabled && checkOcclusionCullingSupport();
+						m_cpuCullingEnabled = ENABLE_CPU_CULLING && !m_gpuCullingEnabled;
 						break;
 					}
 				}
@@ -550,7 +1358,11 @@ namespace crimild {
 			{
 				while ( !glfwWindowShouldClose( _window ) ) {
 					glfwPollEvents();
+					m_inputTime = std::chrono::steady_clock::now();
+					m_jobs->runMainThreadJobs();
 					drawFrame();
+					reportJobStats();
+					updateFramesInFlightBenchmark();
 				}
 
 				vkDeviceWaitIdle( m_device );
@@ -570,6 +1382,7 @@ namespace crimild {
 			const std::vector< const char * > m_deviceExtensions {
 				VK_KHR_SWAPCHAIN_EXTENSION_NAME,
 			};
+			crimild::Bool m_physicalDeviceProperties2Enabled = false;
 
 			/**
 			   \name Logical devices
@@ -605,16 +1418,53 @@ namespace crimild {
 				}
 
 				VkPhysicalDeviceFeatures deviceFeatures = {
+					.multiDrawIndirect = m_multiDrawIndirectEnabled ? VK_TRUE : VK_FALSE,
+					.drawIndirectFirstInstance = m_multiDrawIndirectEnabled ? VK_TRUE : VK_FALSE,
 					.samplerAnisotropy = VK_TRUE,
 				};
 
+				auto deviceExtensions = m_deviceExtensions;
+
+				auto descriptorIndexingFeatures = VkPhysicalDeviceDescriptorIndexingFeaturesEXT {
+					.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_INDEXING_FEATURES_EXT,
+					.shaderSampledImageArrayNonUniformIndexing = VK_TRUE,
+					.descriptorBindingSampledImageUpdateAfterBind = VK_TRUE,
+					.descriptorBindingPartiallyBound = VK_TRUE,
+					.runtimeDescriptorArray = VK_TRUE,
+				};
+
+				auto timelineSemaphoreFeatures = VkPhysicalDeviceTimelineSemaphoreFeaturesKHR {
+					.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_TIMELINE_SEMAPHORE_FEATURES_KHR,
+					.timelineSemaphore = VK_TRUE,
+				};
+
+				// Optional features are chained together
+				void *features = nullptr;
+
+				if ( m_bindlessEnabled ) {
+					deviceExtensions.insert( deviceExtensions.end(), m_bindlessDeviceExtensions.begin(), m_bindlessDeviceExtensions.end() );
+					descriptorIndexingFeatures.pNext = features;
+					features = &descriptorIndexingFeatures;
+				}
+
+				if ( m_drawIndirectCountEnabled ) {
+					deviceExtensions.push_back( VK_KHR_DRAW_INDIRECT_COUNT_EXTENSION_NAME );
+				}
+
+				if ( m_timelineSemaphoresEnabled ) {
+					deviceExtensions.push_back( VK_KHR_TIMELINE_SEMAPHORE_EXTENSION_NAME );
+					timelineSemaphoreFeatures.pNext = features;
+					features = &timelineSemaphoreFeatures;
+				}
+
 				VkDeviceCreateInfo createInfo = {
 					.sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO,
+					.pNext = features,
 					.queueCreateInfoCount = static_cast< crimild::UInt32 >( queueCreateInfos.size() ),
 					.pQueueCreateInfos = queueCreateInfos.data(),
 					.pEnabledFeatures = &deviceFeatures,
-					.enabledExtensionCount = static_cast< crimild::UInt32 >( m_deviceExtensions.size() ),
-					.ppEnabledExtensionNames = m_deviceExtensions.data(),
+					.enabledExtensionCount = static_cast< crimild::UInt32 >( deviceExtensions.size() ),
+					.ppEnabledExtensionNames = deviceExtensions.data(),
 				};
 
 				if ( _enableValidationLayers ) {
@@ -632,6 +1482,13 @@ namespace crimild {
 				// Get queue handles
 				vkGetDeviceQueue( m_device, indices.graphicsFamily[ 0 ], 0, &m_graphicsQueue );
 				vkGetDeviceQueue( m_device, indices.presentFamily[ 0 ], 0, &m_presentQueue );
+
+				if ( m_drawIndirectCountEnabled ) {
+					m_vkCmdDrawIndexedIndirectCount = ( PFN_vkCmdDrawIndexedIndirectCountKHR ) vkGetDeviceProcAddr( m_device, "vkCmdDrawIndexedIndirectCountKHR" );
+					if ( m_vkCmdDrawIndexedIndirectCount == nullptr ) {
+						throw RuntimeException( "Failed to load indirect count draw function" );
+					}
+				}
 			}
 
 		private:
@@ -783,7 +1640,7 @@ namespace crimild {
 					.imageColorSpace = surfaceFormat.colorSpace,
 					.imageExtent = extent,
 					.imageArrayLayers = 1,
-					.imageUsage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT,
+					.imageUsage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | ( m_dynamicResolutionEnabled ? VK_IMAGE_USAGE_TRANSFER_DST_BIT : 0 ),
 				};
 
 				auto indices = findQueueFamilies( m_physicalDevice );
@@ -807,7 +1664,8 @@ namespace crimild {
 				createInfo.compositeAlpha = VK_COMPOSITE_ALPHA_OPAQUE_BIT_KHR;
 				createInfo.presentMode = presentMode;
 				createInfo.clipped = VK_TRUE;
-				createInfo.oldSwapchain = VK_NULL_HANDLE;
+				// The previous swapchain (if any) is still alive until its frames are done
+				createInfo.oldSwapchain = m_swapChain;
 
 				if ( vkCreateSwapchainKHR( m_device, &createInfo, nullptr, &m_swapChain ) != VK_SUCCESS ) {
 					throw RuntimeException( "Failed to create swapchain" );
@@ -819,45 +1677,44 @@ namespace crimild {
 
 				m_swapChainImageFormat = surfaceFormat.format;
 				m_swapChainExtent = extent;
+
+				// There might be more frames in flight than images
+				m_imageTimelineValues.assign( m_swapChainImages.size(), 0 );
 			}
 
+			/**
+			   \brief Releases every object that depends on the swapchain images or extent
+
+			   Frames still in flight might be using them, so they are only queued
+			   for destruction. The swapchain handle is kept, since it's passed as
+			   oldSwapchain when creating the new one.
+
+			   The render pass and pipeline only depend on the swapchain format and
+			   are released separately.
+			 */
 			void cleanupSwapChain( void )
 			{
-				vkDestroyImageView( m_device, m_colorImageView, nullptr );
-				vkDestroyImage( m_device, m_colorImage, nullptr );
-				vkFreeMemory( m_device, m_colorImageMemory, nullptr );
-				
-				vkDestroyImageView( m_device, m_depthImageView, nullptr );
-				vkDestroyImage( m_device, m_depthImage, nullptr );
-				vkFreeMemory( m_device, m_depthImageMemory, nullptr );
-				
-				for ( auto i = 0l; i < m_swapChainFramebuffers.size(); i++ ) {
-					vkDestroyFramebuffer( m_device, m_swapChainFramebuffers[ i ], nullptr );
-				}
+				deferDestroy( m_colorImageView );
+				deferDestroy( m_colorImage );
+				deferDestroy( m_colorImageMemory );
 
-				vkFreeCommandBuffers(
-					m_device,
-					m_commandPool,
-					static_cast< uint32_t >( m_commandBuffers.size() ),
-					m_commandBuffers.data()
-				);
+				deferDestroy( m_depthImageView );
+				deferDestroy( m_depthImage );
+				deferDestroy( m_depthImageMemory );
 
-				vkDestroyPipeline( m_device, m_graphicsPipeline, nullptr );
-				vkDestroyPipelineLayout( m_device, m_pipelineLayout, nullptr );
-				vkDestroyRenderPass( m_device, m_renderPass, nullptr );
+				cleanupDepthPyramid();
 
-				for ( auto i = 0l; i < m_swapChainImageViews.size(); ++i ) {
-					vkDestroyImageView( m_device, m_swapChainImageViews[ i ], nullptr );
-				}
+				cleanupSceneColorResources();
 
-				vkDestroySwapchainKHR( m_device, m_swapChain, nullptr );
+				for ( auto framebuffer : m_swapChainFramebuffers ) {
+					deferDestroy( framebuffer );
+				}
 
-				for ( auto i = 0l; i < m_swapChainImages.size(); ++i ) {
-					vkDestroyBuffer( m_device, m_uniformBuffers[ i ], nullptr );
-					vkFreeMemory( m_device, m_uniformBuffersMemory[ i ], nullptr );
+				for ( auto imageView : m_swapChainImageViews ) {
+					deferDestroy( imageView );
 				}
 
-				vkDestroyDescriptorPool( m_device, m_descriptorPool, nullptr );
+				deferDestroy( m_swapChain );
 			}
 
 			void recreateSwapChain( void )
@@ -868,26 +1725,48 @@ namespace crimild {
 					glfwGetFramebufferSize( _window, &width, &height );
 					glfwWaitEvents();
 				}
-				
-				vkDeviceWaitIdle( m_device );
+
+				auto start = std::chrono::high_resolution_clock::now();
+
+				const auto previousFormat = m_swapChainImageFormat;
 
 				cleanupSwapChain();
 
 				createSwapChain();
 				createImageViews();
-				createRenderPass();
-				createGraphicsPipeline();
+
+				// Viewport and scissor are dynamic, so the pipeline survives unless the format changes
+				if ( m_swapChainImageFormat != previousFormat ) {
+					cleanupRenderPass();
+					createRenderPass();
+					createGraphicsPipeline();
+				}
+
 				createColorResources();
 				createDepthResources();
+				createDepthPyramid();
+				createSceneColorResources();
 				createFramebuffers();
-				createUniformBuffers();
-				createDescriptorPool();
-				createDescriptorSets();
-				createCommandBuffers();
+
+				auto elapsed = std::chrono::duration< crimild::Real64, std::milli >( std::chrono::high_resolution_clock::now() - start ).count();
+				CRIMILD_LOG_DEBUG( "Swapchain recreated in ", elapsed, "ms (", m_swapChainExtent.width, "x", m_swapChainExtent.height, ")" );
+			}
+
+			/**
+			   \brief Releases the render pass
+
+			   Pipelines are owned by the pipeline cache, which keys them by
+			   render pass compatibility, so they outlive the render pass.
+			 */
+			void cleanupRenderPass( void )
+			{
+				// Background compilations may still be using it
+				collectCompiledPipelines( true );
+				deferDestroy( m_renderPass );
 			}
 
 		private:
-			VkSwapchainKHR m_swapChain;
+			VkSwapchainKHR m_swapChain = VK_NULL_HANDLE;
 			std::vector< VkImage > m_swapChainImages;
 			VkFormat m_swapChainImageFormat;
 			VkExtent2D m_swapChainExtent;
@@ -900,17 +1779,18 @@ namespace crimild {
 			//@{
 
 		private:
-			VkImageView createImageView( VkImage image, VkFormat format, VkImageAspectFlags aspectFlags, uint32_t mipLevels )
+			VkImageView createImageView( VkImage image, VkFormat format, VkImageAspectFlags aspectFlags, uint32_t mipLevels, uint32_t layerCount = 1, uint32_t baseMipLevel = 0 )
 			{
 				auto viewInfo = VkImageViewCreateInfo {
 					.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO,
 					.image = image,
-					.viewType = VK_IMAGE_VIEW_TYPE_2D,
+					.viewType = layerCount > 1 ? VK_IMAGE_VIEW_TYPE_2D_ARRAY : VK_IMAGE_VIEW_TYPE_2D,
 					.format = format,
 					.subresourceRange.aspectMask = aspectFlags,
+					.subresourceRange.baseMipLevel = baseMipLevel,
 					.subresourceRange.levelCount = mipLevels,
 					.subresourceRange.baseArrayLayer = 0,
-					.subresourceRange.layerCount = 1,
+					.subresourceRange.layerCount = layerCount,
 				};
 
 				VkImageView imageView;
@@ -1001,6 +1881,12 @@ namespace crimild {
 			{
 				auto depthFormat = findDepthFormat();
 
+				auto usage = VkImageUsageFlags( VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT );
+				if ( m_occlusionCullingEnabled ) {
+					// Read when building the depth pyramid
+					usage |= VK_IMAGE_USAGE_SAMPLED_BIT;
+				}
+
 				createImage(
 					m_swapChainExtent.width,
 					m_swapChainExtent.height,
@@ -1008,7 +1894,7 @@ namespace crimild {
 					m_msaaSamples, //< Must match the one for color resources
 					depthFormat,
 					VK_IMAGE_TILING_OPTIMAL,
-					VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT,
+					usage,
 					VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
 					m_depthImage,
 					m_depthImageMemory
@@ -1047,129 +1933,327 @@ namespace crimild {
 			
 		private:
 
+			/**
+			   \brief Creates the layouts used by the scene shaders
+
+			   Layouts come from reflecting the shaders, except for sets with
+			   runtime-sized arrays, which use the bindless layout since they need
+			   binding flags that can't be expressed in SPIR-V.
+			 */
 			void createDescriptorSetLayout( void )
 			{
-				auto uboLayoutBinding = VkDescriptorSetLayoutBinding {
-					.binding = 0,
-					.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER,
-					.descriptorCount = 1,
-					.stageFlags = VK_SHADER_STAGE_VERTEX_BIT,
-					.pImmutableSamplers = nullptr,
-				};
+				if ( m_bindlessEnabled ) {
+					createBindlessSetLayout();
+				}
 
-				auto samplerLayoutBinding = VkDescriptorSetLayoutBinding {
-					.binding = 1,
-					.descriptorCount = 1,
-					.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,
-					.pImmutableSamplers = nullptr,
-					.stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT,
-				};
+				auto layout = makePipelineLayoutDescriptor( reflectShaders( getSceneVertexShader(), getSceneFragmentShader() ) );
+				if ( layout.setLayouts.empty() ) {
+					throw RuntimeException( "Scene shaders don't use any descriptor set" );
+				}
 
-				std::array< VkDescriptorSetLayoutBinding, 2 > bindings = {
-					uboLayoutBinding,
-					samplerLayoutBinding,
-				};
+				m_descriptorSetLayout = layout.setLayouts[ 0 ];
+			}
+
+			/**
+			   \brief Returns a layout matching the descriptor, creating it if needed
+			 */
+			VkDescriptorSetLayout getDescriptorSetLayout( const DescriptorSetLayoutDescriptor &descriptor )
+			{
+				auto it = m_descriptorSetLayoutCache.find( descriptor );
+				if ( it != m_descriptorSetLayoutCache.end() ) {
+					return it->second;
+				}
 
 				auto layoutInfo = VkDescriptorSetLayoutCreateInfo {
 					.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO,
-					.bindingCount = static_cast< uint32_t >( bindings.size() ),
-					.pBindings = bindings.data()
+					.bindingCount = static_cast< uint32_t >( descriptor.bindings.size() ),
+					.pBindings = descriptor.bindings.data()
 				};
 
-				if ( vkCreateDescriptorSetLayout( m_device, &layoutInfo, nullptr, &m_descriptorSetLayout ) != VK_SUCCESS ) {
+				VkDescriptorSetLayout layout;
+				if ( vkCreateDescriptorSetLayout( m_device, &layoutInfo, nullptr, &layout ) != VK_SUCCESS ) {
 					throw RuntimeException( "Failed to create descriptor set layout" );
 				}
+
+				m_descriptorSetLayoutCache[ descriptor ] = layout;
+
+				CRIMILD_LOG_DEBUG( "Descriptor set layout created (", m_descriptorSetLayoutCache.size(), " cached)" );
+
+				return layout;
 			}
 
-			void createDescriptorPool( void )
+			/**
+			   \brief Builds a pipeline layout from the merged interface of all stages
+			 */
+			PipelineLayoutDescriptor makePipelineLayoutDescriptor( const ShaderReflection &reflection )
 			{
-				std::array< VkDescriptorPoolSize, 2 > poolSizes = {
-					VkDescriptorPoolSize {
-						.type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER,
-						.descriptorCount = static_cast< uint32_t >( m_swapChainImages.size() ),
-					},
-					VkDescriptorPoolSize {
-						.type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,
-						.descriptorCount = static_cast< uint32_t >( m_swapChainImages.size() ),
-					},
-				};
-				
-				auto poolInfo = VkDescriptorPoolCreateInfo {
-					.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO,
-					.poolSizeCount = static_cast< uint32_t >( poolSizes.size() ),
-					.pPoolSizes = poolSizes.data(),
-					.maxSets = static_cast< uint32_t >( m_swapChainImages.size() ),
-				};
+				PipelineLayoutDescriptor descriptor;
 
-				if ( vkCreateDescriptorPool( m_device, &poolInfo, nullptr, &m_descriptorPool ) != VK_SUCCESS ) {
-					throw RuntimeException( "Failed to create descriptor pool" );
+				const auto &bindings = reflection.getDescriptorBindings();
+				const auto setCount = bindings.empty() ? 0 : bindings.back().set + 1;
+
+				for ( crimild::UInt32 set = 0; set < setCount; ++set ) {
+					DescriptorSetLayoutDescriptor setDescriptor;
+					auto bindless = false;
+
+					for ( const auto &binding : bindings ) {
+						if ( binding.set != set ) {
+							continue;
+						}
+
+						bindless |= binding.descriptorCount == 0;
+
+						setDescriptor.bindings.push_back(
+							VkDescriptorSetLayoutBinding {
+								.binding = binding.binding,
+								.descriptorType = static_cast< VkDescriptorType >( binding.descriptorType ),
+								.descriptorCount = binding.descriptorCount,
+								.stageFlags = binding.stageFlags,
+								.pImmutableSamplers = nullptr,
+							}
+						);
+					}
+
+					if ( bindless ) {
+						if ( !m_bindlessEnabled ) {
+							throw RuntimeException( "Shader requires bindless descriptors, which are not supported" );
+						}
+						descriptor.setLayouts.push_back( m_bindlessSetLayout );
+					}
+					else {
+						// Sets skipped by the shaders still need a (empty) layout
+						descriptor.setLayouts.push_back( getDescriptorSetLayout( setDescriptor ) );
+					}
+				}
+
+				for ( const auto &range : reflection.getPushConstantRanges() ) {
+					descriptor.pushConstantRanges.push_back(
+						VkPushConstantRange {
+							.stageFlags = range.stageFlags,
+							.offset = range.offset,
+							.size = range.size,
+						}
+					);
 				}
+
+				return descriptor;
 			}
 
-			void createDescriptorSets( void )
+			void cleanupDescriptorSetLayouts( void )
 			{
-				std::vector< VkDescriptorSetLayout > layouts( m_swapChainImages.size(), m_descriptorSetLayout );
+				for ( auto &it : m_descriptorSetLayoutCache ) {
+					vkDestroyDescriptorSetLayout( m_device, it.second, nullptr );
+				}
+				m_descriptorSetLayoutCache.clear();
+				m_descriptorSetLayout = VK_NULL_HANDLE;
+			}
 
-				auto allocInfo = VkDescriptorSetAllocateInfo {
-					.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO,
-					.descriptorPool = m_descriptorPool,
-					.descriptorSetCount = static_cast< uint32_t >( m_swapChainImages.size() ),
-					.pSetLayouts = layouts.data(),
-				};
+			/**
+			   \brief Creates the allocators used for all descriptor sets
+
+			   Persistent sets (i.e. the ones used by materials and objects) come from
+			   m_descriptorAllocator. Sets that only live during a single frame come
+			   from the allocator for that frame, which is reset once the GPU is done
+			   with it.
+			 */
+			void createDescriptorAllocators( void )
+			{
+				m_descriptorAllocator.init( m_device, DESCRIPTOR_SETS_PER_POOL );
+			}
 
-				m_descriptorSets.resize( m_swapChainImages.size() );
+			void createFrameDescriptorAllocators( void )
+			{
+				m_frameDescriptorAllocators.resize( m_framesInFlight );
+				for ( auto &allocator : m_frameDescriptorAllocators ) {
+					allocator.init( m_device, DESCRIPTOR_SETS_PER_POOL );
+				}
+			}
 
-				if ( vkAllocateDescriptorSets( m_device, &allocInfo, m_descriptorSets.data() ) != VK_SUCCESS ) {
-					throw RuntimeException( "Failed to allocate descriptor sets" );
+			void cleanupFrameDescriptorAllocators( void )
+			{
+				for ( auto &allocator : m_frameDescriptorAllocators ) {
+					allocator.cleanup();
 				}
+				m_frameDescriptorAllocators.clear();
+			}
 
-				for ( auto i = 0l; i < m_swapChainImages.size(); ++i ) {
-					auto bufferInfo = VkDescriptorBufferInfo {
-						.buffer = m_uniformBuffers[ i ],
-						.offset = 0,
-						.range = sizeof( UniformBufferObject ),
-					};
+			void cleanupDescriptorAllocators( void )
+			{
+				CRIMILD_LOG_DEBUG(
+					"Descriptor sets: ",
+					m_descriptorAllocator.getAllocatedSetCount(), " allocated in ",
+					m_descriptorAllocator.getPoolCount(), " pools, ",
+					m_descriptorSetCacheHits, " cache hits, ",
+					m_descriptorSetCacheMisses, " misses"
+				);
+
+				m_descriptorSetCache.clear();
+				m_descriptorAllocator.cleanup();
+			}
+
+			/**
+			   \brief Returns a descriptor set with the given layout and contents
+
+			   Objects binding exactly the same resources with the same layout share
+			   a single descriptor set, which is written only once.
+			 */
+			VkDescriptorSet getDescriptorSet( VkDescriptorSetLayout layout, const std::vector< DescriptorBinding > &bindings )
+			{
+				auto key = DescriptorSetKey { layout, bindings };
+				auto it = m_descriptorSetCache.find( key );
+				if ( it != m_descriptorSetCache.end() ) {
+					++m_descriptorSetCacheHits;
+					return it->second;
+				}
+
+				++m_descriptorSetCacheMisses;
+
+				auto descriptorSet = m_descriptorAllocator.allocate( layout );
+				writeDescriptorSet( descriptorSet, bindings );
+				m_descriptorSetCache[ key ] = descriptorSet;
+				return descriptorSet;
+			}
 
-					auto imageInfo = VkDescriptorImageInfo {
-						.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
-						.imageView = m_textureImageView,
-						.sampler = m_textureSampler,
+			/**
+			   \brief Allocates and writes a descriptor set that is valid only during the current frame
+			 */
+			VkDescriptorSet getFrameDescriptorSet( VkDescriptorSetLayout layout, const std::vector< DescriptorBinding > &bindings )
+			{
+				auto descriptorSet = m_frameDescriptorAllocators[ m_currentFrame ].allocate( layout );
+				writeDescriptorSet( descriptorSet, bindings );
+				return descriptorSet;
+			}
+
+			void writeDescriptorSet( VkDescriptorSet descriptorSet, const std::vector< DescriptorBinding > &bindings )
+			{
+				// Reserve in advance, since writes keep pointers to these
+				std::vector< VkDescriptorBufferInfo > bufferInfos;
+				bufferInfos.reserve( bindings.size() );
+				std::vector< VkDescriptorImageInfo > imageInfos;
+				imageInfos.reserve( bindings.size() );
+
+				std::vector< VkWriteDescriptorSet > descriptorWrites;
+				for ( const auto &binding : bindings ) {
+					auto write = VkWriteDescriptorSet {
+						.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
+						.dstSet = descriptorSet,
+						.dstBinding = binding.binding,
+						.dstArrayElement = 0,
+						.descriptorType = binding.descriptorType,
+						.descriptorCount = 1,
 					};
 
-					std::array< VkWriteDescriptorSet, 2 > descriptorWrites {
-						VkWriteDescriptorSet {
-							.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
-							.dstSet = m_descriptorSets[ i ],
-							.dstBinding = 0,
-							.dstArrayElement = 0,
+					if ( binding.buffer != VK_NULL_HANDLE ) {
+						bufferInfos.push_back(
+							VkDescriptorBufferInfo {
+								.buffer = binding.buffer,
+								.offset = binding.offset,
+								.range = binding.range,
+							}
+						);
+						write.pBufferInfo = &bufferInfos.back();
+					}
+					else {
+						imageInfos.push_back(
+							VkDescriptorImageInfo {
+								.imageLayout = binding.imageLayout,
+								.imageView = binding.imageView,
+								.sampler = binding.sampler,
+							}
+						);
+						write.pImageInfo = &imageInfos.back();
+					}
+
+					descriptorWrites.push_back( write );
+				}
+
+				vkUpdateDescriptorSets(
+					m_device,
+					static_cast< uint32_t >( descriptorWrites.size() ),
+					descriptorWrites.data(),
+					0,
+					nullptr
+				);
+			}
+
+			/**
+			   \brief Forgets every persistent descriptor set
+
+			   Must be called whenever a resource referenced by cached sets is destroyed,
+			   and only when the GPU is not using any of them. Pools are kept for reuse.
+			 */
+			void resetDescriptorSets( void )
+			{
+				m_descriptorSetCache.clear();
+				m_descriptorAllocator.reset();
+				m_descriptorSets.clear();
+			}
+
+			/**
+			   \brief Stops sharing cached sets that reference an image view about to be destroyed
+
+			   The sets themselves are not freed, since frames in flight may still be
+			   using them. Their memory is reclaimed the next time sets are reset.
+			 */
+			void forgetDescriptorSets( VkImageView imageView )
+			{
+				if ( imageView == VK_NULL_HANDLE ) {
+					return;
+				}
+
+				for ( auto it = m_descriptorSetCache.begin(); it != m_descriptorSetCache.end(); ) {
+					const auto &bindings = it->first.bindings;
+					if ( std::any_of( bindings.begin(), bindings.end(), [ imageView ]( const auto &binding ) { return binding.imageView == imageView; } ) ) {
+						it = m_descriptorSetCache.erase( it );
+					}
+					else {
+						++it;
+					}
+				}
+			}
+
+			/**
+			   \brief Creates one descriptor set per frame in flight
+			 */
+			void createDescriptorSets( void )
+			{
+				m_descriptorSets.resize( m_framesInFlight );
+
+				for ( auto i = 0l; i < m_framesInFlight; ++i ) {
+					std::vector< DescriptorBinding > bindings = {
+						DescriptorBinding {
+							.binding = 0,
 							.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER,
-							.descriptorCount = 1,
-							.pBufferInfo = &bufferInfo,
-						},
-						VkWriteDescriptorSet {
-							.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
-							.dstSet = m_descriptorSets[ i ],
-							.dstBinding = 1,
-							.dstArrayElement = 0,
-							.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,
-							.descriptorCount = 1,
-							.pImageInfo = &imageInfo,
+							.buffer = m_uniformBuffers[ i ],
+							.offset = 0,
+							.range = sizeof( UniformBufferObject ),
 						},
 					};
 
-					vkUpdateDescriptorSets(
-						m_device,
-						static_cast< uint32_t >( descriptorWrites.size() ),
-						descriptorWrites.data(),
-						0,
-						nullptr
-					);
+					if ( !m_bindlessEnabled ) {
+						bindings.push_back(
+							DescriptorBinding {
+								.binding = 1,
+								.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,
+								.imageView = getTextureImageView(),
+								.sampler = m_textureSampler,
+								.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+							}
+						);
+					}
+
+					m_descriptorSets[ i ] = getDescriptorSet( m_descriptorSetLayout, bindings );
 				}
 			}
 
 		private:
-			VkDescriptorSetLayout m_descriptorSetLayout;
-			VkDescriptorPool m_descriptorPool;
+			VkDescriptorSetLayout m_descriptorSetLayout = VK_NULL_HANDLE;
+			std::unordered_map< DescriptorSetLayoutDescriptor, VkDescriptorSetLayout > m_descriptorSetLayoutCache;
+			DescriptorAllocator m_descriptorAllocator;
+			std::vector< DescriptorAllocator > m_frameDescriptorAllocators;
+			std::unordered_map< DescriptorSetKey, VkDescriptorSet > m_descriptorSetCache;
+			crimild::UInt32 m_descriptorSetCacheHits = 0;
+			crimild::UInt32 m_descriptorSetCacheMisses = 0;
 			std::vector< VkDescriptorSet > m_descriptorSets;
 
 			//@}
@@ -1180,78 +2264,519 @@ namespace crimild {
 			//@{
 			
 		public:
+			/**
+			   \brief Creates (or fetches) the pipeline used for the scene
+
+			   This one is always compiled synchronously, since it's the fallback
+			   used while specialized pipelines compile in the background.
+			 */
 			void createGraphicsPipeline( void )
 			{
-				auto vertShaderCode = readFile( "assets/shaders/vert.spv" );
-				auto fragShaderCode = readFile( "assets/shaders/frag.spv" );
+				m_scenePipelineDescriptor = makeDefaultPipelineDescriptor();
+				m_pipelineLayout = getPipelineLayout( m_scenePipelineDescriptor.layout );
+				m_graphicsPipeline = getGraphicsPipeline( m_scenePipelineDescriptor );
+			}
 
-				// Shader Modules
-				auto vertShaderModule = createShaderModule( vertShaderCode );
-				auto fragShaderModule = createShaderModule( fragShaderCode );
+			/**
+			   \brief Returns the scene pipeline variant for a set of shader features
 
-				// Shader Stage Creation
-				auto vertShaderStageInfo = VkPipelineShaderStageCreateInfo {
-					.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO,
-					.stage = VK_SHADER_STAGE_VERTEX_BIT,
-					.module = vertShaderModule,
-					.pName = "main",
-				};
+			   Variants share the layout with the default pipeline, which is used
+			   as fallback while they compile.
+			 */
+			VkPipeline getScenePipelineVariant( crimild::UInt32 shaderFeatures )
+			{
+				if ( shaderFeatures == m_scenePipelineDescriptor.shaderFeatures ) {
+					return m_graphicsPipeline;
+				}
 
-				auto fragShaderStageInfo = VkPipelineShaderStageCreateInfo {
-					.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO,
-					.stage = VK_SHADER_STAGE_FRAGMENT_BIT,
-					.module = fragShaderModule,
-					.pName = "main",
-				};
+				auto descriptor = m_scenePipelineDescriptor;
+				descriptor.shaderFeatures = shaderFeatures;
+				return requestGraphicsPipeline( descriptor, m_graphicsPipeline );
+			}
 
-				VkPipelineShaderStageCreateInfo shaderStages[] = {
-					vertShaderStageInfo,
-					fragShaderStageInfo,
-				};
-
-				// Vertex Input
+		private:
+			/**
+			   \brief Describes the pipeline used by the current shaders and render pass
+			 */
+			GraphicsPipelineDescriptor makeDefaultPipelineDescriptor( void )
+			{
+				auto descriptor = GraphicsPipelineDescriptor {
+					.vertexShader = getSceneVertexShader(),
+					.fragmentShader = getSceneFragmentShader(),
+					.vertexBindings = { Vertex::getBindingDescription(), InstanceData::getBindingDescription() },
+					.rasterizationSamples = m_msaaSamples,
+					.colorFormat = m_swapChainImageFormat,
+					.depthFormat = findDepthFormat(),
+				};
 
-				auto bindingDescription = Vertex::getBindingDescription();
 				auto attributeDescriptions = Vertex::getAttributeDescriptions();
+				descriptor.vertexAttributes.assign( attributeDescriptions.begin(), attributeDescriptions.end() );
+				auto instanceAttributeDescriptions = InstanceData::getAttributeDescriptions();
+				descriptor.vertexAttributes.insert( descriptor.vertexAttributes.end(), instanceAttributeDescriptions.begin(), instanceAttributeDescriptions.end() );
+
+				auto reflection = reflectShaders( descriptor.vertexShader, descriptor.fragmentShader );
+				validateVertexInputs( reflection, descriptor.vertexAttributes );
+				descriptor.layout = makePipelineLayoutDescriptor( reflection );
+
+				m_drawPushConstantStages = getDrawPushConstantStages( reflection );
+
+				return descriptor;
+			}
+
+			/**
+			   \brief Stages that must be included when pushing DrawPushConstants
+
+			   Throws if the shaders don't declare the per-draw block, which means
+			   assets/shaders is out of date with the sources.
+			 */
+			static VkShaderStageFlags getDrawPushConstantStages( const ShaderReflection &reflection )
+			{
+				VkShaderStageFlags stages = 0;
+				crimild::UInt32 end = 0;
+				for ( const auto &range : reflection.getPushConstantRanges() ) {
+					if ( range.offset < sizeof( DrawPushConstants ) ) {
+						stages |= range.stageFlags;
+						end = std::max( end, range.offset + range.size );
+					}
+				}
+
+				if ( end < sizeof( DrawPushConstants ) ) {
+					throw RuntimeException( "Scene shaders don't declare per-draw push constants. Rebuild assets/shaders from src/" );
+				}
+
+				return stages;
+			}
+
+			std::string getSceneVertexShader( void ) const
+			{
+				return m_bindlessEnabled ? "assets/shaders/unlit_texture_bindless.vert.spv" : "assets/shaders/unlit_texture.vert.spv";
+			}
+
+			std::string getSceneFragmentShader( void ) const
+			{
+				return m_bindlessEnabled ? "assets/shaders/unlit_texture_bindless.frag.spv" : "assets/shaders/unlit_texture.frag.spv";
+			}
+
+			/**
+			   \brief Makes sure every input consumed by the vertex shader is provided
+			 */
+			static void validateVertexInputs( const ShaderReflection &reflection, const std::vector< VkVertexInputAttributeDescription > &attributes )
+			{
+				for ( const auto &input : reflection.getVertexInputs() ) {
+					auto it = std::find_if(
+						attributes.begin(),
+						attributes.end(),
+						[ &input ]( const auto &attribute ) { return attribute.location == input.location; }
+					);
+
+					if ( it == attributes.end() ) {
+						throw RuntimeException( "Missing vertex attribute for shader input " + input.name );
+					}
+
+					if ( it->format != static_cast< VkFormat >( input.format ) ) {
+						throw RuntimeException( "Vertex attribute format doesn't match shader input " + input.name );
+					}
+				}
+			}
+
+			/**
+			   \brief Returns a pipeline layout matching the descriptor, creating it if needed
+			 */
+			VkPipelineLayout getPipelineLayout( const PipelineLayoutDescriptor &descriptor )
+			{
+				auto it = m_pipelineLayoutCache.find( descriptor );
+				if ( it != m_pipelineLayoutCache.end() ) {
+					return it->second;
+				}
+
+				auto pipelineLayoutInfo = VkPipelineLayoutCreateInfo {
+					.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO,
+					.setLayoutCount = static_cast< uint32_t >( descriptor.setLayouts.size() ),
+					.pSetLayouts = descriptor.setLayouts.data(),
+					.pushConstantRangeCount = static_cast< uint32_t >( descriptor.pushConstantRanges.size() ),
+					.pPushConstantRanges = descriptor.pushConstantRanges.data(),
+				};
+
+				VkPipelineLayout pipelineLayout;
+				if ( vkCreatePipelineLayout( m_device, &pipelineLayoutInfo, nullptr, &pipelineLayout ) != VK_SUCCESS ) {
+					throw RuntimeException( "Failed to create pipeline layout" );
+				}
+
+				m_pipelineLayoutCache[ descriptor ] = pipelineLayout;
+
+				return pipelineLayout;
+			}
+
+			/**
+			   \brief Returns a pipeline matching the descriptor, creating it if needed
+
+			   Pipelines are shared by every material using the same state and live
+			   until cleanup, so callers must not destroy them.
+			 */
+			VkPipeline getGraphicsPipeline( const GraphicsPipelineDescriptor &descriptor )
+			{
+				auto it = m_graphicsPipelineCache.find( descriptor );
+				if ( it != m_graphicsPipelineCache.end() ) {
+					++m_graphicsPipelineCacheHits;
+					return it->second;
+				}
+
+				// Finish a background compilation instead of starting another one
+				auto pending = m_pendingPipelines.find( descriptor );
+				if ( pending != m_pendingPipelines.end() ) {
+					try {
+						m_jobs->wait( pending->second->counter );
+					}
+					catch ( ... ) {
+						// The error is only reported once, so don't wait on this job again
+						m_pendingPipelines.erase( pending );
+						throw;
+					}
+
+					auto pipeline = pending->second->pipeline;
+					m_pendingPipelines.erase( pending );
+					if ( pipeline != VK_NULL_HANDLE ) {
+						m_graphicsPipelineCache[ descriptor ] = pipeline;
+						return pipeline;
+					}
+				}
+
+				++m_graphicsPipelineCacheMisses;
+
+				auto pipeline = compileGraphicsPipeline( descriptor, getPipelineLayout( descriptor.layout ), m_renderPass );
+				m_graphicsPipelineCache[ descriptor ] = pipeline;
+
+				return pipeline;
+			}
+
+			/**
+			   \brief Returns the pipeline for the descriptor if it's ready, or the fallback otherwise
+
+			   Missing pipelines are compiled on a worker thread and become
+			   available once collectCompiledPipelines() picks them up, so a new
+			   material never stalls the frame. The fallback must share the
+			   descriptor's layout and render pass compatibility.
+			 */
+			VkPipeline requestGraphicsPipeline( const GraphicsPipelineDescriptor &descriptor, VkPipeline fallback )
+			{
+				auto it = m_graphicsPipelineCache.find( descriptor );
+				if ( it != m_graphicsPipelineCache.end() ) {
+					++m_graphicsPipelineCacheHits;
+					return it->second;
+				}
+
+				if ( m_jobs->getWorkerCount() < 2 ) {
+					// No worker threads to compile in the background
+					return getGraphicsPipeline( descriptor );
+				}
+
+				if ( m_pendingPipelines.find( descriptor ) == m_pendingPipelines.end() ) {
+					compileGraphicsPipelineAsync( descriptor );
+				}
+
+				++m_graphicsPipelineFallbacks;
+				return fallback;
+			}
+
+			void compileGraphicsPipelineAsync( const GraphicsPipelineDescriptor &descriptor )
+			{
+				++m_graphicsPipelineCacheMisses;
+
+				// Layouts are cheap and the cache is not thread-safe, so create them here
+				auto pipelineLayout = getPipelineLayout( descriptor.layout );
+
+				// Captured so workers never read members the main thread writes. The
+				// render pass is only destroyed after pending compilations finish
+				auto renderPass = m_renderPass;
+
+				auto pending = std::make_unique< PendingPipeline >();
+				auto compiled = pending.get();
+				m_jobs->schedule(
+					"compilePipeline",
+					[ this, descriptor, pipelineLayout, renderPass, compiled ] {
+						compiled->pipeline = compileGraphicsPipeline( descriptor, pipelineLayout, renderPass );
+					},
+					&pending->counter
+				);
+
+				m_pendingPipelines[ descriptor ] = std::move( pending );
+			}
+
+			/**
+			   \brief Moves pipelines finished by worker threads into the cache
+
+			   When wait is true, blocks until every pending compilation is done.
+			 */
+			void collectCompiledPipelines( crimild::Bool wait = false )
+			{
+				for ( auto it = m_pendingPipelines.begin(); it != m_pendingPipelines.end(); ) {
+					auto &pending = *it->second;
+					if ( !wait && !pending.counter.isDone() ) {
+						++it;
+						continue;
+					}
+
+					try {
+						m_jobs->wait( pending.counter );
+						if ( pending.pipeline != VK_NULL_HANDLE ) {
+							m_graphicsPipelineCache[ it->first ] = pending.pipeline;
+						}
+					}
+					catch ( const std::exception &e ) {
+						// Keep using the fallback for this descriptor
+						CRIMILD_LOG_ERROR( "Background pipeline compilation failed: ", e.what() );
+					}
+
+					it = m_pendingPipelines.erase( it );
+				}
+			}
+
+			/**
+			   \brief Starts compiling every pipeline recorded during previous runs
+
+			   Only the serializable state is recorded (shaders and their features,
+			   raster, depth and blend state). Vertex layout and render pass
+			   compatibility are taken from the current renderer, while pipeline
+			   layouts are rebuilt from the recorded shaders, since lists recorded
+			   with bindless enabled (or disabled) use different descriptor sets.
+			   Entries whose shaders are missing or don't fit the current renderer
+			   are skipped.
+			 */
+			void prewarmPipelines( void )
+			{
+				std::ifstream file( PIPELINE_PREWARM_PATH );
+				if ( !file.is_open() ) {
+					CRIMILD_LOG_DEBUG( "No pipeline prewarm list found at ", PIPELINE_PREWARM_PATH );
+					return;
+				}
+
+				crimild::UInt32 count = 0;
+				auto descriptor = makeDefaultPipelineDescriptor();
+				while ( readPipelinePrewarmEntry( file, descriptor ) ) {
+					if ( !hasShader( descriptor.vertexShader ) || !hasShader( descriptor.fragmentShader ) ) {
+						CRIMILD_LOG_DEBUG( "Skipping prewarm entry with missing shaders ", descriptor.vertexShader, " ", descriptor.fragmentShader );
+						continue;
+					}
+
+					try {
+						auto reflection = reflectShaders( descriptor.vertexShader, descriptor.fragmentShader );
+						validateVertexInputs( reflection, descriptor.vertexAttributes );
+						descriptor.layout = makePipelineLayoutDescriptor( reflection );
+					}
+					catch ( const std::exception &e ) {
+						CRIMILD_LOG_DEBUG( "Skipping prewarm entry for ", descriptor.vertexShader, ": ", e.what() );
+						continue;
+					}
+
+					if ( m_graphicsPipelineCache.find( descriptor ) == m_graphicsPipelineCache.end()
+						 && m_pendingPipelines.find( descriptor ) == m_pendingPipelines.end() ) {
+						if ( m_jobs->getWorkerCount() >= 2 ) {
+							compileGraphicsPipelineAsync( descriptor );
+						}
+						else {
+							try {
+								getGraphicsPipeline( descriptor );
+							}
+							catch ( const std::exception &e ) {
+								CRIMILD_LOG_ERROR( "Failed to prewarm pipeline: ", e.what() );
+							}
+						}
+						++count;
+					}
+				}
+
+				CRIMILD_LOG_DEBUG( "Prewarming ", count, " pipelines from ", PIPELINE_PREWARM_PATH );
+			}
+
+			void savePipelinePrewarmList( void )
+			{
+				std::ofstream file( PIPELINE_PREWARM_PATH, std::ios::trunc );
+				if ( !file.is_open() ) {
+					CRIMILD_LOG_ERROR( "Failed to save pipeline prewarm list to ", PIPELINE_PREWARM_PATH );
+					return;
+				}
+
+				for ( const auto &it : m_graphicsPipelineCache ) {
+					writePipelinePrewarmEntry( file, it.first );
+				}
+			}
+
+			static void writePipelinePrewarmEntry( std::ostream &out, const GraphicsPipelineDescriptor &descriptor )
+			{
+				out << descriptor.vertexShader << " "
+					<< descriptor.fragmentShader << " "
+					<< descriptor.shaderFeatures << " "
+					<< descriptor.topology << " "
+					<< descriptor.polygonMode << " "
+					<< descriptor.cullMode << " "
+					<< descriptor.frontFace << " "
+					<< descriptor.depthTestEnable << " "
+					<< descriptor.depthWriteEnable << " "
+					<< descriptor.depthCompareOp << " "
+					<< descriptor.blendEnable << " "
+					<< descriptor.srcColorBlendFactor << " "
+					<< descriptor.dstColorBlendFactor << " "
+					<< descriptor.colorBlendOp << " "
+					<< descriptor.srcAlphaBlendFactor << " "
+					<< descriptor.dstAlphaBlendFactor << " "
+					<< descriptor.alphaBlendOp << "\n";
+			}
+
+			/**
+			   \brief Reads the next entry into descriptor, leaving every other field untouched
+			 */
+			static crimild::Bool readPipelinePrewarmEntry( std::istream &in, GraphicsPipelineDescriptor &descriptor )
+			{
+				std::string line;
+				std::array< crimild::UInt32, 14 > state;
+				while ( true ) {
+					if ( !std::getline( in, line ) ) {
+						return false;
+					}
+
+					std::istringstream entry( line );
+					entry >> descriptor.vertexShader >> descriptor.fragmentShader >> descriptor.shaderFeatures;
+					for ( auto &value : state ) {
+						entry >> value;
+					}
+
+					if ( entry.fail() ) {
+						// Skip malformed lines
+						continue;
+					}
+
+					break;
+				}
+
+				descriptor.topology = static_cast< VkPrimitiveTopology >( state[ 0 ] );
+				descriptor.polygonMode = static_cast< VkPolygonMode >( state[ 1 ] );
+				descriptor.cullMode = state[ 2 ];
+				descriptor.frontFace = static_cast< VkFrontFace >( state[ 3 ] );
+				descriptor.depthTestEnable = state[ 4 ];
+				descriptor.depthWriteEnable = state[ 5 ];
+				descriptor.depthCompareOp = static_cast< VkCompareOp >( state[ 6 ] );
+				descriptor.blendEnable = state[ 7 ];
+				descriptor.srcColorBlendFactor = static_cast< VkBlendFactor >( state[ 8 ] );
+				descriptor.dstColorBlendFactor = static_cast< VkBlendFactor >( state[ 9 ] );
+				descriptor.colorBlendOp = static_cast< VkBlendOp >( state[ 10 ] );
+				descriptor.srcAlphaBlendFactor = static_cast< VkBlendFactor >( state[ 11 ] );
+				descriptor.dstAlphaBlendFactor = static_cast< VkBlendFactor >( state[ 12 ] );
+				descriptor.alphaBlendOp = static_cast< VkBlendOp >( state[ 13 ] );
+
+				return true;
+			}
+
+			/**
+			   \brief Specialization constant values for the shader features of a pipeline
+
+			   Only constants declared by the shader are set, so shaders without
+			   feature switches (or older binaries) keep their defaults.
+			 */
+			class ShaderSpecialization {
+			public:
+				ShaderSpecialization( const ShaderReflection &reflection, crimild::UInt32 shaderFeatures )
+				{
+					for ( const auto &constant : reflection.getSpecializationConstants() ) {
+						if ( constant.constantID >= SHADER_FEATURE_COUNT || constant.size != sizeof( VkBool32 ) ) {
+							continue;
+						}
+
+						m_entries.push_back(
+							VkSpecializationMapEntry {
+								.constantID = constant.constantID,
+								.offset = static_cast< uint32_t >( m_values.size() * sizeof( VkBool32 ) ),
+								.size = sizeof( VkBool32 ),
+							}
+						);
+						m_values.push_back( ( shaderFeatures & ( 1u << constant.constantID ) ) != 0 ? VK_TRUE : VK_FALSE );
+					}
+
+					m_info = VkSpecializationInfo {
+						.mapEntryCount = static_cast< uint32_t >( m_entries.size() ),
+						.pMapEntries = m_entries.data(),
+						.dataSize = m_values.size() * sizeof( VkBool32 ),
+						.pData = m_values.data(),
+					};
+				}
+
+				ShaderSpecialization( const ShaderSpecialization & ) = delete;
+				ShaderSpecialization &operator=( const ShaderSpecialization & ) = delete;
+
+				const VkSpecializationInfo *getInfo( void ) const
+				{
+					return m_entries.empty() ? nullptr : &m_info;
+				}
+
+			private:
+				std::vector< VkSpecializationMapEntry > m_entries;
+				std::vector< VkBool32 > m_values;
+				VkSpecializationInfo m_info;
+			};
+
+			/**
+			   \brief Creates a pipeline without touching any cache
+
+			   Safe to call from worker threads.
+			 */
+			VkPipeline compileGraphicsPipeline( const GraphicsPipelineDescriptor &descriptor, VkPipelineLayout pipelineLayout, VkRenderPass renderPass )
+			{
+				// Shaders (owned by the shader cache)
+				const auto &vertShader = getShader( descriptor.vertexShader );
+				const auto &fragShader = getShader( descriptor.fragmentShader );
+
+				// Specialization
+				ShaderSpecialization vertSpecialization( vertShader.reflection, descriptor.shaderFeatures );
+				ShaderSpecialization fragSpecialization( fragShader.reflection, descriptor.shaderFeatures );
+
+				// Shader Stage Creation
+				auto vertShaderStageInfo = VkPipelineShaderStageCreateInfo {
+					.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO,
+					.stage = VK_SHADER_STAGE_VERTEX_BIT,
+					.module = vertShader.module,
+					.pName = "main",
+					.pSpecializationInfo = vertSpecialization.getInfo(),
+				};
+
+				auto fragShaderStageInfo = VkPipelineShaderStageCreateInfo {
+					.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO,
+					.stage = VK_SHADER_STAGE_FRAGMENT_BIT,
+					.module = fragShader.module,
+					.pName = "main",
+					.pSpecializationInfo = fragSpecialization.getInfo(),
+				};
+
+				VkPipelineShaderStageCreateInfo shaderStages[] = {
+					vertShaderStageInfo,
+					fragShaderStageInfo,
+				};
+
+				// Vertex Input
 
 				auto vertexInputInfo = VkPipelineVertexInputStateCreateInfo {
 					.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO,
-					.vertexBindingDescriptionCount = 1,
-					.pVertexBindingDescriptions = &bindingDescription,
-					.vertexAttributeDescriptionCount = static_cast< uint32_t >( attributeDescriptions.size() ),
-					.pVertexAttributeDescriptions = attributeDescriptions.data(),
+					.vertexBindingDescriptionCount = static_cast< uint32_t >( descriptor.vertexBindings.size() ),
+					.pVertexBindingDescriptions = descriptor.vertexBindings.data(),
+					.vertexAttributeDescriptionCount = static_cast< uint32_t >( descriptor.vertexAttributes.size() ),
+					.pVertexAttributeDescriptions = descriptor.vertexAttributes.data(),
 				};
 
 				// Input Assembly
 
 				auto inputAssembly = VkPipelineInputAssemblyStateCreateInfo {
 					.sType = VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO,
-					.topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST,
+					.topology = descriptor.topology,
 					.primitiveRestartEnable = VK_FALSE,
 				};
 
 				// Viewports and scissors
-
-				auto viewport = VkViewport {
-					.x = 0.0f,
-					.y = 0.0f,
-					.width = ( float ) m_swapChainExtent.width,
-					.height = ( float ) m_swapChainExtent.height,
-					.minDepth = 0.0f,
-					.maxDepth = 1.0f,
-				};
-
-				auto scissor = VkRect2D {
-					.offset = { 0, 0 },
-					.extent = m_swapChainExtent,
-				};
+				// Both are dynamic (see below), so the pipeline doesn't depend on the swapchain extent
 
 				auto viewportState = VkPipelineViewportStateCreateInfo {
 					.sType = VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO,
 					.viewportCount = 1,
-					.pViewports = &viewport,
+					.pViewports = nullptr,
 					.scissorCount = 1,
-					.pScissors = &scissor,
+					.pScissors = nullptr,
 				};
 
 				// Rasterizer
@@ -1260,10 +2785,10 @@ namespace crimild {
 					.sType = VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO,
 					.depthClampEnable = VK_FALSE, // VK_TRUE might be required for shadow maps
 					.rasterizerDiscardEnable = VK_FALSE, // VK_TRUE disables output to the framebuffer
-					.polygonMode = VK_POLYGON_MODE_FILL,
+					.polygonMode = descriptor.polygonMode,
 					.lineWidth = 1.0f,
-					.cullMode = VK_CULL_MODE_BACK_BIT,
-					.frontFace = VK_FRONT_FACE_COUNTER_CLOCKWISE,
+					.cullMode = descriptor.cullMode,
+					.frontFace = descriptor.frontFace,
 					.depthBiasEnable = VK_FALSE, // Might be needed for shadow mapping
 					.depthBiasConstantFactor = 0.0f,
 					.depthBiasClamp = 0.0f,
@@ -1275,7 +2800,7 @@ namespace crimild {
 				auto multisampling = VkPipelineMultisampleStateCreateInfo {
 					.sType = VK_STRUCTURE_TYPE_PIPELINE_MULTISAMPLE_STATE_CREATE_INFO,
 					.sampleShadingEnable = VK_FALSE,
-					.rasterizationSamples = m_msaaSamples,
+					.rasterizationSamples = descriptor.rasterizationSamples,
 					.minSampleShading = 1.0f,
 					.pSampleMask = nullptr,
 					.alphaToCoverageEnable = VK_FALSE,
@@ -1286,9 +2811,9 @@ namespace crimild {
 
 				auto depthStencil = VkPipelineDepthStencilStateCreateInfo {
 					.sType = VK_STRUCTURE_TYPE_PIPELINE_DEPTH_STENCIL_STATE_CREATE_INFO,
-					.depthTestEnable = VK_TRUE,
-					.depthWriteEnable = VK_TRUE,
-					.depthCompareOp = VK_COMPARE_OP_LESS,
+					.depthTestEnable = descriptor.depthTestEnable,
+					.depthWriteEnable = descriptor.depthWriteEnable,
+					.depthCompareOp = descriptor.depthCompareOp,
 					.depthBoundsTestEnable = VK_FALSE,
 					.minDepthBounds = 0.0f,
 					.maxDepthBounds = 1.0f,
@@ -1301,13 +2826,13 @@ namespace crimild {
 
 				auto colorBlendAttachment = VkPipelineColorBlendAttachmentState {
 					.colorWriteMask = VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT | VK_COLOR_COMPONENT_B_BIT | VK_COLOR_COMPONENT_A_BIT,
-					.blendEnable = VK_FALSE,
-					.srcColorBlendFactor = VK_BLEND_FACTOR_ONE,
-					.dstColorBlendFactor = VK_BLEND_FACTOR_ZERO,
-					.colorBlendOp = VK_BLEND_OP_ADD,
-					.srcAlphaBlendFactor = VK_BLEND_FACTOR_ONE,
-					.dstAlphaBlendFactor = VK_BLEND_FACTOR_ZERO,
-					.alphaBlendOp = VK_BLEND_OP_ADD,
+					.blendEnable = descriptor.blendEnable,
+					.srcColorBlendFactor = descriptor.srcColorBlendFactor,
+					.dstColorBlendFactor = descriptor.dstColorBlendFactor,
+					.colorBlendOp = descriptor.colorBlendOp,
+					.srcAlphaBlendFactor = descriptor.srcAlphaBlendFactor,
+					.dstAlphaBlendFactor = descriptor.dstAlphaBlendFactor,
+					.alphaBlendOp = descriptor.alphaBlendOp,
 				};
 
 				auto colorBlending = VkPipelineColorBlendStateCreateInfo {
@@ -1322,22 +2847,20 @@ namespace crimild {
 					.blendConstants[ 3 ] = 0.0f,
 				};
 
-				// Dynamic State (TBD)
+				// Dynamic State
 
-				// Pipeline layout
-
-				auto pipelineLayoutInfo = VkPipelineLayoutCreateInfo {
-					.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO,
-					.setLayoutCount = 1,
-					.pSetLayouts = &m_descriptorSetLayout,
-					.pushConstantRangeCount = 0,
-					.pPushConstantRanges = nullptr,
+				VkDynamicState dynamicStates[] = {
+					VK_DYNAMIC_STATE_VIEWPORT,
+					VK_DYNAMIC_STATE_SCISSOR,
 				};
 
-				if ( vkCreatePipelineLayout( m_device, &pipelineLayoutInfo, nullptr, &m_pipelineLayout ) != VK_SUCCESS ) {
-					throw RuntimeException( "Failed to create pipeline layout" );
-				}
+				auto dynamicState = VkPipelineDynamicStateCreateInfo {
+					.sType = VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO,
+					.dynamicStateCount = 2,
+					.pDynamicStates = dynamicStates,
+				};
 
+				// Any render pass compatible with the descriptor's formats works here
 				auto pipelineInfo = VkGraphicsPipelineCreateInfo {
 					.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO,
 					.stageCount = 2,
@@ -1349,77 +2872,468 @@ namespace crimild {
 					.pMultisampleState = &multisampling,
 					.pDepthStencilState = &depthStencil,
 					.pColorBlendState = &colorBlending,
-					.pDynamicState = nullptr,
-					.layout = m_pipelineLayout,
-					.renderPass = m_renderPass,
-					.subpass = 0,
+					.pDynamicState = &dynamicState,
+					.layout = pipelineLayout,
+					.renderPass = renderPass,
+					.subpass = descriptor.subpass,
 					.basePipelineHandle = VK_NULL_HANDLE,
 					.basePipelineIndex = -1,
 				};
 
-				if ( vkCreateGraphicsPipelines( m_device, VK_NULL_HANDLE, 1, &pipelineInfo, nullptr, &m_graphicsPipeline ) != VK_SUCCESS ) {
+				auto start = std::chrono::high_resolution_clock::now();
+
+				VkPipeline pipeline;
+				if ( vkCreateGraphicsPipelines( m_device, m_pipelineCache, 1, &pipelineInfo, nullptr, &pipeline ) != VK_SUCCESS ) {
 					throw RuntimeException( "Failed to create graphics pipeline" );
 				}
 
-				// Cleanup
-				vkDestroyShaderModule( m_device, fragShaderModule, nullptr );
-				vkDestroyShaderModule( m_device, vertShaderModule, nullptr );
+				auto elapsed = std::chrono::duration< crimild::Real64, std::milli >( std::chrono::high_resolution_clock::now() - start ).count();
+				{
+					std::lock_guard< std::mutex > lock( m_pipelineCreationStatsMutex );
+					m_pipelineCreationStats.record( elapsed );
+				}
+				CRIMILD_LOG_DEBUG( "Graphics pipeline created in ", elapsed, "ms" );
+
+				return pipeline;
+			}
+
+			void cleanupPipelines( void )
+			{
+				collectCompiledPipelines( true );
+				savePipelinePrewarmList();
+
+				auto requests = m_graphicsPipelineCacheHits + m_graphicsPipelineCacheMisses;
+				CRIMILD_LOG_DEBUG(
+					"Pipeline cache: ",
+					m_graphicsPipelineCache.size(), " pipelines, ",
+					m_pipelineLayoutCache.size(), " layouts, ",
+					m_graphicsPipelineCacheHits, " hits, ",
+					m_graphicsPipelineCacheMisses, " misses (",
+					requests > 0 ? 100.0 * m_graphicsPipelineCacheHits / requests : 0.0, "% hit rate), ",
+					m_graphicsPipelineFallbacks, " fallbacks"
+				);
+
+				for ( auto &it : m_graphicsPipelineCache ) {
+					vkDestroyPipeline( m_device, it.second, nullptr );
+				}
+				m_graphicsPipelineCache.clear();
+
+				for ( auto &it : m_pipelineLayoutCache ) {
+					vkDestroyPipelineLayout( m_device, it.second, nullptr );
+				}
+				m_pipelineLayoutCache.clear();
+
+				m_graphicsPipeline = VK_NULL_HANDLE;
+				m_pipelineLayout = VK_NULL_HANDLE;
 			}
 
 		private:
-			VkPipelineLayout m_pipelineLayout;
-			VkPipeline m_graphicsPipeline;
+			VkPipelineLayout m_pipelineLayout = VK_NULL_HANDLE;
+			VkPipeline m_graphicsPipeline = VK_NULL_HANDLE;
+			GraphicsPipelineDescriptor m_scenePipelineDescriptor;
+			VkShaderStageFlags m_drawPushConstantStages = VK_SHADER_STAGE_VERTEX_BIT;
+
+			std::unordered_map< GraphicsPipelineDescriptor, VkPipeline > m_graphicsPipelineCache;
+			std::unordered_map< PipelineLayoutDescriptor, VkPipelineLayout > m_pipelineLayoutCache;
+			crimild::UInt32 m_graphicsPipelineCacheHits = 0;
+			crimild::UInt32 m_graphicsPipelineCacheMisses = 0;
+			crimild::UInt32 m_graphicsPipelineFallbacks = 0;
+
+			struct PendingPipeline {
+				JobCounter counter;
+				VkPipeline pipeline = VK_NULL_HANDLE;
+			};
+
+			std::unordered_map< GraphicsPipelineDescriptor, std::unique_ptr< PendingPipeline >> m_pendingPipelines;
 
 			//@}
 
 			/**
-			   \name Shaders
-			*/
+			   \name Pipeline cache
+
+			   Compiled pipelines are kept in a VkPipelineCache that is loaded from disk
+			   at startup and written back on shutdown, so the driver only compiles
+			   shaders the first time the application runs (or after a driver update).
+
+			   The file starts with our own header, identifying the device and driver
+			   that produced the data. A cache from a different device or driver is
+			   discarded instead of handed to the driver.
+			 */
 			//@{
 
 		private:
+			struct PipelineCacheFileHeader {
+				crimild::UInt32 magic;
+				crimild::UInt32 version;
+				crimild::UInt32 vendorID;
+				crimild::UInt32 deviceID;
+				crimild::UInt32 driverVersion;
+				crimild::UInt32 reserved;
+				crimild::UInt8 pipelineCacheUUID[ VK_UUID_SIZE ];
+				crimild::UInt64 dataSize;
+			};
+
+			static constexpr crimild::UInt32 PIPELINE_CACHE_MAGIC = 0x48435043; // "CPCH"
+			static constexpr crimild::UInt32 PIPELINE_CACHE_VERSION = 1;
+
+			PipelineCacheFileHeader makePipelineCacheFileHeader( crimild::UInt64 dataSize ) const
+			{
+				VkPhysicalDeviceProperties properties;
+				vkGetPhysicalDeviceProperties( m_physicalDevice, &properties );
+
+				auto header = PipelineCacheFileHeader {
+					.magic = PIPELINE_CACHE_MAGIC,
+					.version = PIPELINE_CACHE_VERSION,
+					.vendorID = properties.vendorID,
+					.deviceID = properties.deviceID,
+					.driverVersion = properties.driverVersion,
+					.reserved = 0,
+					.dataSize = dataSize,
+				};
+				memcpy( header.pipelineCacheUUID, properties.pipelineCacheUUID, VK_UUID_SIZE );
+				return header;
+			}
 
-			static std::vector< char > readFile( const std::string &filename )
+			/**
+			   \brief Reads cached pipeline data from disk, if valid for this device
+			 */
+			std::vector< char > loadPipelineCacheData( void ) const
 			{
-				std::ifstream file( filename, std::ios::ate | std::ios::binary );
+				std::ifstream file( PIPELINE_CACHE_PATH, std::ios::binary );
 				if ( !file.is_open() ) {
-					throw FileNotFoundException( "Failed to open file: " + filename );
+					CRIMILD_LOG_DEBUG( "No pipeline cache found at ", PIPELINE_CACHE_PATH );
+					return { };
 				}
 
-				auto fileSize = ( size_t ) file.tellg();
-				std::vector< char > buffer( fileSize );
+				PipelineCacheFileHeader header;
+				if ( !file.read( reinterpret_cast< char * >( &header ), sizeof( header ) ) ) {
+					CRIMILD_LOG_DEBUG( "Discarding pipeline cache: truncated header" );
+					return { };
+				}
 
-				file.seekg( 0 );
-				file.read( buffer.data(), fileSize );
+				auto expected = makePipelineCacheFileHeader( header.dataSize );
+				if ( memcmp( &header, &expected, sizeof( header ) ) != 0 ) {
+					CRIMILD_LOG_DEBUG( "Discarding pipeline cache: created by a different device or driver" );
+					return { };
+				}
 
-				file.close();
+				std::vector< char > data( header.dataSize );
+				if ( !file.read( data.data(), data.size() ) ) {
+					CRIMILD_LOG_DEBUG( "Discarding pipeline cache: truncated data" );
+					return { };
+				}
 
-				CRIMILD_LOG_DEBUG( "File ", filename, " loaded (", fileSize , " bytes)" );
+				// Data must start with a header the driver itself recognizes
+				VkPipelineCacheHeaderVersionOne driverHeader;
+				if ( data.size() < sizeof( driverHeader ) ) {
+					return { };
+				}
+				memcpy( &driverHeader, data.data(), sizeof( driverHeader ) );
+				if ( driverHeader.headerVersion != VK_PIPELINE_CACHE_HEADER_VERSION_ONE
+					 || driverHeader.vendorID != header.vendorID
+					 || driverHeader.deviceID != header.deviceID
+					 || memcmp( driverHeader.pipelineCacheUUID, header.pipelineCacheUUID, VK_UUID_SIZE ) != 0 ) {
+					CRIMILD_LOG_DEBUG( "Discarding pipeline cache: invalid driver header" );
+					return { };
+				}
 
-				return buffer;
+				return data;
 			}
 
-			VkShaderModule createShaderModule( const std::vector< char > &code )
+			void createPipelineCache( void )
 			{
-				auto createInfo = VkShaderModuleCreateInfo {
-					.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO,
-					.codeSize = code.size(),
-					.pCode = reinterpret_cast< const uint32_t * >( code.data() ),
+				auto data = loadPipelineCacheData();
+
+				auto createInfo = VkPipelineCacheCreateInfo {
+					.sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO,
+					.initialDataSize = data.size(),
+					.pInitialData = data.empty() ? nullptr : data.data(),
 				};
 
-				VkShaderModule shaderModule;
-				if ( vkCreateShaderModule( m_device, &createInfo, nullptr, &shaderModule ) != VK_SUCCESS ) {
-					throw RuntimeException( "Failed to create shader module" );
+				if ( vkCreatePipelineCache( m_device, &createInfo, nullptr, &m_pipelineCache ) != VK_SUCCESS ) {
+					throw RuntimeException( "Failed to create pipeline cache" );
 				}
 
-				return shaderModule;
-			}
+				m_pipelineCacheLoaded = !data.empty();
 
-			//@}
+				CRIMILD_LOG_DEBUG( "Pipeline cache ", m_pipelineCacheLoaded ? "loaded" : "created empty", " (", data.size(), " bytes)" );
+			}
 
 			/**
-			   \name Render Passes
-			*/
+			   \brief Writes the pipeline cache to disk and destroys it
+
+			   Data is written to a temporary file first, so an interrupted write
+			   never leaves a corrupted cache behind.
+			 */
+			void cleanupPipelineCache( void )
+			{
+				size_t dataSize = 0;
+				vkGetPipelineCacheData( m_device, m_pipelineCache, &dataSize, nullptr );
+
+				std::vector< char > data( dataSize );
+				if ( dataSize > 0 && vkGetPipelineCacheData( m_device, m_pipelineCache, &dataSize, data.data() ) == VK_SUCCESS ) {
+					auto header = makePipelineCacheFileHeader( dataSize );
+
+					auto tmpPath = PIPELINE_CACHE_PATH + ".tmp";
+					std::ofstream file( tmpPath, std::ios::binary | std::ios::trunc );
+					file.write( reinterpret_cast< const char * >( &header ), sizeof( header ) );
+					file.write( data.data(), dataSize );
+					file.close();
+
+					if ( file.good() && std::rename( tmpPath.c_str(), PIPELINE_CACHE_PATH.c_str() ) == 0 ) {
+						CRIMILD_LOG_DEBUG( "Pipeline cache saved to ", PIPELINE_CACHE_PATH, " (", dataSize, " bytes)" );
+					}
+					else {
+						CRIMILD_LOG_ERROR( "Failed to save pipeline cache to ", PIPELINE_CACHE_PATH );
+						std::remove( tmpPath.c_str() );
+					}
+				}
+
+				vkDestroyPipelineCache( m_device, m_pipelineCache, nullptr );
+				m_pipelineCache = VK_NULL_HANDLE;
+
+				const auto &histogram = m_pipelineCreationStats.histogram;
+				CRIMILD_LOG_DEBUG(
+					"Pipelines: ", m_pipelineCreationStats.count, " created in ", m_pipelineCreationStats.totalTime, "ms ",
+					"(cache ", m_pipelineCacheLoaded ? "warm" : "cold", ") ",
+					"[<1ms: ", histogram[ 0 ],
+					", <5ms: ", histogram[ 1 ],
+					", <20ms: ", histogram[ 2 ],
+					", <100ms: ", histogram[ 3 ],
+					", >=100ms: ", histogram[ 4 ], "]"
+				);
+			}
+
+		private:
+			struct PipelineCreationStats {
+				crimild::UInt32 count = 0;
+				crimild::Real64 totalTime = 0.0;
+
+				/**
+				   \brief Creation times bucketed as <1ms, <5ms, <20ms, <100ms and >=100ms
+				 */
+				std::array< crimild::UInt32, 5 > histogram = {};
+
+				void record( crimild::Real64 elapsed )
+				{
+					static constexpr crimild::Real64 BUCKET_LIMITS[] = { 1.0, 5.0, 20.0, 100.0 };
+
+					auto bucket = 0u;
+					while ( bucket < 4 && elapsed >= BUCKET_LIMITS[ bucket ] ) {
+						++bucket;
+					}
+
+					++count;
+					totalTime += elapsed;
+					++histogram[ bucket ];
+				}
+			};
+
+			VkPipelineCache m_pipelineCache = VK_NULL_HANDLE;
+			crimild::Bool m_pipelineCacheLoaded = false;
+			PipelineCreationStats m_pipelineCreationStats;
+			std::mutex m_pipelineCreationStatsMutex;
+
+			//@}
+
+			/**
+			   \name Shaders
+
+			   Every SPIR-V file is mapped and reflected once, and its module lives
+			   until cleanup. Shaders embedded at build time (see
+			   CRIMILD_VULKAN_EMBED_SHADERS) are used without touching the disk. Modules are keyed by a hash of their contents, so
+			   files with identical code share a single module. The cache is
+			   thread-safe, since pipelines compile on worker threads.
+			*/
+			//@{
+
+		private:
+			struct ShaderRecord {
+				VkShaderModule module = VK_NULL_HANDLE;
+				ShaderReflection reflection;
+				crimild::Size size = 0;
+			};
+
+			/**
+			   \brief 64-bit FNV-1a
+			 */
+			static crimild::UInt64 hashShaderCode( const crimild::UInt8 *data, crimild::Size size )
+			{
+				crimild::UInt64 hash = 0xcbf29ce484222325ull;
+				for ( crimild::Size i = 0; i < size; ++i ) {
+					hash ^= data[ i ];
+					hash *= 0x100000001b3ull;
+				}
+				return hash;
+			}
+
+			/**
+			   \brief Returns the module and interface for a SPIR-V file, loading it the first time
+			 */
+			const ShaderRecord &getShader( const std::string &filename )
+			{
+				std::lock_guard< std::mutex > lock( m_shadersMutex );
+
+				auto path = m_shaderPaths.find( filename );
+				if ( path != m_shaderPaths.end() ) {
+					++m_shaderCacheHits;
+					return m_shaders[ path->second ];
+				}
+
+				const crimild::UInt8 *data = nullptr;
+				crimild::Size size = 0;
+
+				MappedFile file;
+				if ( auto embedded = findEmbeddedShader( filename ) ) {
+					data = reinterpret_cast< const crimild::UInt8 * >( embedded->code );
+					size = embedded->size;
+				}
+				else {
+					try {
+						file.open( resolveShaderPath( filename ) );
+					}
+					catch ( const std::exception &e ) {
+						throw FileNotFoundException( e.what() );
+					}
+					data = file.getData();
+					size = file.getSize();
+				}
+
+				auto hash = hashShaderCode( data, size );
+				m_shaderPaths[ filename ] = hash;
+
+				auto it = m_shaders.find( hash );
+				if ( it != m_shaders.end() ) {
+					// Same code under a different name
+					++m_shaderCacheHits;
+					return it->second;
+				}
+
+				++m_shaderCacheMisses;
+
+				auto code = reinterpret_cast< const uint32_t * >( data );
+
+				ShaderRecord record;
+				try {
+					record.reflection = ShaderReflection( code, size / sizeof( uint32_t ) );
+				}
+				catch ( const std::exception &e ) {
+					m_shaderPaths.erase( filename );
+					throw RuntimeException( "Failed to reflect shader " + filename + ": " + e.what() );
+				}
+
+				auto createInfo = VkShaderModuleCreateInfo {
+					.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO,
+					.codeSize = size,
+					.pCode = code,
+				};
+
+				if ( vkCreateShaderModule( m_device, &createInfo, nullptr, &record.module ) != VK_SUCCESS ) {
+					m_shaderPaths.erase( filename );
+					throw RuntimeException( "Failed to create shader module" );
+				}
+
+				record.size = size;
+				m_shaderBytes += record.size;
+
+				CRIMILD_LOG_DEBUG( "Shader ", filename, " loaded (", record.size, " bytes", file.isOpen() ? ")" : ", embedded)" );
+
+				return m_shaders[ hash ] = std::move( record );
+			}
+
+#if defined( CRIMILD_VULKAN_EMBEDDED_SHADERS )
+			static const embedded::Shader *findEmbeddedShader( const std::string &filename )
+			{
+				for ( const auto &shader : embedded::SHADERS ) {
+					if ( filename == shader.path ) {
+						return &shader;
+					}
+				}
+				return nullptr;
+			}
+#else
+			struct EmbeddedShader {
+				const uint32_t *code;
+				crimild::Size size;
+			};
+
+			static const EmbeddedShader *findEmbeddedShader( const std::string & )
+			{
+				return nullptr;
+			}
+#endif
+
+			/**
+			   \brief Path to a shader file, preferring the one compiled by the build
+
+			   Shaders are compiled into the build tree, so the prebuilt binaries
+			   in the source tree are only used when running without one.
+			 */
+			static std::string resolveShaderPath( const std::string &filename )
+			{
+#if defined( CRIMILD_VULKAN_SHADER_BUILD_DIR )
+				auto built = std::string( CRIMILD_VULKAN_SHADER_BUILD_DIR ) + "/" + filename;
+				if ( std::ifstream( built ).good() ) {
+					return built;
+				}
+#endif
+				return filename;
+			}
+
+			static crimild::Bool hasShader( const std::string &filename )
+			{
+				return findEmbeddedShader( filename ) != nullptr || std::ifstream( resolveShaderPath( filename ) ).good();
+			}
+
+			VkShaderModule getShaderModule( const std::string &filename )
+			{
+				return getShader( filename ).module;
+			}
+
+			const ShaderReflection &getShaderReflection( const std::string &filename )
+			{
+				return getShader( filename ).reflection;
+			}
+
+			ShaderReflection reflectShaders( const std::string &vertexShader, const std::string &fragmentShader )
+			{
+				return ShaderReflection::merge( {
+					&getShaderReflection( vertexShader ),
+					&getShaderReflection( fragmentShader ),
+				} );
+			}
+
+			void cleanupShaders( void )
+			{
+				CRIMILD_LOG_DEBUG(
+					"Shader cache: ",
+					m_shaders.size(), " modules (", m_shaderBytes, " bytes) for ",
+					m_shaderPaths.size(), " files, ",
+					m_shaderCacheHits, " hits, ",
+					m_shaderCacheMisses, " misses"
+				);
+
+				for ( auto &it : m_shaders ) {
+					vkDestroyShaderModule( m_device, it.second.module, nullptr );
+				}
+				m_shaders.clear();
+				m_shaderPaths.clear();
+				m_shaderBytes = 0;
+			}
+
+		private:
+			std::mutex m_shadersMutex;
+			std::unordered_map< std::string, crimild::UInt64 > m_shaderPaths;
+			std::unordered_map< crimild::UInt64, ShaderRecord > m_shaders;
+			crimild::Size m_shaderBytes = 0;
+			crimild::UInt32 m_shaderCacheHits = 0;
+			crimild::UInt32 m_shaderCacheMisses = 0;
+
+			//@}
+
+			/**
+			   \name Render Passes
+			*/
 			//@{
 
 		private:
@@ -1449,7 +3363,8 @@ namespace crimild {
 					.format = findDepthFormat(),
 					.samples = m_msaaSamples,
 					.loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR,
-					.storeOp = VK_ATTACHMENT_STORE_OP_DONT_CARE,
+					// Depth is kept for the depth pyramid when doing occlusion culling
+					.storeOp = m_occlusionCullingEnabled ? VK_ATTACHMENT_STORE_OP_STORE : VK_ATTACHMENT_STORE_OP_DONT_CARE,
 					.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE,
 					.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE,
 					.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED,
@@ -1471,7 +3386,8 @@ namespace crimild {
 					.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE,
 					.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE,
 					.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED,
-					.finalLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR,
+					// With dynamic resolution, the resolved image is blitted to the swapchain afterwards
+					.finalLayout = m_dynamicResolutionEnabled ? VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL : VK_IMAGE_LAYOUT_PRESENT_SRC_KHR,
 				};
 
 				auto colorAttachmentResolveRef = VkAttachmentReference {
@@ -1494,7 +3410,8 @@ namespace crimild {
 				auto dependency = VkSubpassDependency {
 					.srcSubpass = VK_SUBPASS_EXTERNAL,
 					.dstSubpass = 0,
-					.srcStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
+					// Also wait for the previous frame's upscale to be done reading the scene color image
+					.srcStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT | ( m_dynamicResolutionEnabled ? VK_PIPELINE_STAGE_TRANSFER_BIT : 0 ),
 					.srcAccessMask = 0,
 					.dstStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
 					.dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_READ_BIT | VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT,
@@ -1543,7 +3460,7 @@ namespace crimild {
 					auto attachments = std::array< VkImageView, 3 > {
 						m_colorImageView,
 						m_depthImageView,
-						m_swapChainImageViews[ i ],
+						m_dynamicResolutionEnabled ? m_sceneColorImageView : m_swapChainImageViews[ i ],
 					};
 					
 					auto framebufferInfo = VkFramebufferCreateInfo {
@@ -1728,14 +3645,22 @@ namespace crimild {
 				vkFreeMemory( m_device, stagingBufferMemory, nullptr );
 			}
 
+			/**
+			   \brief Creates one uniform buffer per frame in flight
+
+			   Uniform buffers are indexed by frame slot instead of swapchain image, so
+			   they are only written once the GPU is done with the frame that last used
+			   them. Buffers stay mapped for their whole lifetime.
+			 */
 			void createUniformBuffers( void )
 			{
 				VkDeviceSize bufferSize = sizeof( UniformBufferObject );
 
-				m_uniformBuffers.resize( m_swapChainImages.size() );
-				m_uniformBuffersMemory.resize( m_swapChainImages.size() );
+				m_uniformBuffers.resize( m_framesInFlight );
+				m_uniformBuffersMemory.resize( m_framesInFlight );
+				m_uniformBuffersMapped.resize( m_framesInFlight );
 
-				for ( auto i = 0l; i < m_swapChainImages.size(); ++i ) {
+				for ( auto i = 0l; i < m_framesInFlight; ++i ) {
 					createBuffer(
 						bufferSize,
 						VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT,
@@ -1743,28 +3668,92 @@ namespace crimild {
 						m_uniformBuffers[ i ],
 						m_uniformBuffersMemory[ i ]
 					);
+					vkMapMemory( m_device, m_uniformBuffersMemory[ i ], 0, bufferSize, 0, &m_uniformBuffersMapped[ i ] );
 				}
 			}
 
-			void updateUniformBuffer( uint32_t currentImage )
+			void cleanupUniformBuffers( void )
 			{
-				static auto startTime = std::chrono::high_resolution_clock::now();
+				for ( auto i = 0l; i < m_uniformBuffers.size(); ++i ) {
+					vkUnmapMemory( m_device, m_uniformBuffersMemory[ i ] );
+					vkDestroyBuffer( m_device, m_uniformBuffers[ i ], nullptr );
+					vkFreeMemory( m_device, m_uniformBuffersMemory[ i ], nullptr );
+				}
+				m_uniformBuffers.clear();
+				m_uniformBuffersMemory.clear();
+				m_uniformBuffersMapped.clear();
+			}
 
-				auto currentTime = std::chrono::high_resolution_clock::now();
-				auto time = ENABLE_ROTATION * std::chrono::duration< float, std::chrono::seconds::period >( currentTime - startTime ).count();
+			void createInstanceBuffers( void )
+			{
+				m_instanceBuffers.assign( m_framesInFlight, VK_NULL_HANDLE );
+				m_instanceBuffersMemory.assign( m_framesInFlight, VK_NULL_HANDLE );
+				m_instanceBuffersMapped.assign( m_framesInFlight, nullptr );
+				m_instanceBufferCapacities.assign( m_framesInFlight, 0 );
 
-				auto ubo = UniformBufferObject { };
+				for ( auto i = 0l; i < m_framesInFlight; ++i ) {
+					reserveInstances( i, INSTANCE_BUFFER_INITIAL_CAPACITY );
+				}
+			}
 
-				// Model
-				ubo.model = []( crimild::Real32 time ) {
-					Transformation t0;
-					t0.rotate().fromAxisAngle( Vector3f::UNIT_X, -Numericf::HALF_PI );
-					Transformation t1;
-					t1.rotate().fromAxisAngle( Vector3f::UNIT_Z, time * 35.0f * Numericf::DEG_TO_RAD );
-					Transformation t;
-					t.computeFrom( t0, t1 );
-					return t.computeModelMatrix();
-				}( time );
+			void cleanupInstanceBuffers( void )
+			{
+				for ( auto i = 0l; i < m_instanceBuffers.size(); ++i ) {
+					vkUnmapMemory( m_device, m_instanceBuffersMemory[ i ] );
+					vkDestroyBuffer( m_device, m_instanceBuffers[ i ], nullptr );
+					vkFreeMemory( m_device, m_instanceBuffersMemory[ i ], nullptr );
+				}
+				m_instanceBuffers.clear();
+				m_instanceBuffersMemory.clear();
+				m_instanceBuffersMapped.clear();
+				m_instanceBufferCapacities.clear();
+			}
+
+			/**
+			   \brief Makes sure the instance buffer for a frame can hold count instances
+
+			   The frame's previous buffer might still be in use by the GPU, so
+			   it's released through the deferred destruction queue. Index 0 is
+			   always the identity transform.
+			 */
+			void reserveInstances( size_t frame, crimild::UInt32 count )
+			{
+				if ( count <= m_instanceBufferCapacities[ frame ] ) {
+					return;
+				}
+
+				auto capacity = std::max( INSTANCE_BUFFER_INITIAL_CAPACITY, m_instanceBufferCapacities[ frame ] );
+				while ( capacity < count ) {
+					capacity *= 2;
+				}
+
+				if ( m_instanceBuffers[ frame ] != VK_NULL_HANDLE ) {
+					vkUnmapMemory( m_device, m_instanceBuffersMemory[ frame ] );
+					deferDestroy( m_instanceBuffers[ frame ] );
+					deferDestroy( m_instanceBuffersMemory[ frame ] );
+				}
+
+				VkDeviceSize bufferSize = capacity * sizeof( InstanceData );
+				createBuffer(
+					bufferSize,
+					VK_BUFFER_USAGE_VERTEX_BUFFER_BIT,
+					VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+					m_instanceBuffers[ frame ],
+					m_instanceBuffersMemory[ frame ]
+				);
+
+				void *mapped;
+				vkMapMemory( m_device, m_instanceBuffersMemory[ frame ], 0, bufferSize, 0, &mapped );
+				m_instanceBuffersMapped[ frame ] = static_cast< InstanceData * >( mapped );
+				m_instanceBuffersMapped[ frame ][ 0 ] = InstanceData { .model = IDENTITY_MATRIX, .materialIndex = 0 };
+				m_instanceBufferCapacities[ frame ] = capacity;
+
+				CRIMILD_LOG_DEBUG( "Instance buffer for frame ", frame, " resized to ", capacity, " instances" );
+			}
+
+			void updateUniformBuffer( size_t frame )
+			{
+				auto ubo = UniformBufferObject { };
 
 				// TODO: Move this to Matrix
 				auto lookAt = []( const Vector3f &eye, const Vector3f &target, const Vector3f &up ) -> Matrix4f {
@@ -1807,11 +3796,10 @@ namespace crimild {
 					).getTranspose(); // TODO: why do I need to transpose this?
 					return CLIP_CORRECTION * proj;
 				}( m_swapChainExtent.width, m_swapChainExtent.height );
+
+				m_cameraUniforms = ubo;
 				
-				void *data;
-				vkMapMemory( m_device, m_uniformBuffersMemory[ currentImage ], 0, sizeof( ubo ), 0, &data );
-				memcpy( data, &ubo, sizeof( ubo ) );
-				vkUnmapMemory( m_device, m_uniformBuffersMemory[ currentImage ] );
+				memcpy( m_uniformBuffersMapped[ frame ], &ubo, sizeof( ubo ) );
 			}
 
 		private:
@@ -1826,6 +3814,17 @@ namespace crimild {
 			std::vector< VkBuffer > m_uniformBuffers;
 			std::vector< VkDeviceMemory > m_uniformBuffersMemory;
 
+			std::vector< VkBuffer > m_instanceBuffers;
+			std::vector< VkDeviceMemory > m_instanceBuffersMemory;
+			std::vector< InstanceData * > m_instanceBuffersMapped;
+			std::vector< crimild::UInt32 > m_instanceBufferCapacities;
+			std::vector< void * > m_uniformBuffersMapped;
+
+			/**
+			   Latest camera matrices, used for culling
+			 */
+			UniformBufferObject m_cameraUniforms;
+
 			//@}
 
 			/**
@@ -1857,721 +3856,4131 @@ namespace crimild {
 			}
 
 			void endSingleTimeCommands( VkCommandBuffer commandBuffer )
+			{
+				waitForTimelineValue( submitSingleTimeCommands( commandBuffer ) );
+				vkFreeCommandBuffers( m_device, m_commandPool, 1, &commandBuffer );
+			}
+
+			/**
+			   \brief Submits single time commands without waiting for them
+
+			   The command buffer must be freed once the returned timeline value is reached.
+			 */
+			crimild::UInt64 submitSingleTimeCommands( VkCommandBuffer commandBuffer )
 			{
 				vkEndCommandBuffer( commandBuffer );
-				
+
 				auto submitInfo = VkSubmitInfo {
 					.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO,
 					.commandBufferCount = 1,
 					.pCommandBuffers = &commandBuffer,
 				};
 
-				vkQueueSubmit( m_graphicsQueue, 1, &submitInfo, VK_NULL_HANDLE );
-				vkQueueWaitIdle( m_graphicsQueue );
-				vkFreeCommandBuffers( m_device, m_commandPool, 1, &commandBuffer );
+				return submitToTimeline( m_graphicsQueue, submitInfo );
 			}
 			
-			void createCommandBuffers( void )
+			/**
+			   \brief Creates command pools and buffers used for recording each frame
+
+			   Each frame in flight gets a primary command buffer, plus one command pool and
+			   secondary command buffer per recording task. Command pools cannot be used
+			   from several threads at once, and there are never more tasks than workers,
+			   so each task owns its pool regardless of the worker running it. Pools are
+			   transient and reset as a whole every frame, which is cheaper than resetting
+			   individual command buffers.
+			 */
+			void createFrameCommandBuffers( void )
 			{
-				m_commandBuffers.resize( m_swapChainFramebuffers.size() );
-
-				auto allocInfo = VkCommandBufferAllocateInfo {
-					.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO,
-					.commandPool = m_commandPool,
-					.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY,
-					.commandBufferCount = ( uint32_t ) m_commandBuffers.size(),
-				};
-
-				if ( vkAllocateCommandBuffers( m_device, &allocInfo, m_commandBuffers.data() ) != VK_SUCCESS ) {
-					throw RuntimeException( "Failed to allocate command buffers" );
-				}
+				auto queueFamilyIndices = findQueueFamilies( m_physicalDevice );
 
-				for ( auto i = 0l; i < m_commandBuffers.size(); ++i ) {
-					auto beginInfo = VkCommandBufferBeginInfo {
-						.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,
-						.flags = VK_COMMAND_BUFFER_USAGE_SIMULTANEOUS_USE_BIT,
-						.pInheritanceInfo = nullptr,
+				auto createPool = [ & ]( VkCommandBufferLevel level, VkCommandPool &pool, VkCommandBuffer &commandBuffer ) {
+					auto poolInfo = VkCommandPoolCreateInfo {
+						.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO,
+						.queueFamilyIndex = queueFamilyIndices.graphicsFamily[ 0 ],
+						.flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT,
 					};
 
-					if ( vkBeginCommandBuffer( m_commandBuffers[ i ], &beginInfo ) != VK_SUCCESS ) {
-						throw RuntimeException( "Failed to begin recording command buffer" );
+					if ( vkCreateCommandPool( m_device, &poolInfo, nullptr, &pool ) != VK_SUCCESS ) {
+						throw RuntimeException( "Failed to create command pool" );
 					}
 
-					auto clearValues = std::array< VkClearValue, 2 > {
-						VkClearValue {
-							.color = { 0.0f, 0.0f, 0.0f, 1.0f },
-						},
-						VkClearValue {
-							.depthStencil = { 1.0f, 0 },
-						},
-					};
-
-					auto renderPassInfo = VkRenderPassBeginInfo {
-						.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO,
-						.renderPass = m_renderPass,
-						.framebuffer = m_swapChainFramebuffers[ i ],
-						.renderArea.offset = { 0, 0 },
-						.renderArea.extent = m_swapChainExtent,
-						.clearValueCount = static_cast< uint32_t >( clearValues.size() ),
-						.pClearValues = clearValues.data(),
+					auto allocInfo = VkCommandBufferAllocateInfo {
+						.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO,
+						.commandPool = pool,
+						.level = level,
+						.commandBufferCount = 1,
 					};
 
-					vkCmdBeginRenderPass( m_commandBuffers[ i ], &renderPassInfo, VK_SUBPASS_CONTENTS_INLINE );
-
-					vkCmdBindPipeline( m_commandBuffers[ i ], VK_PIPELINE_BIND_POINT_GRAPHICS, m_graphicsPipeline );
-
-					// bind vertex buffers
-					VkBuffer vertexBuffers[] = { m_vertexBuffer };
-					VkDeviceSize offsets[] = { 0 };
-					vkCmdBindVertexBuffers( m_commandBuffers[ i ], 0, 1, vertexBuffers, offsets );
+					if ( vkAllocateCommandBuffers( m_device, &allocInfo, &commandBuffer ) != VK_SUCCESS ) {
+						throw RuntimeException( "Failed to allocate command buffers" );
+					}
+				};
 
-					// bind index buffer
-					vkCmdBindIndexBuffer( m_commandBuffers[ i ], m_indexBuffer, 0, VK_INDEX_TYPE_UINT32 );
+				auto taskCount = m_jobs->getWorkerCount();
 
-					// bind uniform buffers
-					vkCmdBindDescriptorSets(
-						m_commandBuffers[ i ],
-						VK_PIPELINE_BIND_POINT_GRAPHICS,
-						m_pipelineLayout,
-						0,
-						1,
-						&m_descriptorSets[ i ],
-						0,
-						nullptr
-					);
+				m_frameCommandPools.resize( m_framesInFlight );
+				m_frameCommandBuffers.resize( m_framesInFlight );
+				m_taskCommandPools.resize( m_framesInFlight );
+				m_secondaryCommandBuffers.resize( m_framesInFlight );
 
-					vkCmdDrawIndexed(
-						m_commandBuffers[ i ],
-						static_cast< uint32_t >( m_indices.size() ),
-						1,
-						0,
-						0,
-						0
-					);
+				for ( auto i = 0l; i < m_framesInFlight; ++i ) {
+					createPool( VK_COMMAND_BUFFER_LEVEL_PRIMARY, m_frameCommandPools[ i ], m_frameCommandBuffers[ i ] );
 
-					vkCmdEndRenderPass( m_commandBuffers[ i ] );
+					m_taskCommandPools[ i ].resize( taskCount );
+					m_secondaryCommandBuffers[ i ].resize( taskCount );
+					for ( crimild::UInt32 task = 0; task < taskCount; ++task ) {
+						createPool( VK_COMMAND_BUFFER_LEVEL_SECONDARY, m_taskCommandPools[ i ][ task ], m_secondaryCommandBuffers[ i ][ task ] );
+					}
+				}
+			}
 
-					if ( vkEndCommandBuffer( m_commandBuffers[ i ] ) != VK_SUCCESS ) {
-						throw RuntimeException( "Failed to record command buffer" );
+			void cleanupFrameCommandBuffers( void )
+			{
+				// Command buffers are freed along with their pools
+				for ( auto pool : m_frameCommandPools ) {
+					vkDestroyCommandPool( m_device, pool, nullptr );
+				}
+				for ( auto &pools : m_taskCommandPools ) {
+					for ( auto pool : pools ) {
+						vkDestroyCommandPool( m_device, pool, nullptr );
 					}
 				}
+				m_frameCommandPools.clear();
+				m_frameCommandBuffers.clear();
+				m_taskCommandPools.clear();
+				m_secondaryCommandBuffers.clear();
 			}
 
-		private:
 			/**
-			   Command buffers are automatically freed when their command pool
-			   is destroyed, so there's no need for an explicit cleanup.
-			 */
-			std::vector< VkCommandBuffer > m_commandBuffers;
+			   \brief Records the current draw list for the given swapchain image
 
-			//@}
+			   The command buffer for the current frame is re-recorded from scratch every
+			   frame, so changes to the scene are visible right away without rebuilding
+			   anything else.
 
-			/**
-			   \name Semaphores and Fences
+			   Large draw lists are split into contiguous ranges, each one recorded by a
+			   separate job into its own secondary command buffer. The primary command
+			   buffer then executes them in order, so the draw order is preserved.
 			 */
-			//@{
-
-		private:
-			void createSyncObjects( void )
+			void recordCommandBuffer( uint32_t imageIndex )
 			{
-				m_imageAvailableSemaphores.resize( MAX_FRAMES_IN_FLIGHT );
-				m_renderFinishedSemaphores.resize( MAX_FRAMES_IN_FLIGHT );
-				m_inFlightFences.resize( MAX_FRAMES_IN_FLIGHT );
-				
-				auto semaphoreInfo = VkSemaphoreCreateInfo {
-					.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO,
-				};
+				auto recordStart = std::chrono::high_resolution_clock::now();
 
-				auto fenceInfo = VkFenceCreateInfo {
-					.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO,
-					.flags = VK_FENCE_CREATE_SIGNALED_BIT,
+				auto commandBuffer = m_frameCommandBuffers[ m_currentFrame ];
+
+				// The fence for this frame has been signaled, so the pool is no longer in use
+				vkResetCommandPool( m_device, m_frameCommandPools[ m_currentFrame ], 0 );
+
+				auto beginInfo = VkCommandBufferBeginInfo {
+					.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,
+					.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT,
+					.pInheritanceInfo = nullptr,
 				};
 
-				for ( auto i = 0l; i < MAX_FRAMES_IN_FLIGHT; ++i ) {
-					if ( vkCreateSemaphore( m_device, &semaphoreInfo, nullptr, &m_imageAvailableSemaphores[ i ] ) != VK_SUCCESS ||
-						vkCreateSemaphore( m_device, &semaphoreInfo, nullptr, &m_renderFinishedSemaphores[ i ] ) != VK_SUCCESS ||
-						vkCreateFence( m_device, &fenceInfo, nullptr, &m_inFlightFences[ i ] ) != VK_SUCCESS ) {
-						throw RuntimeException( "Failed to create synchronization objects" );
-					}
+				if ( vkBeginCommandBuffer( commandBuffer, &beginInfo ) != VK_SUCCESS ) {
+					throw RuntimeException( "Failed to begin recording command buffer" );
 				}
-			}
 
-		private:
-			std::vector< VkSemaphore > m_imageAvailableSemaphores;
-			std::vector< VkSemaphore > m_renderFinishedSemaphores;
-			std::vector< VkFence > m_inFlightFences;
+				auto clearValues = std::array< VkClearValue, 2 > {
+					VkClearValue {
+						.color = { 0.0f, 0.0f, 0.0f, 1.0f },
+					},
+					VkClearValue {
+						.depthStencil = { 1.0f, 0 },
+					},
+				};
 
-			//@}
+				auto renderPassInfo = VkRenderPassBeginInfo {
+					.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO,
+					.renderPass = m_renderPass,
+					.framebuffer = m_swapChainFramebuffers[ imageIndex ],
+					.renderArea.offset = { 0, 0 },
+					.renderArea.extent = m_renderExtent,
+					.clearValueCount = static_cast< uint32_t >( clearValues.size() ),
+					.pClearValues = clearValues.data(),
+				};
 
-			/**
-			  \name Render frame
-			*/
-			//@{
+				const auto drawCount = static_cast< crimild::UInt32 >( m_drawList.size() );
+				const auto taskCount = std::min(
+					m_jobs->getWorkerCount(),
+					drawCount / MIN_DRAWS_PER_RECORDING_TASK
+				);
 
-		private:
-			void drawFrame( void )
+				if ( m_multiDrawIndirectEnabled ) {
+					if ( m_gpuCullingEnabled ) {
+						// Dispatches are not allowed inside render passes
+						recordCulling( commandBuffer, m_currentFrame );
+					}
+
+					// A handful of indirect calls, so there's nothing to gain from splitting them
+					vkCmdBeginRenderPass( commandBuffer, &renderPassInfo, VK_SUBPASS_CONTENTS_INLINE );
+					recordIndirectDraws( commandBuffer, m_currentFrame );
+				}
+				else if ( taskCount <= 1 ) {
+					vkCmdBeginRenderPass( commandBuffer, &renderPassInfo, VK_SUBPASS_CONTENTS_INLINE );
+					recordDraws( commandBuffer, m_currentFrame, 0, drawCount );
+				}
+				else {
+					vkCmdBeginRenderPass( commandBuffer, &renderPassInfo, VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS );
+
+					const auto frame = m_currentFrame;
+					m_jobs->parallelFor( "recordCommands", taskCount, [ & ]( crimild::UInt32 task ) {
+						auto first = drawCount * task / taskCount;
+						auto last = drawCount * ( task + 1 ) / taskCount;
+						recordSecondaryCommandBuffer( frame, task, imageIndex, first, last - first );
+					});
+
+					vkCmdExecuteCommands( commandBuffer, taskCount, m_secondaryCommandBuffers[ frame ].data() );
+				}
+
+				vkCmdEndRenderPass( commandBuffer );
+
+				if ( m_occlusionCullingEnabled ) {
+					recordDepthPyramid( commandBuffer );
+				}
+
+				if ( m_dynamicResolutionEnabled ) {
+					recordUpscale( commandBuffer, imageIndex );
+				}
+
+				if ( vkEndCommandBuffer( commandBuffer ) != VK_SUCCESS ) {
+					throw RuntimeException( "Failed to record command buffer" );
+				}
+
+				auto recordTime = std::chrono::duration< crimild::Real64, std::milli >( std::chrono::high_resolution_clock::now() - recordStart ).count();
+				m_recordStats.totalTime += recordTime;
+				m_recordStats.maxTime = std::max( m_recordStats.maxTime, recordTime );
+				m_recordStats.draws += drawCount;
+				m_recordStats.instances += m_drawListInstanceCount;
+				m_recordStats.calls += m_multiDrawIndirectEnabled ? m_indirectDraws.getBatches().size() : drawCount;
+				m_recordStats.tasks += m_multiDrawIndirectEnabled ? 1 : std::max( 1u, taskCount );
+				if ( ++m_recordStats.frames == STATS_REPORT_INTERVAL ) {
+					CRIMILD_LOG_DEBUG(
+						"Command recording: avg ", m_recordStats.totalTime / m_recordStats.frames, "ms, ",
+						"max ", m_recordStats.maxTime, "ms, ",
+						m_recordStats.draws / m_recordStats.frames, " draws/frame, ",
+						m_recordStats.instances / m_recordStats.frames, " instances/frame, ",
+						m_recordStats.calls / m_recordStats.frames, " draw calls/frame, ",
+						crimild::Real64( m_recordStats.tasks ) / m_recordStats.frames, " threads/frame"
+					);
+					m_recordStats = RecordStats { };
+				}
+			}
+
+			/**
+			   \brief Records a range of the draw list into a task's secondary command buffer
+
+			   Called from worker threads. Only touches the command pool owned by the task.
+			 */
+			void recordSecondaryCommandBuffer( size_t frame, crimild::UInt32 task, uint32_t imageIndex, crimild::UInt32 first, crimild::UInt32 count )
 			{
-				// Wait for previous frame to be finished
-				vkWaitForFences(
-					m_device,
-					1,
-					&m_inFlightFences[ m_currentFrame ],
-					VK_TRUE,
-					std::numeric_limits< uint64_t >::max()
-				);
+				vkResetCommandPool( m_device, m_taskCommandPools[ frame ][ task ], 0 );
 
-				// Acquire image from swap chain
-				uint32_t imageIndex;
-				auto result = vkAcquireNextImageKHR(
-					m_device,
-					m_swapChain,
-					std::numeric_limits< uint64_t >::max(),
-					m_imageAvailableSemaphores[ m_currentFrame ],
-					VK_NULL_HANDLE,
-					&imageIndex
+				auto commandBuffer = m_secondaryCommandBuffers[ frame ][ task ];
+
+				auto inheritanceInfo = VkCommandBufferInheritanceInfo {
+					.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_INFO,
+					.renderPass = m_renderPass,
+					.subpass = 0,
+					.framebuffer = m_swapChainFramebuffers[ imageIndex ],
+				};
+
+				auto beginInfo = VkCommandBufferBeginInfo {
+					.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,
+					.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT | VK_COMMAND_BUFFER_USAGE_RENDER_PASS_CONTINUE_BIT,
+					.pInheritanceInfo = &inheritanceInfo,
+				};
+
+				if ( vkBeginCommandBuffer( commandBuffer, &beginInfo ) != VK_SUCCESS ) {
+					throw RuntimeException( "Failed to begin recording secondary command buffer" );
+				}
+
+				recordDraws( commandBuffer, frame, first, count );
+
+				if ( vkEndCommandBuffer( commandBuffer ) != VK_SUCCESS ) {
+					throw RuntimeException( "Failed to record secondary command buffer" );
+				}
+			}
+
+			/**
+			   \brief Binds state and records draws [ first, first + count ) from the draw list
+
+			   Secondary command buffers don't inherit bound state, so every one of
+			   them binds everything again.
+			 */
+			void recordDraws( VkCommandBuffer commandBuffer, size_t frame, crimild::UInt32 first, crimild::UInt32 count )
+			{
+				bindDrawState( commandBuffer, frame );
+
+				VkPipeline boundPipeline = VK_NULL_HANDLE;
+				for ( auto i = first; i < first + count; ++i ) {
+					const auto &draw = m_drawList[ i ];
+
+					// Every variant shares the same layout, so descriptor sets stay bound
+					if ( draw.pipeline != boundPipeline ) {
+						vkCmdBindPipeline( commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, draw.pipeline );
+						boundPipeline = draw.pipeline;
+					}
+
+					auto pushConstants = DrawPushConstants {
+						.model = draw.model,
+						.materialIndex = draw.materialIndex,
+					};
+					vkCmdPushConstants( commandBuffer, m_pipelineLayout, m_drawPushConstantStages, 0, sizeof( DrawPushConstants ), &pushConstants );
+
+					vkCmdDrawIndexed(
+						commandBuffer,
+						draw.indexCount,
+						draw.instanceCount,
+						draw.firstIndex,
+						draw.vertexOffset,
+						draw.firstInstance
+					);
+				}
+			}
+
+			/**
+			   \brief Sets viewport and scissor and binds buffers and descriptor sets shared by all draws
+			 */
+			void bindDrawState( VkCommandBuffer commandBuffer, size_t frame )
+			{
+				auto viewport = VkViewport {
+					.x = 0.0f,
+					.y = 0.0f,
+					.width = ( float ) m_renderExtent.width,
+					.height = ( float ) m_renderExtent.height,
+					.minDepth = 0.0f,
+					.maxDepth = 1.0f,
+				};
+				vkCmdSetViewport( commandBuffer, 0, 1, &viewport );
+
+				auto scissor = VkRect2D {
+					.offset = { 0, 0 },
+					.extent = m_renderExtent,
+				};
+				vkCmdSetScissor( commandBuffer, 0, 1, &scissor );
+
+				// bind vertex and instance buffers
+				VkBuffer vertexBuffers[] = { m_vertexBuffer, m_instanceBuffers[ frame ] };
+				VkDeviceSize offsets[] = { 0, 0 };
+				vkCmdBindVertexBuffers( commandBuffer, 0, 2, vertexBuffers, offsets );
+
+				// bind index buffer
+				vkCmdBindIndexBuffer( commandBuffer, m_indexBuffer, 0, VK_INDEX_TYPE_UINT32 );
+
+				// bind uniform buffers
+				vkCmdBindDescriptorSets(
+					commandBuffer,
+					VK_PIPELINE_BIND_POINT_GRAPHICS,
+					m_pipelineLayout,
+					0,
+					1,
+					&m_descriptorSets[ frame ],
+					0,
+					nullptr
 				);
 
-				if ( result == VK_ERROR_OUT_OF_DATE_KHR ) {
-					// The swap chain has become incompatible with the surface
-					// and can no longer be used for rendering (window size changed?)
-					recreateSwapChain();
-					return;
+				if ( m_bindlessEnabled ) {
+					// Textures and materials are bound once for all draws
+					vkCmdBindDescriptorSets(
+						commandBuffer,
+						VK_PIPELINE_BIND_POINT_GRAPHICS,
+						m_pipelineLayout,
+						1,
+						1,
+						&m_bindlessSet,
+						0,
+						nullptr
+					);
 				}
-				else if ( result != VK_SUCCESS && result != VK_SUBOPTIMAL_KHR ) {
-					throw RuntimeException( "Failed to acquire swap chain image" );
+			}
+
+		private:
+			struct RecordStats {
+				crimild::UInt32 frames = 0;
+				crimild::UInt64 draws = 0;
+				crimild::UInt64 instances = 0;
+				crimild::UInt64 calls = 0;
+				crimild::UInt64 tasks = 0;
+				crimild::Real64 totalTime = 0.0;
+				crimild::Real64 maxTime = 0.0;
+			};
+
+			std::vector< VkCommandPool > m_frameCommandPools;
+			std::vector< VkCommandBuffer > m_frameCommandBuffers;
+			RecordStats m_recordStats;
+
+			/**
+			   Per-task command pools and secondary command buffers,
+			   indexed by [ frame ][ task ]
+			 */
+			std::vector< std::vector< VkCommandPool >> m_taskCommandPools;
+			std::vector< std::vector< VkCommandBuffer >> m_secondaryCommandBuffers;
+
+			//@}
+
+			/**
+			   \name Semaphores and Fences
+
+			   Binary semaphores order acquire, render and present on the GPU. CPU-side
+			   completion is tracked with a single GPU timeline instead of per-frame fences:
+			   every submission (frames, uploads, compute) signals the next value of a
+			   monotonically increasing counter, so anything that needs to know whether
+			   the GPU is done with a resource only has to remember a number.
+
+			   When timeline semaphores are supported, the counter is a timeline semaphore.
+			   Otherwise, each submission gets a fence from a pool and completed values
+			   are derived from fences in submission order (all submissions go to the
+			   graphics queue, so they complete in order too).
+			 */
+			//@{
+
+		private:
+			void createSyncObjects( void )
+			{
+				m_imageAvailableSemaphores.resize( m_framesInFlight );
+				m_renderFinishedSemaphores.resize( m_framesInFlight );
+				m_frameTimelineValues.assign( m_framesInFlight, 0 );
+
+				auto semaphoreInfo = VkSemaphoreCreateInfo {
+					.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO,
 				};
 
-				// Updating uniform buffers
-				updateUniformBuffer( imageIndex );
+				for ( auto i = 0l; i < m_framesInFlight; ++i ) {
+					if ( vkCreateSemaphore( m_device, &semaphoreInfo, nullptr, &m_imageAvailableSemaphores[ i ] ) != VK_SUCCESS ||
+						vkCreateSemaphore( m_device, &semaphoreInfo, nullptr, &m_renderFinishedSemaphores[ i ] ) != VK_SUCCESS ) {
+						throw RuntimeException( "Failed to create synchronization objects" );
+					}
+				}
+			}
 
-				// Submitting the command buffer
+			void cleanupSyncObjects( void )
+			{
+				for ( auto i = 0l; i < m_imageAvailableSemaphores.size(); ++i ) {
+					vkDestroySemaphore( m_device, m_renderFinishedSemaphores[ i ], nullptr );
+					vkDestroySemaphore( m_device, m_imageAvailableSemaphores[ i ], nullptr );
+				}
+				m_imageAvailableSemaphores.clear();
+				m_renderFinishedSemaphores.clear();
+				m_frameTimelineValues.clear();
+			}
 
-				VkSemaphore waitSemaphores[] = {
-					m_imageAvailableSemaphores[ m_currentFrame ],
+			crimild::Bool checkTimelineSemaphoreSupport( VkPhysicalDevice device ) const
+			{
+				if ( !m_physicalDeviceProperties2Enabled ) {
+					return false;
+				}
+
+				crimild::UInt32 extensionCount;
+				vkEnumerateDeviceExtensionProperties( device, nullptr, &extensionCount, nullptr );
+				std::vector< VkExtensionProperties > availableExtensions( extensionCount );
+				vkEnumerateDeviceExtensionProperties( device, nullptr, &extensionCount, availableExtensions.data() );
+
+				auto hasExtension = std::any_of( availableExtensions.begin(), availableExtensions.end(), []( const auto &extension ) {
+					return strcmp( extension.extensionName, VK_KHR_TIMELINE_SEMAPHORE_EXTENSION_NAME ) == 0;
+				});
+				if ( !hasExtension ) {
+					CRIMILD_LOG_DEBUG( "Timeline semaphores disabled: extension not available" );
+					return false;
+				}
+
+				auto getFeatures2 = ( PFN_vkGetPhysicalDeviceFeatures2KHR ) vkGetInstanceProcAddr( _instance, "vkGetPhysicalDeviceFeatures2KHR" );
+				if ( getFeatures2 == nullptr ) {
+					return false;
+				}
+
+				auto timelineFeatures = VkPhysicalDeviceTimelineSemaphoreFeaturesKHR {
+					.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_TIMELINE_SEMAPHORE_FEATURES_KHR,
 				};
 
-				VkPipelineStageFlags waitStages[] = {
-					VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
+				auto features = VkPhysicalDeviceFeatures2KHR {
+					.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2_KHR,
+					.pNext = &timelineFeatures,
 				};
-				
-				VkSemaphore signalSemaphores[] = {
-					m_renderFinishedSemaphores[ m_currentFrame ],
+
+				getFeatures2( device, &features );
+
+				CRIMILD_LOG_DEBUG( "Timeline semaphores ", timelineFeatures.timelineSemaphore ? "enabled" : "disabled: feature not supported" );
+
+				return timelineFeatures.timelineSemaphore;
+			}
+
+			void createTimeline( void )
+			{
+				if ( !m_timelineSemaphoresEnabled ) {
+					CRIMILD_LOG_DEBUG( "GPU timeline: using fences" );
+					return;
+				}
+
+				m_vkGetSemaphoreCounterValue = ( PFN_vkGetSemaphoreCounterValueKHR ) vkGetDeviceProcAddr( m_device, "vkGetSemaphoreCounterValueKHR" );
+				m_vkWaitSemaphores = ( PFN_vkWaitSemaphoresKHR ) vkGetDeviceProcAddr( m_device, "vkWaitSemaphoresKHR" );
+				if ( m_vkGetSemaphoreCounterValue == nullptr || m_vkWaitSemaphores == nullptr ) {
+					throw RuntimeException( "Failed to load timeline semaphore functions" );
+				}
+
+				auto typeInfo = VkSemaphoreTypeCreateInfoKHR {
+					.sType = VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO_KHR,
+					.semaphoreType = VK_SEMAPHORE_TYPE_TIMELINE_KHR,
+					.initialValue = 0,
 				};
-				
-				auto submitInfo = VkSubmitInfo {
-					.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO,
-					.waitSemaphoreCount = 1,
-					.pWaitSemaphores = waitSemaphores,
-					.pWaitDstStageMask = waitStages,
-					.commandBufferCount = 1,
-					.pCommandBuffers = &m_commandBuffers[ imageIndex ],
-					.signalSemaphoreCount = 1,
-					.pSignalSemaphores = signalSemaphores,
+
+				auto semaphoreInfo = VkSemaphoreCreateInfo {
+					.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO,
+					.pNext = &typeInfo,
 				};
 
-				vkResetFences( m_device, 1, &m_inFlightFences[ m_currentFrame ] );
-				
-				if ( vkQueueSubmit( m_graphicsQueue, 1, &submitInfo, m_inFlightFences[ m_currentFrame ] ) != VK_SUCCESS ) {
-					throw RuntimeException( "Failed to submit draw command buffer" );
+				if ( vkCreateSemaphore( m_device, &semaphoreInfo, nullptr, &m_timelineSemaphore ) != VK_SUCCESS ) {
+					throw RuntimeException( "Failed to create timeline semaphore" );
 				}
 
-				// Presentation
+				CRIMILD_LOG_DEBUG( "GPU timeline: using timeline semaphores" );
+			}
 
-				VkSwapchainKHR swapChains[] = { m_swapChain };
+			void cleanupTimeline( void )
+			{
+				waitForTimelineValue( m_timelineSubmittedValue );
 
-				auto presentInfo = VkPresentInfoKHR {
-					.sType = VK_STRUCTURE_TYPE_PRESENT_INFO_KHR,
-					.waitSemaphoreCount = 1,
-					.pWaitSemaphores = signalSemaphores,
-					.swapchainCount = 1,
-					.pSwapchains = swapChains,
-					.pImageIndices = &imageIndex,
-					.pResults = nullptr,
+				if ( m_timelineSemaphore != VK_NULL_HANDLE ) {
+					vkDestroySemaphore( m_device, m_timelineSemaphore, nullptr );
+					m_timelineSemaphore = VK_NULL_HANDLE;
+				}
+
+				for ( auto fence : m_timelineFencePool ) {
+					vkDestroyFence( m_device, fence, nullptr );
+				}
+				m_timelineFencePool.clear();
+			}
+
+			/**
+			   \brief Submits work to a queue and returns the timeline value it will signal
+
+			   The submit info is extended to also signal the GPU timeline, so callers
+			   only need to describe their own semaphores and command buffers.
+			 */
+			crimild::UInt64 submitToTimeline( VkQueue queue, VkSubmitInfo submitInfo )
+			{
+				auto value = ++m_timelineSubmittedValue;
+
+				std::vector< VkSemaphore > signalSemaphores( submitInfo.pSignalSemaphores, submitInfo.pSignalSemaphores + submitInfo.signalSemaphoreCount );
+				std::vector< uint64_t > signalValues( submitInfo.signalSemaphoreCount, 0 );
+				std::vector< uint64_t > waitValues( submitInfo.waitSemaphoreCount, 0 );
+				auto timelineInfo = VkTimelineSemaphoreSubmitInfoKHR {
+					.sType = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO_KHR,
 				};
 
-				result = vkQueuePresentKHR( m_presentQueue, &presentInfo );
-				if ( result != VK_SUCCESS ) {
-					if ( result == VK_ERROR_OUT_OF_DATE_KHR || result == VK_SUBOPTIMAL_KHR || m_framebufferResized ) {
-						// We want the best possible result, so recreate swapchain in both cases
-						recreateSwapChain();
-						m_framebufferResized = false;
+				VkFence fence = VK_NULL_HANDLE;
+				if ( m_timelineSemaphoresEnabled ) {
+					// Values for binary semaphores are ignored, but counts must match
+					signalSemaphores.push_back( m_timelineSemaphore );
+					signalValues.push_back( value );
+
+					timelineInfo.waitSemaphoreValueCount = static_cast< crimild::UInt32 >( waitValues.size() );
+					timelineInfo.pWaitSemaphoreValues = waitValues.data();
+					timelineInfo.signalSemaphoreValueCount = static_cast< crimild::UInt32 >( signalValues.size() );
+					timelineInfo.pSignalSemaphoreValues = signalValues.data();
+
+					submitInfo.pNext = &timelineInfo;
+					submitInfo.signalSemaphoreCount = static_cast< crimild::UInt32 >( signalSemaphores.size() );
+					submitInfo.pSignalSemaphores = signalSemaphores.data();
+				}
+				else {
+					fence = acquireTimelineFence();
+					m_timelinePendingFences.push_back( TimelineFence { value, fence } );
+				}
+
+				if ( vkQueueSubmit( queue, 1, &submitInfo, fence ) != VK_SUCCESS ) {
+					throw RuntimeException( "Failed to submit to queue" );
+				}
+
+				return value;
+			}
+
+			/**
+			   \brief Last timeline value known to be reached by the GPU
+
+			   Never blocks, so it's cheap enough to call every time a resource
+			   might be reclaimed.
+			 */
+			crimild::UInt64 getCompletedTimelineValue( void )
+			{
+				if ( m_timelineSemaphoresEnabled ) {
+					uint64_t value = 0;
+					m_vkGetSemaphoreCounterValue( m_device, m_timelineSemaphore, &value );
+					m_timelineCompletedValue = std::max< crimild::UInt64 >( m_timelineCompletedValue, value );
+				}
+				else {
+					while ( !m_timelinePendingFences.empty() && vkGetFenceStatus( m_device, m_timelinePendingFences.front().fence ) == VK_SUCCESS ) {
+						retireTimelineFence();
 					}
-					else {
-						throw RuntimeException( "Failed to present swap chain image" );
+				}
+
+				return m_timelineCompletedValue;
+			}
+
+			/**
+			   \brief Blocks until the GPU reaches the given timeline value
+			 */
+			void waitForTimelineValue( crimild::UInt64 value )
+			{
+				if ( value <= m_timelineCompletedValue ) {
+					return;
+				}
+
+				if ( m_timelineSemaphoresEnabled ) {
+					uint64_t waitValue = value;
+					auto waitInfo = VkSemaphoreWaitInfoKHR {
+						.sType = VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO_KHR,
+						.semaphoreCount = 1,
+						.pSemaphores = &m_timelineSemaphore,
+						.pValues = &waitValue,
+					};
+					m_vkWaitSemaphores( m_device, &waitInfo, std::numeric_limits< uint64_t >::max() );
+					m_timelineCompletedValue = value;
+				}
+				else {
+					while ( !m_timelinePendingFences.empty() && m_timelinePendingFences.front().value <= value ) {
+						vkWaitForFences( m_device, 1, &m_timelinePendingFences.front().fence, VK_TRUE, std::numeric_limits< uint64_t >::max() );
+						retireTimelineFence();
 					}
 				}
+			}
+
+			VkFence acquireTimelineFence( void )
+			{
+				if ( !m_timelineFencePool.empty() ) {
+					auto fence = m_timelineFencePool.back();
+					m_timelineFencePool.pop_back();
+					return fence;
+				}
+
+				auto fenceInfo = VkFenceCreateInfo {
+					.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO,
+				};
+
+				VkFence fence;
+				if ( vkCreateFence( m_device, &fenceInfo, nullptr, &fence ) != VK_SUCCESS ) {
+					throw RuntimeException( "Failed to create fence" );
+				}
+				return fence;
+			}
+
+			void retireTimelineFence( void )
+			{
+				auto &pending = m_timelinePendingFences.front();
+				m_timelineCompletedValue = pending.value;
+				vkResetFences( m_device, 1, &pending.fence );
+				m_timelineFencePool.push_back( pending.fence );
+				m_timelinePendingFences.pop_front();
+			}
+
+		private:
+			std::vector< VkSemaphore > m_imageAvailableSemaphores;
+			std::vector< VkSemaphore > m_renderFinishedSemaphores;
+
+			/**
+			   Timeline value signaled by the last submission of each frame slot
+			 */
+			std::vector< crimild::UInt64 > m_frameTimelineValues;
+
+			/**
+			   Timeline value of the frame currently rendering to each swapchain image, if any
+			 */
+			std::vector< crimild::UInt64 > m_imageTimelineValues;
+
+			struct TimelineFence {
+				crimild::UInt64 value;
+				VkFence fence;
+			};
+
+			crimild::Bool m_timelineSemaphoresEnabled = false;
+			VkSemaphore m_timelineSemaphore = VK_NULL_HANDLE;
+			PFN_vkGetSemaphoreCounterValueKHR m_vkGetSemaphoreCounterValue = nullptr;
+			PFN_vkWaitSemaphoresKHR m_vkWaitSemaphores = nullptr;
+			crimild::UInt64 m_timelineSubmittedValue = 0;
+			crimild::UInt64 m_timelineCompletedValue = 0;
+			std::deque< TimelineFence > m_timelinePendingFences;
+			std::vector< VkFence > m_timelineFencePool;
+
+			//@}
+
+			/**
+			   \name Deferred destruction
+
+			   Objects that might still be referenced by submitted work are not destroyed
+			   right away. Instead, they are queued along with the last value submitted
+			   to the GPU timeline and destroyed once the timeline reaches it, so nothing
+			   has to wait for the device to be idle.
+			 */
+			//@{
+
+		private:
+			void deferDestruction( std::function< void( void ) > destroy )
+			{
+				m_deferredDestructions.push_back(
+					DeferredDestruction {
+						.timelineValue = m_timelineSubmittedValue,
+						.destroy = std::move( destroy ),
+					}
+				);
+			}
+
+			void deferDestroy( VkBuffer buffer )
+			{
+				deferDestruction( [ device = m_device, buffer ] { vkDestroyBuffer( device, buffer, nullptr ); } );
+			}
+
+			void deferDestroy( VkDeviceMemory memory )
+			{
+				deferDestruction( [ device = m_device, memory ] { vkFreeMemory( device, memory, nullptr ); } );
+			}
+
+			void deferDestroy( VkImage image )
+			{
+				deferDestruction( [ device = m_device, image ] { vkDestroyImage( device, image, nullptr ); } );
+			}
+
+			void deferDestroy( VkImageView imageView )
+			{
+				deferDestruction( [ device = m_device, imageView ] { vkDestroyImageView( device, imageView, nullptr ); } );
+			}
+
+			void deferDestroy( VkFramebuffer framebuffer )
+			{
+				deferDestruction( [ device = m_device, framebuffer ] { vkDestroyFramebuffer( device, framebuffer, nullptr ); } );
+			}
+
+			void deferDestroy( VkPipeline pipeline )
+			{
+				deferDestruction( [ device = m_device, pipeline ] { vkDestroyPipeline( device, pipeline, nullptr ); } );
+			}
+
+			void deferDestroy( VkPipelineLayout pipelineLayout )
+			{
+				deferDestruction( [ device = m_device, pipelineLayout ] { vkDestroyPipelineLayout( device, pipelineLayout, nullptr ); } );
+			}
+
+			void deferDestroy( VkRenderPass renderPass )
+			{
+				deferDestruction( [ device = m_device, renderPass ] { vkDestroyRenderPass( device, renderPass, nullptr ); } );
+			}
+
+			void deferDestroy( VkDescriptorPool descriptorPool )
+			{
+				deferDestruction( [ device = m_device, descriptorPool ] { vkDestroyDescriptorPool( device, descriptorPool, nullptr ); } );
+			}
+
+			void deferDestroy( VkSwapchainKHR swapChain )
+			{
+				deferDestruction( [ device = m_device, swapChain ] { vkDestroySwapchainKHR( device, swapChain, nullptr ); } );
+			}
+
+			/**
+			   \brief Destroys every queued object the GPU is done with
+
+			   Called once per frame. Values are queued in increasing order, so we
+			   can stop at the first one that is still pending.
+			 */
+			void collectDeferredDestructions( void )
+			{
+				if ( m_deferredDestructions.empty() ) {
+					return;
+				}
+
+				auto completed = getCompletedTimelineValue();
+				while ( !m_deferredDestructions.empty() && m_deferredDestructions.front().timelineValue <= completed ) {
+					m_deferredDestructions.front().destroy();
+					m_deferredDestructions.pop_front();
+				}
+			}
+
+			/**
+			   \brief Waits for the GPU and destroys everything in the queue
+			 */
+			void flushDeferredDestructions( void )
+			{
+				waitForTimelineValue( m_timelineSubmittedValue );
+				collectDeferredDestructions();
+			}
+
+		private:
+			struct DeferredDestruction {
+				crimild::UInt64 timelineValue;
+				std::function< void( void ) > destroy;
+			};
+
+			std::deque< DeferredDestruction > m_deferredDestructions;
+
+			//@}
+
+			/**
+			   \name Frames in flight
+
+			   Every resource written by the CPU while recording a frame (uniform buffers,
+			   descriptor sets, command pools and synchronization objects) is duplicated
+			   per frame in flight and indexed by frame slot. They are all created and
+			   destroyed together, so the number of frames in flight can change at runtime.
+
+			   Latency is measured from the moment input is polled until the GPU
+			   timeline reaches the resulting frame. This doesn't include the time spent by
+			   the presentation engine, so it's a lower bound of input-to-display latency.
+			 */
+			//@{
+
+		private:
+			void configureFramesInFlight( void )
+			{
+				m_framesInFlight = DEFAULT_FRAMES_IN_FLIGHT;
+
+				if ( auto framesInFlight = std::getenv( "CRIMILD_FRAMES_IN_FLIGHT" ) ) {
+					m_framesInFlight = std::clamp( std::atoi( framesInFlight ), 1, int( MAX_FRAMES_IN_FLIGHT ) );
+				}
+
+				if ( std::getenv( "CRIMILD_FRAMES_IN_FLIGHT_BENCHMARK" ) != nullptr ) {
+					// Go through all settings, starting from the lowest latency one
+					m_framesInFlightBenchmark.running = true;
+					m_framesInFlight = 1;
+				}
+
+				CRIMILD_LOG_DEBUG( "Frames in flight: ", m_framesInFlight );
+			}
+
+			void createFrameResources( void )
+			{
+				createUniformBuffers();
+				createInstanceBuffers();
+				createIndirectBuffers();
+				createCullingBuffers();
+				createFrameDescriptorAllocators();
+				createDescriptorSets();
+				createFrameCommandBuffers();
+				createSyncObjects();
+
+				m_currentFrame = 0;
+				m_frameLatencyStats = FrameLatencyStats { };
+			}
+
+			void cleanupFrameResources( void )
+			{
+				cleanupSyncObjects();
+				cleanupFrameCommandBuffers();
+
+				// Cached sets reference the uniform buffers destroyed below
+				resetDescriptorSets();
+				cleanupFrameDescriptorAllocators();
+				cleanupUniformBuffers();
+				cleanupInstanceBuffers();
+				cleanupIndirectBuffers();
+				cleanupCullingBuffers();
+			}
+
+			/**
+			   \brief Changes the number of frames in flight
+
+			   Waits for every submitted frame to be done, since persistent descriptor
+			   sets are reset too. Not meant to be called often.
+			 */
+			void setFramesInFlight( crimild::UInt32 framesInFlight )
+			{
+				framesInFlight = std::clamp< crimild::UInt32 >( framesInFlight, 1, MAX_FRAMES_IN_FLIGHT );
+				if ( framesInFlight == m_framesInFlight ) {
+					return;
+				}
+
+				waitForTimelineValue( m_timelineSubmittedValue );
+
+				cleanupFrameResources();
+				m_framesInFlight = framesInFlight;
+				createFrameResources();
+
+				CRIMILD_LOG_DEBUG( "Frames in flight: ", m_framesInFlight );
+			}
+
+			/**
+			   \brief Records latency for every frame the GPU finished since the last call
+
+			   Polling all slots (not only the one we're about to wait for) gets a
+			   closer estimate of when each frame was done.
+			 */
+			void collectFrameLatencies( void )
+			{
+				auto &stats = m_frameLatencyStats;
+				auto now = std::chrono::steady_clock::now();
+				auto completed = getCompletedTimelineValue();
+
+				for ( auto i = 0l; i < m_framesInFlight; ++i ) {
+					if ( !stats.pending[ i ] || m_frameTimelineValues[ i ] > completed ) {
+						continue;
+					}
+
+					auto latency = std::chrono::duration< crimild::Real64, std::milli >( now - stats.inputTimes[ i ] ).count();
+					stats.pending[ i ] = false;
+					stats.totalLatency += latency;
+					stats.maxLatency = std::max( stats.maxLatency, latency );
+					if ( stats.frames++ == 0 ) {
+						stats.start = now;
+					}
+					stats.end = now;
+				}
+
+				if ( !m_framesInFlightBenchmark.running && stats.frames >= STATS_REPORT_INTERVAL ) {
+					CRIMILD_LOG_DEBUG(
+						"Frames in flight: ", m_framesInFlight, ", ",
+						"fps: ", stats.getFPS(), ", ",
+						"latency: avg ", stats.getAverageLatency(), "ms, max ", stats.maxLatency, "ms"
+					);
+					stats = FrameLatencyStats { };
+				}
+			}
+
+			/**
+			   \brief Measures latency and fps for every frames-in-flight setting
+
+			   Each setting is measured for FRAMES_IN_FLIGHT_BENCHMARK_FRAMES frames after
+			   a short warmup. Results are logged and the window is closed once all
+			   settings have been measured.
+			 */
+			void updateFramesInFlightBenchmark( void )
+			{
+				auto &benchmark = m_framesInFlightBenchmark;
+				if ( !benchmark.running ) {
+					return;
+				}
+
+				auto &stats = m_frameLatencyStats;
+				if ( !benchmark.warmedUp ) {
+					if ( stats.frames >= FRAMES_IN_FLIGHT_BENCHMARK_WARMUP ) {
+						benchmark.warmedUp = true;
+						stats = FrameLatencyStats { };
+					}
+					return;
+				}
+
+				if ( stats.frames < FRAMES_IN_FLIGHT_BENCHMARK_FRAMES ) {
+					return;
+				}
+
+				benchmark.results.push_back( stats );
+				benchmark.warmedUp = false;
+
+				if ( m_framesInFlight < MAX_FRAMES_IN_FLIGHT ) {
+					setFramesInFlight( m_framesInFlight + 1 );
+					return;
+				}
+
+				benchmark.running = false;
+
+				std::stringstream ss;
+				ss << "Frames in flight benchmark (" << FRAMES_IN_FLIGHT_BENCHMARK_FRAMES << " frames each):";
+				for ( auto i = 0l; i < benchmark.results.size(); ++i ) {
+					const auto &result = benchmark.results[ i ];
+					ss << "\n\t" << ( i + 1 ) << " frame(s): "
+					   << result.getFPS() << " fps, "
+					   << "latency avg " << result.getAverageLatency() << "ms, "
+					   << "max " << result.maxLatency << "ms";
+				}
+				CRIMILD_LOG_DEBUG( ss.str() );
+
+				glfwSetWindowShouldClose( _window, GLFW_TRUE );
+			}
+
+		private:
+			struct FrameLatencyStats {
+				std::array< std::chrono::steady_clock::time_point, MAX_FRAMES_IN_FLIGHT > inputTimes;
+				std::array< crimild::Bool, MAX_FRAMES_IN_FLIGHT > pending = {};
+				crimild::UInt32 frames = 0;
+				crimild::Real64 totalLatency = 0.0;
+				crimild::Real64 maxLatency = 0.0;
+				std::chrono::steady_clock::time_point start;
+				std::chrono::steady_clock::time_point end;
+
+				crimild::Real64 getAverageLatency( void ) const { return frames > 0 ? totalLatency / frames : 0.0; }
+
+				crimild::Real64 getFPS( void ) const
+				{
+					auto seconds = std::chrono::duration< crimild::Real64 >( end - start ).count();
+					return seconds > 0.0 ? ( frames - 1 ) / seconds : 0.0;
+				}
+			};
+
+			struct FramesInFlightBenchmark {
+				crimild::Bool running = false;
+				crimild::Bool warmedUp = false;
+				std::vector< FrameLatencyStats > results;
+			};
+
+			crimild::UInt32 m_framesInFlight = DEFAULT_FRAMES_IN_FLIGHT;
+			std::chrono::steady_clock::time_point m_inputTime;
+			FrameLatencyStats m_frameLatencyStats;
+			FramesInFlightBenchmark m_framesInFlightBenchmark;
+
+			//@}
+
+			/**
+			   \name Dynamic resolution
+
+			   When enabled, the scene is rendered into a sub-rectangle of the attachments
+			   (which are always allocated at full size) and resolved into an offscreen
+			   image. That region is then scaled up to the swapchain image with a blit.
+			   Since viewport and scissor are dynamic, changing the render scale doesn't
+			   touch pipelines or attachments.
+
+			   The scale adapts to keep the frame time close to the target set with
+			   CRIMILD_DYNAMIC_RESOLUTION_TARGET_MS.
+			 */
+			//@{
+
+		private:
+			void configureDynamicResolution( void )
+			{
+				auto target = std::getenv( "CRIMILD_DYNAMIC_RESOLUTION_TARGET_MS" );
+				if ( target == nullptr ) {
+					return;
+				}
+
+				auto swapChainSupport = querySwapChainSupport( m_physicalDevice );
+				auto surfaceFormat = chooseSwapSurfaceFormat( swapChainSupport.formats );
+
+				VkFormatProperties formatProperties;
+				vkGetPhysicalDeviceFormatProperties( m_physicalDevice, surfaceFormat.format, &formatProperties );
+
+				const auto requiredFeatures = VK_FORMAT_FEATURE_BLIT_SRC_BIT | VK_FORMAT_FEATURE_BLIT_DST_BIT | VK_FORMAT_FEATURE_SAMPLED_IMAGE_FILTER_LINEAR_BIT;
+				if ( !( swapChainSupport.capabilities.supportedUsageFlags & VK_IMAGE_USAGE_TRANSFER_DST_BIT )
+					 || ( formatProperties.optimalTilingFeatures & requiredFeatures ) != requiredFeatures ) {
+					CRIMILD_LOG_DEBUG( "Dynamic resolution disabled: swapchain images cannot be blitted" );
+					return;
+				}
+
+				m_dynamicResolutionEnabled = true;
+				m_dynamicResolution.targetFrameTime = std::max( 1.0, std::atof( target ) );
+
+				CRIMILD_LOG_DEBUG( "Dynamic resolution enabled. Target frame time: ", m_dynamicResolution.targetFrameTime, "ms" );
+			}
+
+			void createSceneColorResources( void )
+			{
+				if ( !m_dynamicResolutionEnabled ) {
+					return;
+				}
+
+				createImage(
+					m_swapChainExtent.width,
+					m_swapChainExtent.height,
+					1,
+					VK_SAMPLE_COUNT_1_BIT,
+					m_swapChainImageFormat,
+					VK_IMAGE_TILING_OPTIMAL,
+					VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT,
+					VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+					m_sceneColorImage,
+					m_sceneColorImageMemory
+				);
+
+				m_sceneColorImageView = createImageView( m_sceneColorImage, m_swapChainImageFormat, VK_IMAGE_ASPECT_COLOR_BIT, 1 );
+			}
+
+			void cleanupSceneColorResources( void )
+			{
+				if ( !m_dynamicResolutionEnabled ) {
+					return;
+				}
+
+				deferDestroy( m_sceneColorImageView );
+				deferDestroy( m_sceneColorImage );
+				deferDestroy( m_sceneColorImageMemory );
+			}
+
+			/**
+			   \brief Updates the render scale based on recent frame times
+
+			   Frame times are smoothed and the scale only changes every few frames,
+			   which prevents it from oscillating.
+			 */
+			void updateDynamicResolution( void )
+			{
+				auto &state = m_dynamicResolution;
+
+				if ( m_dynamicResolutionEnabled ) {
+					auto now = std::chrono::steady_clock::now();
+					if ( state.lastFrameTime != std::chrono::steady_clock::time_point { } ) {
+						auto frameTime = std::chrono::duration< crimild::Real64, std::milli >( now - state.lastFrameTime ).count();
+						state.averageFrameTime = state.averageFrameTime > 0.0 ? 0.9 * state.averageFrameTime + 0.1 * frameTime : frameTime;
+					}
+					state.lastFrameTime = now;
+
+					if ( ++state.framesSinceChange >= DYNAMIC_RESOLUTION_ADJUST_INTERVAL && state.averageFrameTime > 0.0 ) {
+						auto scale = state.scale;
+						if ( state.averageFrameTime > 1.05 * state.targetFrameTime ) {
+							scale -= DYNAMIC_RESOLUTION_SCALE_STEP;
+						}
+						else if ( state.averageFrameTime < 0.85 * state.targetFrameTime ) {
+							scale += DYNAMIC_RESOLUTION_SCALE_STEP;
+						}
+						scale = std::clamp( scale, DYNAMIC_RESOLUTION_MIN_SCALE, 1.0f );
+
+						if ( scale != state.scale ) {
+							CRIMILD_LOG_DEBUG( "Render scale: ", scale, " (frame time ", state.averageFrameTime, "ms)" );
+							state.scale = scale;
+						}
+						state.framesSinceChange = 0;
+					}
+				}
+
+				m_renderExtent = VkExtent2D {
+					std::max( 1u, static_cast< uint32_t >( state.scale * m_swapChainExtent.width ) ),
+					std::max( 1u, static_cast< uint32_t >( state.scale * m_swapChainExtent.height ) ),
+				};
+			}
+
+			/**
+			   \brief Scales the rendered region up to the whole swapchain image
+
+			   Recorded right after the render pass, which leaves the scene color image
+			   in TRANSFER_SRC_OPTIMAL layout.
+			 */
+			void recordUpscale( VkCommandBuffer commandBuffer, uint32_t imageIndex )
+			{
+				auto subresourceRange = VkImageSubresourceRange {
+					.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
+					.baseMipLevel = 0,
+					.levelCount = 1,
+					.baseArrayLayer = 0,
+					.layerCount = 1,
+				};
+
+				auto barriers = std::array< VkImageMemoryBarrier, 2 > {
+					// Make resolved pixels visible to the blit
+					VkImageMemoryBarrier {
+						.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
+						.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+						.newLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+						.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+						.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+						.image = m_sceneColorImage,
+						.subresourceRange = subresourceRange,
+						.srcAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT,
+						.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT,
+					},
+					VkImageMemoryBarrier {
+						.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
+						.oldLayout = VK_IMAGE_LAYOUT_UNDEFINED,
+						.newLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+						.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+						.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+						.image = m_swapChainImages[ imageIndex ],
+						.subresourceRange = subresourceRange,
+						.srcAccessMask = 0,
+						.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT,
+					},
+				};
+
+				vkCmdPipelineBarrier(
+					commandBuffer,
+					VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT | VK_PIPELINE_STAGE_TRANSFER_BIT,
+					VK_PIPELINE_STAGE_TRANSFER_BIT,
+					0,
+					0,
+					nullptr,
+					0,
+					nullptr,
+					static_cast< uint32_t >( barriers.size() ),
+					barriers.data()
+				);
+
+				auto blit = VkImageBlit {
+					.srcSubresource = { VK_IMAGE_ASPECT_COLOR_BIT, 0, 0, 1 },
+					.srcOffsets[ 0 ] = { 0, 0, 0 },
+					.srcOffsets[ 1 ] = { int32_t( m_renderExtent.width ), int32_t( m_renderExtent.height ), 1 },
+					.dstSubresource = { VK_IMAGE_ASPECT_COLOR_BIT, 0, 0, 1 },
+					.dstOffsets[ 0 ] = { 0, 0, 0 },
+					.dstOffsets[ 1 ] = { int32_t( m_swapChainExtent.width ), int32_t( m_swapChainExtent.height ), 1 },
+				};
+
+				vkCmdBlitImage(
+					commandBuffer,
+					m_sceneColorImage,
+					VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+					m_swapChainImages[ imageIndex ],
+					VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+					1,
+					&blit,
+					VK_FILTER_LINEAR
+				);
+
+				auto presentBarrier = barriers[ 1 ];
+				presentBarrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+				presentBarrier.newLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
+				presentBarrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+				presentBarrier.dstAccessMask = 0;
+
+				vkCmdPipelineBarrier(
+					commandBuffer,
+					VK_PIPELINE_STAGE_TRANSFER_BIT,
+					VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT,
+					0,
+					0,
+					nullptr,
+					0,
+					nullptr,
+					1,
+					&presentBarrier
+				);
+			}
+
+		private:
+			struct DynamicResolutionState {
+				crimild::Real32 scale = 1.0f;
+				crimild::Real64 targetFrameTime = 0.0;
+				crimild::Real64 averageFrameTime = 0.0;
+				crimild::UInt32 framesSinceChange = 0;
+				std::chrono::steady_clock::time_point lastFrameTime;
+			};
+
+			crimild::Bool m_dynamicResolutionEnabled = false;
+			DynamicResolutionState m_dynamicResolution;
+
+			/**
+			   Region of the attachments the scene is rendered to. Matches the
+			   swapchain extent unless dynamic resolution is enabled
+			 */
+			VkExtent2D m_renderExtent;
+
+			VkImage m_sceneColorImage = VK_NULL_HANDLE;
+			VkDeviceMemory m_sceneColorImageMemory = VK_NULL_HANDLE;
+			VkImageView m_sceneColorImageView = VK_NULL_HANDLE;
+
+			//@}
+
+			/**
+			  \name Render frame
+			*/
+			//@{
+
+		private:
+			void drawFrame( void )
+			{
+				// Wait for previous frame to be finished
+				collectFrameLatencies();
+				waitForTimelineValue( m_frameTimelineValues[ m_currentFrame ] );
+				collectFrameLatencies();
+				collectDeferredDestructions();
+				collectCullingResults( m_currentFrame );
+
+				// The GPU is done with this frame's transient descriptor sets
+				m_frameDescriptorAllocators[ m_currentFrame ].reset();
+
+				collectCompiledPipelines();
+
+				// Acquire image from swap chain
+				uint32_t imageIndex;
+				auto result = vkAcquireNextImageKHR(
+					m_device,
+					m_swapChain,
+					std::numeric_limits< uint64_t >::max(),
+					m_imageAvailableSemaphores[ m_currentFrame ],
+					VK_NULL_HANDLE,
+					&imageIndex
+				);
+
+				if ( result == VK_ERROR_OUT_OF_DATE_KHR ) {
+					// The swap chain has become incompatible with the surface
+					// and can no longer be used for rendering (window size changed?)
+					recreateSwapChain();
+					return;
+				}
+				else if ( result != VK_SUCCESS && result != VK_SUBOPTIMAL_KHR ) {
+					throw RuntimeException( "Failed to acquire swap chain image" );
+				};
+
+				// A previous frame in a different slot may still be rendering to this image
+				waitForTimelineValue( m_imageTimelineValues[ imageIndex ] );
+
+				// Updating uniform buffers
+				updateUniformBuffer( m_currentFrame );
+				updateScene();
+
+				// Record commands for the current state of the scene
+				updateDynamicResolution();
+				buildDrawList( m_currentFrame );
+
+				// Textures used by the draw list were marked as seen while building it
+				updateTextureStreaming();
+
+				recordCommandBuffer( imageIndex );
+
+				// Submitting the command buffer
+
+				VkSemaphore waitSemaphores[] = {
+					m_imageAvailableSemaphores[ m_currentFrame ],
+				};
+
+				// The swapchain image is first written by the upscale blit when using dynamic resolution
+				VkPipelineStageFlags waitStages[] = {
+					m_dynamicResolutionEnabled ? VK_PIPELINE_STAGE_TRANSFER_BIT : VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
+				};
+				
+				VkSemaphore signalSemaphores[] = {
+					m_renderFinishedSemaphores[ m_currentFrame ],
+				};
+				
+				auto submitInfo = VkSubmitInfo {
+					.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO,
+					.waitSemaphoreCount = 1,
+					.pWaitSemaphores = waitSemaphores,
+					.pWaitDstStageMask = waitStages,
+					.commandBufferCount = 1,
+					.pCommandBuffers = &m_frameCommandBuffers[ m_currentFrame ],
+					.signalSemaphoreCount = 1,
+					.pSignalSemaphores = signalSemaphores,
+				};
+
+				auto frameValue = submitToTimeline( m_graphicsQueue, submitInfo );
+				m_frameTimelineValues[ m_currentFrame ] = frameValue;
+				m_imageTimelineValues[ imageIndex ] = frameValue;
+
+				m_frameLatencyStats.inputTimes[ m_currentFrame ] = m_inputTime;
+				m_frameLatencyStats.pending[ m_currentFrame ] = true;
+
+				// Presentation
+
+				VkSwapchainKHR swapChains[] = { m_swapChain };
+
+				auto presentInfo = VkPresentInfoKHR {
+					.sType = VK_STRUCTURE_TYPE_PRESENT_INFO_KHR,
+					.waitSemaphoreCount = 1,
+					.pWaitSemaphores = signalSemaphores,
+					.swapchainCount = 1,
+					.pSwapchains = swapChains,
+					.pImageIndices = &imageIndex,
+					.pResults = nullptr,
+				};
+
+				result = vkQueuePresentKHR( m_presentQueue, &presentInfo );
+				if ( result != VK_SUCCESS ) {
+					if ( result == VK_ERROR_OUT_OF_DATE_KHR || result == VK_SUBOPTIMAL_KHR || m_framebufferResized ) {
+						// We want the best possible result, so recreate swapchain in both cases
+						recreateSwapChain();
+						m_framebufferResized = false;
+					}
+					else {
+						throw RuntimeException( "Failed to present swap chain image" );
+					}
+				}
+
+				m_currentFrame = ( m_currentFrame + 1 ) % m_framesInFlight;
+				++m_frameCounter;
+			}
+
+		private:
+			size_t m_currentFrame = 0;
+			crimild::UInt64 m_frameCounter = 1;
+			bool m_framebufferResized = false;
+
+			//@}
+
+			/**
+			   \name Textures
+			 */
+			//@{
+
+		private:
+			// TODO: use an image descriptor?
+			void createImage(
+				uint32_t width,
+				uint32_t height,
+				uint32_t mipLevels,
+				VkSampleCountFlagBits numSamples,
+				VkFormat format,
+				VkImageTiling tiling,
+				VkImageUsageFlags usage,
+				VkMemoryPropertyFlags properties,
+				VkImage &image,
+				VkDeviceMemory &imageMemory,
+				uint32_t arrayLayers = 1 )
+			{
+				auto imageInfo = VkImageCreateInfo {
+					.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO,
+					.imageType = VK_IMAGE_TYPE_2D,
+					.extent.width = width,
+					.extent.height = height,
+					.extent.depth = 1,
+					.mipLevels = mipLevels,
+					.arrayLayers = arrayLayers,
+					// Use same format for texels as the pixels in the buffer or copy will fail
+					.format = format,
+					.tiling = tiling,
+					.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED,
+					.usage = usage,
+					.sharingMode = VK_SHARING_MODE_EXCLUSIVE,
+					.samples = numSamples,
+					.flags = 0,
+				};
+
+				if ( vkCreateImage( m_device, &imageInfo, nullptr, &image ) != VK_SUCCESS ) {
+					throw RuntimeException( "Failed to create image" );
+				}
+
+				VkMemoryRequirements memRequirements;
+				vkGetImageMemoryRequirements( m_device, image, &memRequirements );
+
+				auto allocInfo = VkMemoryAllocateInfo {
+					.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO,
+					.allocationSize = memRequirements.size,
+					.memoryTypeIndex = findMemoryType( memRequirements.memoryTypeBits, properties ),
+				};
+
+				if ( vkAllocateMemory( m_device, &allocInfo, nullptr, &imageMemory ) != VK_SUCCESS ) {
+					throw RuntimeException( "Failed to allocate image memory" );
+				}
+
+				vkBindImageMemory( m_device, image, imageMemory, 0 );
+			}
+			
+			void createTextureImage( void )
+			{
+				if ( std::ifstream( TEXTURE_CONTAINER_PATH ).good() ) {
+					// Baked textures are streamed, starting from their smallest mips
+					m_streamingTextures.push_back( createStreamingTexture( TEXTURE_CONTAINER_PATH ) );
+					return;
+				}
+
+				int texWidth, texHeight, texChannels;
+				auto pixels = stbi_load( TEXTURE_PATH.c_str(), &texWidth, &texHeight, &texChannels, STBI_rgb_alpha );
+				auto imageSize = texWidth * texHeight * 4;
+
+				if ( !pixels ) {
+					throw RuntimeException( "Failed to load texture image" );
+				}
+
+				// Compute number of mipmap levels
+				m_mipLevels = static_cast< uint32_t >( std::floor( std::log2( std::max( texWidth, texHeight ) ) ) ) + 1;
+				m_textureFormat = VK_FORMAT_R8G8B8A8_UNORM;
+				m_textureLayerCount = 1;
+
+				// Use a staging buffer instead of a staging image which should be more efficient
+				VkBuffer stagingBuffer;
+				VkDeviceMemory stagingBufferMemory;
+				createBuffer(
+					imageSize,
+					VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+					VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+					stagingBuffer,
+					stagingBufferMemory
+				);
+
+				void *data;
+				vkMapMemory( m_device, stagingBufferMemory, 0, imageSize, 0, &data );
+				memcpy( data, pixels, static_cast< size_t >( imageSize ) );
+				vkUnmapMemory( m_device, stagingBufferMemory );
+
+				// Cleanup original pixel data
+				stbi_image_free( pixels );
+
+				createImage(
+					texWidth,
+					texHeight,
+					m_mipLevels,
+					VK_SAMPLE_COUNT_1_BIT,					
+					VK_FORMAT_R8G8B8A8_UNORM,
+					VK_IMAGE_TILING_OPTIMAL,
+					VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT,
+					VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+					m_textureImage,
+					m_textureImageMemory
+				);
+
+				// Copy staging buffer to texture image
+				transitionImageLayout(
+					m_textureImage,
+					VK_FORMAT_R8G8B8A8_UNORM,
+					VK_IMAGE_LAYOUT_UNDEFINED,
+					VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+					m_mipLevels
+				);
+				copyBufferToImage(
+					stagingBuffer,
+					m_textureImage,
+					static_cast< uint32_t >( texWidth ),
+					static_cast< uint32_t >( texHeight )
+				);
+
+				generateMipmaps(
+					m_textureImage,
+					VK_FORMAT_R8G8B8A8_UNORM,
+					texWidth,
+					texHeight,
+					m_mipLevels
+				);
+
+				// cleanup
+				vkDestroyBuffer( m_device, stagingBuffer, nullptr );
+				vkFreeMemory( m_device, stagingBufferMemory, nullptr );
+			}
+
+			void generateMipmaps(
+				VkImage image,
+				VkFormat imageFormat,
+				int32_t texWidth,
+				int32_t texHeight,
+				uint32_t mipLevels )
+			{
+				// Check if image format supports linear blitting
+				VkFormatProperties formatProperties;
+				vkGetPhysicalDeviceFormatProperties( m_physicalDevice, imageFormat, &formatProperties );
+				if ( !( formatProperties.optimalTilingFeatures & VK_FORMAT_FEATURE_SAMPLED_IMAGE_FILTER_LINEAR_BIT ) ) {
+					// TODO: either search for an image format that supports linear blitting
+					// Or implement mipmap generation in software (see stb_image_resize)
+					throw RuntimeException( "Texture image format does not support linear blitting" );
+				}
+				
+				auto commandBuffer = beginSingleTimeCommands();
+
+				auto barrier = VkImageMemoryBarrier {
+					.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
+					.image = image,
+					.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+					.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+					.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
+					.subresourceRange.baseArrayLayer = 0,
+					.subresourceRange.layerCount = 1,
+					.subresourceRange.levelCount = 1,
+				};
+
+				auto mipWidth = texWidth;
+				auto mipHeight = texHeight;
+
+				for ( uint32_t i = 1; i < mipLevels; ++i ) {
+					barrier.subresourceRange.baseMipLevel = i - 1;
+					barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+					barrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+					barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+					barrier.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+
+					vkCmdPipelineBarrier(
+						commandBuffer,
+						VK_PIPELINE_STAGE_TRANSFER_BIT,
+						VK_PIPELINE_STAGE_TRANSFER_BIT,
+						0,
+						0,
+						nullptr,
+						0,
+						nullptr,
+						1,
+						&barrier
+					);
+
+					auto blit = VkImageBlit {
+						.srcOffsets[ 0 ] = { 0, 0, 0 },
+						.srcOffsets[ 1 ] = { mipWidth, mipHeight, 1 },
+						.srcSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
+						.srcSubresource.mipLevel = i - 1,
+						.srcSubresource.baseArrayLayer = 0,
+						.srcSubresource.layerCount = 1,
+						.dstOffsets[ 0 ] = { 0, 0, 0 },
+						.dstOffsets[ 1 ] = {
+							mipWidth > 1 ? mipWidth / 2 : 1,
+							mipHeight > 1 ? mipHeight / 2 : 1,
+							1
+						},
+						.dstSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
+						.dstSubresource.mipLevel = i,
+						.dstSubresource.baseArrayLayer = 0,
+						.dstSubresource.layerCount = 1,
+					};
+
+					vkCmdBlitImage(
+						commandBuffer,
+						image,
+						VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+						image,
+						VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+						1,
+						&blit,
+						VK_FILTER_LINEAR
+					);
+
+					barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+					barrier.newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+					barrier.srcAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+					barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+
+					vkCmdPipelineBarrier(
+						commandBuffer,
+						VK_PIPELINE_STAGE_TRANSFER_BIT,
+						VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+						0,
+						0,
+						nullptr,
+						0,
+						nullptr,
+						1,
+						&barrier
+					);
+
+					// Handes cases where image is not squared. Make sure neither width nor height is zero
+					if ( mipWidth > 1 ) mipWidth /= 2;
+					if ( mipHeight > 1 ) mipHeight /= 2;
+				}
+
+				// Transition last mip level
+				barrier.subresourceRange.baseMipLevel = mipLevels - 1;
+				barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+				barrier.newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+				barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+				barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+
+				vkCmdPipelineBarrier(
+					commandBuffer,
+					VK_PIPELINE_STAGE_TRANSFER_BIT,
+					VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+					0,
+					0,
+					nullptr,
+					0,
+					nullptr,
+					1,
+					&barrier
+				);
+
+				endSingleTimeCommands( commandBuffer );
+			}
+
+			void transitionImageLayout(
+				VkImage image,
+				VkFormat format,
+				VkImageLayout oldLayout,
+				VkImageLayout newLayout,
+				uint32_t mipLevels )
+			{
+				auto commandBuffer = beginSingleTimeCommands();
+
+				auto barrier = VkImageMemoryBarrier {
+					.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
+					.oldLayout = oldLayout,
+					.newLayout = newLayout,
+					// we don't want to transfer queue family ownership
+					.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+					.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+					.image = image,
+					.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
+					.subresourceRange.baseMipLevel = 0,
+					.subresourceRange.levelCount = mipLevels,
+					.subresourceRange.baseArrayLayer = 0,
+					.subresourceRange.layerCount = 1,
+					.srcAccessMask = 0, // TODO
+					.dstAccessMask = 0, // TODO
+				};
+
+				// Transition barrier masks
+				VkPipelineStageFlags sourceStage;
+				VkPipelineStageFlags destinationStage;
+
+				if ( newLayout == VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL ) {
+					barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_DEPTH_BIT;
+					if ( hasStencilComponent( format ) ) {
+						barrier.subresourceRange.aspectMask |= VK_IMAGE_ASPECT_STENCIL_BIT;
+					}
+				}
+
+				if ( oldLayout == VK_IMAGE_LAYOUT_UNDEFINED && newLayout == VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL ) {
+					barrier.srcAccessMask = 0;
+					barrier.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+					sourceStage = VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT;
+					destinationStage = VK_PIPELINE_STAGE_TRANSFER_BIT;
+				}
+				else if ( oldLayout == VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL && newLayout == VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL ) {
+					barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+					barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+					sourceStage = VK_PIPELINE_STAGE_TRANSFER_BIT;
+					destinationStage = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
+				}
+				else if ( oldLayout == VK_IMAGE_LAYOUT_UNDEFINED && newLayout == VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL ) {
+					barrier.srcAccessMask = 0;
+					barrier.dstAccessMask = VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+					sourceStage = VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT;
+					destinationStage = VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT;
+				}
+				else if ( oldLayout == VK_IMAGE_LAYOUT_UNDEFINED && newLayout == VK_IMAGE_LAYOUT_GENERAL ) {
+					barrier.srcAccessMask = 0;
+					barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+					sourceStage = VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT;
+					destinationStage = VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT;
+				}
+				else if ( oldLayout == VK_IMAGE_LAYOUT_UNDEFINED && newLayout == VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL ) {
+					barrier.srcAccessMask = 0;
+					barrier.dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_READ_BIT | VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+					sourceStage = VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT;
+					destinationStage = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+				}
+				else {
+					throw std::invalid_argument( "Unsupported layout transition" );
+				}
+
+				vkCmdPipelineBarrier(
+					commandBuffer,
+					sourceStage,
+					destinationStage,
+					0,
+					0,
+					nullptr,
+					0,
+					nullptr,
+					1,
+					&barrier
+				);
+
+				endSingleTimeCommands( commandBuffer );
+			}
+
+			void copyBufferToImage( VkBuffer buffer, VkImage image, uint32_t width, uint32_t height )
+			{
+				auto commandBuffer = beginSingleTimeCommands();
+
+				auto region = VkBufferImageCopy {
+					.bufferOffset = 0,
+					.bufferRowLength = 0,
+					.bufferImageHeight = 0,
+					.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
+					.imageSubresource.mipLevel = 0,
+					.imageSubresource.baseArrayLayer = 0,
+					.imageSubresource.layerCount = 1,
+					.imageOffset = { 0, 0, 0 },
+					.imageExtent = { width, height, 1 },
+				};
+
+				vkCmdCopyBufferToImage(
+					commandBuffer,
+					buffer,
+					image,
+					// Assume image has already been transitioned to an optimal layout for copying pixels
+					VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+					1,
+					&region
+				);
+
+				endSingleTimeCommands( commandBuffer );
+			}
+
+			void createTextureImageView( void )
+			{
+				if ( m_textureImage == VK_NULL_HANDLE ) {
+					// Streaming textures own their views
+					return;
+				}
+
+				m_textureImageView = createImageView(
+					m_textureImage,
+					m_textureFormat,
+					VK_IMAGE_ASPECT_COLOR_BIT,
+					m_mipLevels,
+					m_textureLayerCount
+				);
+			}
+
+			void createTextureSampler( void )
+			{
+				// Default sampler state. The image view limits available mip levels
+				m_textureSampler = getSampler( SamplerDescriptor { } );
+			}
+
+		private:
+			uint32_t m_mipLevels;
+			uint32_t m_textureLayerCount = 1;
+			VkFormat m_textureFormat = VK_FORMAT_R8G8B8A8_UNORM;
+			VkImage m_textureImage = VK_NULL_HANDLE;
+			VkDeviceMemory m_textureImageMemory = VK_NULL_HANDLE;
+			VkImageView m_textureImageView = VK_NULL_HANDLE;
+			VkSampler m_textureSampler;
+
+			//@}
+
+			/**
+			   \name Texture streaming
+
+			   Baked textures start with only their mip tail resident (levels no larger
+			   than TEXTURE_STREAMING_TAIL_EXTENT) and stream in one more detailed level
+			   per frame while they are visible. When the resident set would exceed the
+			   budget, the top mips of the least recently seen textures are evicted.
+
+			   Each texture's image only holds its resident levels, so the image view
+			   itself acts as the LOD clamp: sampling never reaches a missing level and
+			   no per-texture sampler is needed. Changing residency reallocates the image,
+			   copies the surviving levels on the GPU and uploads new ones straight from
+			   the mapped container.
+
+			   All residency changes for a frame are recorded into a single command
+			   buffer and submitted together, without waiting. Textures keep using
+			   their previous image until the GPU timeline reaches that submission.
+			   Only then are views and descriptors swapped, and the previous image
+			   is destroyed once frames still sampling it are done.
+
+			   The budget is enforced against the memory requirements reported by
+			   the driver for each resident level range.
+			 */
+			//@{
+
+		private:
+			struct StreamingTexture {
+				std::string filename;
+				std::unique_ptr< TextureContainer > container;
+				VkFormat format;
+				uint32_t width;
+				uint32_t height;
+				uint32_t layerCount;
+				uint32_t levelCount;
+
+				/**
+				   Most detailed level currently resident. Levels [ residentLevel, levelCount )
+				   are available in the image
+				 */
+				uint32_t residentLevel;
+
+				/**
+				   Most detailed level that can never be evicted
+				 */
+				uint32_t tailLevel;
+
+				/**
+				   Level that should be resident once this frame's changes are applied
+				 */
+				uint32_t targetLevel;
+
+				/**
+				   Slot in the bindless texture array, if registered
+				 */
+				crimild::UInt32 bindlessIndex = NO_BINDLESS_INDEX;
+
+				/**
+				   Memory required to keep levels [ firstLevel, levelCount ) resident,
+				   indexed by firstLevel
+				 */
+				std::vector< VkDeviceSize > residentSizes;
+
+				/**
+				   Timeline value of the submission changing residency, or zero if none is in flight
+				 */
+				crimild::UInt64 residencyTimelineValue = 0;
+
+				VkImage image = VK_NULL_HANDLE;
+				VkDeviceMemory memory = VK_NULL_HANDLE;
+				VkImageView imageView = VK_NULL_HANDLE;
+				VkDeviceSize residentBytes = 0;
+
+				crimild::UInt64 lastSeenFrame = 0;
+				crimild::Bool pendingRequest = false;
+				std::chrono::high_resolution_clock::time_point requestTime;
+			};
+
+			/**
+			   \brief A residency change recorded but not applied yet
+			 */
+			struct ResidencyChange {
+				StreamingTexture *texture;
+				uint32_t firstLevel;
+				VkImage image;
+				VkDeviceMemory memory;
+				VkDeviceSize size;
+				VkBuffer stagingBuffer = VK_NULL_HANDLE;
+				VkDeviceMemory stagingBufferMemory = VK_NULL_HANDLE;
+			};
+
+			/**
+			   \brief Residency changes submitted together
+			 */
+			struct ResidencyBatch {
+				crimild::UInt64 timelineValue;
+				VkCommandBuffer commandBuffer;
+				std::vector< ResidencyChange > changes;
+			};
+
+			struct TextureStreamingStats {
+				VkDeviceSize residentBytes = 0;
+				VkDeviceSize peakResidentBytes = 0;
+				crimild::UInt32 levelsStreamedIn = 0;
+				crimild::UInt32 levelsEvicted = 0;
+				crimild::Real64 totalLatency = 0.0;
+				crimild::Real64 maxLatency = 0.0;
+			};
+
+			std::unique_ptr< StreamingTexture > createStreamingTexture( const std::string &filename )
+			{
+				auto texture = std::make_unique< StreamingTexture >();
+				texture->filename = filename;
+				texture->container = std::make_unique< TextureContainer >();
+
+				try {
+					texture->container->open( filename );
+				}
+				catch ( const std::exception &e ) {
+					throw RuntimeException( e.what() );
+				}
+
+				const auto &header = texture->container->getHeader();
+				if ( header.layerCount != 1 ) {
+					// Views would be 2D arrays, but shaders only sample sampler2D
+					throw RuntimeException( "Texture arrays are not supported: " + filename + " has " + std::to_string( header.layerCount ) + " layers" );
+				}
+
+				texture->format = static_cast< VkFormat >( header.vkFormat );
+				texture->width = header.pixelWidth;
+				texture->height = header.pixelHeight;
+				texture->layerCount = header.layerCount;
+				texture->levelCount = header.levelCount;
+
+				texture->tailLevel = 0;
+				while ( texture->tailLevel + 1 < texture->levelCount
+						&& std::max(
+							TextureContainer::getLevelExtent( texture->width, texture->tailLevel ),
+							TextureContainer::getLevelExtent( texture->height, texture->tailLevel ) ) > TEXTURE_STREAMING_TAIL_EXTENT ) {
+					++texture->tailLevel;
+				}
+
+				computeResidentSizes( *texture );
+
+				// The tail must be available before the texture is first bound
+				texture->residentLevel = texture->levelCount;
+				texture->targetLevel = texture->tailLevel;
+				submitTextureResidency( { texture.get() } );
+				completeTextureResidency( true );
+
+				return texture;
+			}
+
+			void destroyStreamingTexture( StreamingTexture &texture )
+			{
+				if ( texture.image != VK_NULL_HANDLE ) {
+					deferDestroy( texture.imageView );
+					deferDestroy( texture.image );
+					deferDestroy( texture.memory );
+				}
+				m_textureStreamingStats.residentBytes -= texture.residentBytes;
+				texture.imageView = VK_NULL_HANDLE;
+				texture.image = VK_NULL_HANDLE;
+				texture.memory = VK_NULL_HANDLE;
+				texture.residentBytes = 0;
+			}
+
+			/**
+			   \brief Size of the allocation needed to keep levels [ firstLevel, levelCount ) resident
+			 */
+			VkDeviceSize computeResidentSize( const StreamingTexture &texture, uint32_t firstLevel ) const
+			{
+				return texture.residentSizes[ firstLevel ];
+			}
+
+			/**
+			   \brief Queries the driver for the memory required by every possible resident range
+
+			   Alignment and padding make these larger than the texel data, so the
+			   budget is planned with the same sizes that are later allocated.
+			 */
+			void computeResidentSizes( StreamingTexture &texture )
+			{
+				texture.residentSizes.assign( texture.levelCount + 1, 0 );
+				for ( uint32_t firstLevel = 0; firstLevel < texture.levelCount; ++firstLevel ) {
+					auto imageInfo = makeStreamingImageInfo( texture, firstLevel );
+
+					VkImage image;
+					if ( vkCreateImage( m_device, &imageInfo, nullptr, &image ) != VK_SUCCESS ) {
+						throw RuntimeException( "Failed to create image" );
+					}
+
+					VkMemoryRequirements memRequirements;
+					vkGetImageMemoryRequirements( m_device, image, &memRequirements );
+					vkDestroyImage( m_device, image, nullptr );
+
+					texture.residentSizes[ firstLevel ] = memRequirements.size;
+				}
+			}
+
+			VkImageCreateInfo makeStreamingImageInfo( const StreamingTexture &texture, uint32_t firstLevel ) const
+			{
+				return VkImageCreateInfo {
+					.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO,
+					.imageType = VK_IMAGE_TYPE_2D,
+					.extent.width = TextureContainer::getLevelExtent( texture.width, firstLevel ),
+					.extent.height = TextureContainer::getLevelExtent( texture.height, firstLevel ),
+					.extent.depth = 1,
+					.mipLevels = texture.levelCount - firstLevel,
+					.arrayLayers = texture.layerCount,
+					.format = texture.format,
+					.tiling = VK_IMAGE_TILING_OPTIMAL,
+					.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED,
+					.usage = VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT,
+					.sharingMode = VK_SHARING_MODE_EXCLUSIVE,
+					.samples = VK_SAMPLE_COUNT_1_BIT,
+					.flags = 0,
+				};
+			}
+
+			/**
+			   \brief Submits commands making every texture's target level resident, without waiting
+
+			   Textures with a change already in flight are left alone. New images
+			   count towards the resident size from now on, while previous ones keep
+			   counting until they are released.
+			 */
+			void submitTextureResidency( const std::vector< StreamingTexture * > &textures )
+			{
+				ResidencyBatch batch;
+				batch.commandBuffer = VK_NULL_HANDLE;
+
+				for ( auto texture : textures ) {
+					if ( texture->targetLevel == texture->residentLevel || texture->residencyTimelineValue != 0 ) {
+						continue;
+					}
+
+					if ( batch.commandBuffer == VK_NULL_HANDLE ) {
+						batch.commandBuffer = beginSingleTimeCommands();
+					}
+
+					batch.changes.push_back( recordTextureResidency( batch.commandBuffer, *texture, texture->targetLevel ) );
+				}
+
+				if ( batch.changes.empty() ) {
+					return;
+				}
+
+				batch.timelineValue = submitSingleTimeCommands( batch.commandBuffer );
+
+				for ( const auto &change : batch.changes ) {
+					change.texture->residencyTimelineValue = batch.timelineValue;
+					m_textureStreamingStats.residentBytes += change.size;
+				}
+				m_textureStreamingStats.peakResidentBytes = std::max( m_textureStreamingStats.peakResidentBytes, m_textureStreamingStats.residentBytes );
+
+				m_residencyBatches.push_back( std::move( batch ) );
+			}
+
+			/**
+			   \brief Swaps in the images of every residency batch the GPU is done with
+
+			   Previous images are destroyed once frames that might still be sampling
+			   them are complete. When wait is true, blocks until every batch is done.
+			   \return Textures whose view changed, so their descriptors can be updated
+			 */
+			std::vector< StreamingTexture * > completeTextureResidency( crimild::Bool wait = false )
+			{
+				if ( m_residencyBatches.empty() ) {
+					return { };
+				}
+
+				if ( wait ) {
+					waitForTimelineValue( m_residencyBatches.back().timelineValue );
+				}
+
+				auto now = std::chrono::high_resolution_clock::now();
+				auto completed = getCompletedTimelineValue();
+
+				std::vector< StreamingTexture * > changed;
+				while ( !m_residencyBatches.empty() && m_residencyBatches.front().timelineValue <= completed ) {
+					auto &batch = m_residencyBatches.front();
+					vkFreeCommandBuffers( m_device, m_commandPool, 1, &batch.commandBuffer );
+
+					for ( const auto &change : batch.changes ) {
+						auto &texture = *change.texture;
+						const auto oldLevel = texture.residentLevel;
+						const auto firstLevel = change.firstLevel;
+
+						if ( change.stagingBuffer != VK_NULL_HANDLE ) {
+							deferDestroy( change.stagingBuffer );
+							deferDestroy( change.stagingBufferMemory );
+						}
+
+						// Cached sets pointing to the previous view must not be reused
+						forgetDescriptorSets( texture.imageView );
+						destroyStreamingTexture( texture );
+
+						// Already counted towards the resident size when submitted
+						texture.image = change.image;
+						texture.memory = change.memory;
+						texture.imageView = createImageView( change.image, texture.format, VK_IMAGE_ASPECT_COLOR_BIT, texture.levelCount - firstLevel, texture.layerCount );
+						texture.residentBytes = change.size;
+						texture.residentLevel = firstLevel;
+						texture.residencyTimelineValue = 0;
+
+						if ( firstLevel < oldLevel && oldLevel < texture.levelCount ) {
+							m_textureStreamingStats.levelsStreamedIn += oldLevel - firstLevel;
+						}
+						else if ( firstLevel > oldLevel ) {
+							m_textureStreamingStats.levelsEvicted += firstLevel - oldLevel;
+						}
+
+						if ( texture.pendingRequest && firstLevel < oldLevel ) {
+							auto latency = std::chrono::duration< crimild::Real64, std::milli >( now - texture.requestTime ).count();
+							m_textureStreamingStats.totalLatency += latency;
+							m_textureStreamingStats.maxLatency = std::max( m_textureStreamingStats.maxLatency, latency );
+							texture.pendingRequest = false;
+						}
+
+						changed.push_back( &texture );
+					}
+
+					m_residencyBatches.pop_front();
+				}
+
+				return changed;
+			}
+
+			/**
+			   \brief Records the commands reallocating a texture so levels [ firstLevel, levelCount ) are resident
+
+			   Levels that are already resident are copied from the previous image.
+			   Missing levels are uploaded from the container with a single buffer
+			   to image copy, since consecutive levels are contiguous in the file.
+			   The texture itself is not modified until the commands complete, and
+			   its current image is left ready for sampling, since frames submitted
+			   before then keep using it.
+			 */
+			ResidencyChange recordTextureResidency( VkCommandBuffer commandBuffer, StreamingTexture &texture, uint32_t firstLevel )
+			{
+				const auto oldLevel = texture.residentLevel;
+				const auto newLevelCount = texture.levelCount - firstLevel;
+
+				VkImage image;
+				VkDeviceMemory memory;
+				createImage(
+					TextureContainer::getLevelExtent( texture.width, firstLevel ),
+					TextureContainer::getLevelExtent( texture.height, firstLevel ),
+					newLevelCount,
+					VK_SAMPLE_COUNT_1_BIT,
+					texture.format,
+					VK_IMAGE_TILING_OPTIMAL,
+					VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT,
+					VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+					image,
+					memory,
+					texture.layerCount
+				);
+
+				VkMemoryRequirements memRequirements;
+				vkGetImageMemoryRequirements( m_device, image, &memRequirements );
+
+				// Stage levels that are not resident yet (if any)
+				VkBuffer stagingBuffer = VK_NULL_HANDLE;
+				VkDeviceMemory stagingBufferMemory = VK_NULL_HANDLE;
+				std::vector< VkBufferImageCopy > uploads;
+				if ( firstLevel < oldLevel ) {
+					VkDeviceSize dataOffset;
+					VkDeviceSize dataSize;
+					texture.container->getLevelRange( firstLevel, oldLevel, dataOffset, dataSize );
+
+					createBuffer(
+						dataSize,
+						VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+						VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+						stagingBuffer,
+						stagingBufferMemory
+					);
+
+					void *data;
+					vkMapMemory( m_device, stagingBufferMemory, 0, dataSize, 0, &data );
+					memcpy( data, texture.container->getData() + dataOffset, static_cast< size_t >( dataSize ) );
+					vkUnmapMemory( m_device, stagingBufferMemory );
+
+					for ( auto level = firstLevel; level < oldLevel; ++level ) {
+						uploads.push_back(
+							VkBufferImageCopy {
+								.bufferOffset = texture.container->getLevelIndex( level ).byteOffset - dataOffset,
+								.bufferRowLength = 0,
+								.bufferImageHeight = 0,
+								.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
+								.imageSubresource.mipLevel = level - firstLevel,
+								.imageSubresource.baseArrayLayer = 0,
+								.imageSubresource.layerCount = texture.layerCount,
+								.imageOffset = { 0, 0, 0 },
+								.imageExtent = {
+									TextureContainer::getLevelExtent( texture.width, level ),
+									TextureContainer::getLevelExtent( texture.height, level ),
+									1
+								},
+							}
+						);
+					}
+				}
+
+				// Levels that survive from the previous image
+				std::vector< VkImageCopy > copies;
+				if ( texture.image != VK_NULL_HANDLE ) {
+					for ( auto level = std::max( firstLevel, oldLevel ); level < texture.levelCount; ++level ) {
+						copies.push_back(
+							VkImageCopy {
+								.srcSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
+								.srcSubresource.mipLevel = level - oldLevel,
+								.srcSubresource.baseArrayLayer = 0,
+								.srcSubresource.layerCount = texture.layerCount,
+								.srcOffset = { 0, 0, 0 },
+								.dstSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
+								.dstSubresource.mipLevel = level - firstLevel,
+								.dstSubresource.baseArrayLayer = 0,
+								.dstSubresource.layerCount = texture.layerCount,
+								.dstOffset = { 0, 0, 0 },
+								.extent = {
+									TextureContainer::getLevelExtent( texture.width, level ),
+									TextureContainer::getLevelExtent( texture.height, level ),
+									1
+								},
+							}
+						);
+					}
+				}
+
+				std::vector< VkImageMemoryBarrier > barriers = {
+					VkImageMemoryBarrier {
+						.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
+						.oldLayout = VK_IMAGE_LAYOUT_UNDEFINED,
+						.newLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+						.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+						.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+						.image = image,
+						.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
+						.subresourceRange.baseMipLevel = 0,
+						.subresourceRange.levelCount = newLevelCount,
+						.subresourceRange.baseArrayLayer = 0,
+						.subresourceRange.layerCount = texture.layerCount,
+						.srcAccessMask = 0,
+						.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT,
+					},
+				};
+
+				if ( !copies.empty() ) {
+					barriers.push_back(
+						VkImageMemoryBarrier {
+							.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
+							.oldLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+							.newLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+							.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+							.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+							.image = texture.image,
+							.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
+							.subresourceRange.baseMipLevel = 0,
+							.subresourceRange.levelCount = texture.levelCount - oldLevel,
+							.subresourceRange.baseArrayLayer = 0,
+							.subresourceRange.layerCount = texture.layerCount,
+							.srcAccessMask = VK_ACCESS_SHADER_READ_BIT,
+							.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT,
+						}
+					);
+				}
+
+				vkCmdPipelineBarrier(
+					commandBuffer,
+					VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT | VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+					VK_PIPELINE_STAGE_TRANSFER_BIT,
+					0,
+					0,
+					nullptr,
+					0,
+					nullptr,
+					static_cast< uint32_t >( barriers.size() ),
+					barriers.data()
+				);
+
+				if ( !copies.empty() ) {
+					vkCmdCopyImage(
+						commandBuffer,
+						texture.image,
+						VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+						image,
+						VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+						static_cast< uint32_t >( copies.size() ),
+						copies.data()
+					);
+				}
+
+				if ( !uploads.empty() ) {
+					vkCmdCopyBufferToImage(
+						commandBuffer,
+						stagingBuffer,
+						image,
+						VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+						static_cast< uint32_t >( uploads.size() ),
+						uploads.data()
+					);
+				}
+
+				// Both images end up ready for sampling
+				for ( auto &barrier : barriers ) {
+					barrier.oldLayout = barrier.newLayout;
+					barrier.newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+					barrier.srcAccessMask = barrier.dstAccessMask;
+					barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+				}
+
+				vkCmdPipelineBarrier(
+					commandBuffer,
+					VK_PIPELINE_STAGE_TRANSFER_BIT,
+					VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+					0,
+					0,
+					nullptr,
+					0,
+					nullptr,
+					static_cast< uint32_t >( barriers.size() ),
+					barriers.data()
+				);
+
+				return ResidencyChange {
+					.texture = &texture,
+					.firstLevel = firstLevel,
+					.image = image,
+					.memory = memory,
+					.size = memRequirements.size,
+					.stagingBuffer = stagingBuffer,
+					.stagingBufferMemory = stagingBufferMemory,
+				};
+			}
+
+			void configureTextureStreaming( void )
+			{
+				if ( auto budget = std::getenv( "CRIMILD_TEXTURE_STREAMING_BUDGET_MB" ) ) {
+					m_textureStreamingBudget = VkDeviceSize( std::max( 1, std::atoi( budget ) ) ) * 1024 * 1024;
+				}
+
+				CRIMILD_LOG_DEBUG( "Texture streaming budget: ", m_textureStreamingBudget, " bytes" );
+			}
+
+			void markTextureSeen( StreamingTexture &texture )
+			{
+				texture.lastSeenFrame = m_frameCounter;
+			}
+
+			/**
+			   \brief Streams in one more level for each visible texture, evicting if needed
+
+			   Called once per frame, after the draw list is built (which marks the
+			   textures it uses as seen) and before the frame is recorded. Changes
+			   the GPU finished are applied first. Then, levels to stream in and evict
+			   are decided and submitted together, skipping textures that are still
+			   waiting for a previous change.
+			 */
+			void updateTextureStreaming( void )
+			{
+				auto changed = completeTextureResidency();
+				if ( !changed.empty() ) {
+					refreshTextureBindings( changed );
+
+					const auto &stats = m_textureStreamingStats;
+					CRIMILD_LOG_DEBUG(
+						"Texture streaming: ",
+						stats.residentBytes, " resident bytes (peak ", stats.peakResidentBytes, ", budget ", m_textureStreamingBudget, "), ",
+						stats.levelsStreamedIn, " levels streamed in, ",
+						stats.levelsEvicted, " evicted, ",
+						"latency avg ", stats.levelsStreamedIn > 0 ? stats.totalLatency / stats.levelsStreamedIn : 0.0, "ms ",
+						"max ", stats.maxLatency, "ms"
+					);
+				}
+
+				auto now = std::chrono::high_resolution_clock::now();
+
+				// Memory to be resident, as planned so far. Images replaced by changes
+				// in flight still count, so this errs on the side of the budget
+				auto plannedBytes = m_textureStreamingStats.residentBytes;
+
+				std::vector< StreamingTexture * > textures;
+				for ( auto &texture : m_streamingTextures ) {
+					if ( texture->residencyTimelineValue == 0 ) {
+						texture->targetLevel = texture->residentLevel;
+						textures.push_back( texture.get() );
+					}
+				}
+
+				for ( auto texture : textures ) {
+					if ( texture->lastSeenFrame != m_frameCounter || texture->residentLevel == 0 ) {
+						continue;
+					}
+
+					if ( !texture->pendingRequest ) {
+						texture->pendingRequest = true;
+						texture->requestTime = now;
+					}
+
+					auto nextLevel = texture->targetLevel - 1;
+					auto required = computeResidentSize( *texture, nextLevel ) - computeResidentSize( *texture, texture->targetLevel );
+					if ( !evictTextureLevels( required, plannedBytes ) ) {
+						// Over budget and nothing else to evict. Keep current residency
+						continue;
+					}
+
+					texture->targetLevel = nextLevel;
+					plannedBytes += required;
+				}
+
+				submitTextureResidency( textures );
+			}
+
+			/**
+			   \brief Plans evicting top mips from the least recently seen textures until there's room for the given size
+
+			   Textures seen in the current frame are never evicted, nor are mip tails
+			   or textures with a change in flight. Evictions only lower target levels,
+			   to be applied with the rest of the frame's changes.
+			   \return true if the requested size fits in the budget
+			 */
+			crimild::Bool evictTextureLevels( VkDeviceSize required, VkDeviceSize &plannedBytes )
+			{
+				while ( plannedBytes + required > m_textureStreamingBudget ) {
+					StreamingTexture *victim = nullptr;
+					for ( auto &texture : m_streamingTextures ) {
+						if ( texture->lastSeenFrame == m_frameCounter || texture->targetLevel >= texture->tailLevel || texture->residencyTimelineValue != 0 ) {
+							continue;
+						}
+						if ( victim == nullptr || texture->lastSeenFrame < victim->lastSeenFrame ) {
+							victim = texture.get();
+						}
+					}
+
+					if ( victim == nullptr ) {
+						return false;
+					}
+
+					auto released = computeResidentSize( *victim, victim->targetLevel ) - computeResidentSize( *victim, victim->targetLevel + 1 );
+					plannedBytes -= std::min( plannedBytes, released );
+					++victim->targetLevel;
+				}
+
+				return true;
+			}
+
+			VkImageView getTextureImageView( void ) const
+			{
+				return m_streamingTextures.empty() ? m_textureImageView : m_streamingTextures.front()->imageView;
+			}
+
+			/**
+			   \brief Points descriptors to the current views of the given textures
+
+			   Previous views are kept alive until frames in flight are done with them.
+			 */
+			void refreshTextureBindings( const std::vector< StreamingTexture * > &textures )
+			{
+				if ( m_bindlessEnabled ) {
+					// Update-after-bind descriptors can be written without re-recording
+					for ( auto texture : textures ) {
+						if ( texture->bindlessIndex != NO_BINDLESS_INDEX ) {
+							updateBindlessTexture( texture->bindlessIndex, texture->imageView, m_textureSampler );
+						}
+					}
+					return;
+				}
+
+				if ( std::find( textures.begin(), textures.end(), m_streamingTextures.front().get() ) == textures.end() ) {
+					// Only the main texture is bound to the persistent sets
+					return;
+				}
+
+				// Sets for the previous view were forgotten when it was replaced, so this
+				// allocates new ones. Frames in flight keep using the old sets, and
+				// command buffers are recorded every frame, so they pick up the new ones
+				createDescriptorSets();
+			}
+
+		private:
+			std::vector< std::unique_ptr< StreamingTexture >> m_streamingTextures;
+			std::deque< ResidencyBatch > m_residencyBatches;
+			VkDeviceSize m_textureStreamingBudget = TEXTURE_STREAMING_BUDGET;
+			TextureStreamingStats m_textureStreamingStats;
+
+			//@}
+
+			/**
+			   \name Samplers
+			 */
+			//@{
+
+		private:
+			/**
+			   \brief Returns a sampler matching the given state, creating it if needed
+
+			   Samplers are shared by every texture using the same state and live
+			   until cleanup, so callers must not destroy them.
+			 */
+			VkSampler getSampler( const SamplerDescriptor &descriptor )
+			{
+				auto it = m_samplerCache.find( descriptor );
+				if ( it != m_samplerCache.end() ) {
+					++m_samplerCacheHits;
+					return it->second;
+				}
+
+				++m_samplerCacheMisses;
+
+				VkPhysicalDeviceProperties properties;
+				vkGetPhysicalDeviceProperties( m_physicalDevice, &properties );
+
+				auto samplerInfo = VkSamplerCreateInfo {
+					.sType = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO,
+					.magFilter = descriptor.magFilter,
+					.minFilter = descriptor.minFilter,
+					.addressModeU = descriptor.addressModeU,
+					.addressModeV = descriptor.addressModeV,
+					.addressModeW = descriptor.addressModeW,
+					.anisotropyEnable = descriptor.maxAnisotropy > 1.0f ? VK_TRUE : VK_FALSE,
+					.maxAnisotropy = std::min( descriptor.maxAnisotropy, properties.limits.maxSamplerAnisotropy ),
+					.borderColor = descriptor.borderColor,
+					.unnormalizedCoordinates = VK_FALSE,
+					.compareEnable = descriptor.compareEnable,
+					.compareOp = descriptor.compareOp,
+					.mipmapMode = descriptor.mipmapMode,
+					.mipLodBias = descriptor.mipLodBias,
+					.minLod = descriptor.minLod,
+					.maxLod = descriptor.maxLod,
+				};
+
+				VkSampler sampler;
+				if ( vkCreateSampler( m_device, &samplerInfo, nullptr, &sampler ) != VK_SUCCESS ) {
+					throw RuntimeException( "Failed to create texture sampler" );
+				}
+
+				m_samplerCache[ descriptor ] = sampler;
+
+				CRIMILD_LOG_DEBUG( "Sampler created (", m_samplerCache.size(), " cached, max ", properties.limits.maxSamplerAllocationCount, ")" );
+
+				return sampler;
+			}
+
+			void cleanupSamplers( void )
+			{
+				auto requests = m_samplerCacheHits + m_samplerCacheMisses;
+				CRIMILD_LOG_DEBUG(
+					"Sampler cache: ",
+					m_samplerCache.size(), " samplers, ",
+					m_samplerCacheHits, " hits, ",
+					m_samplerCacheMisses, " misses (",
+					requests > 0 ? 100.0 * m_samplerCacheHits / requests : 0.0, "% hit rate)"
+				);
+
+				for ( auto &it : m_samplerCache ) {
+					vkDestroySampler( m_device, it.second, nullptr );
+				}
+				m_samplerCache.clear();
+			}
+
+		private:
+			std::unordered_map< SamplerDescriptor, VkSampler > m_samplerCache;
+			crimild::UInt32 m_samplerCacheHits = 0;
+			crimild::UInt32 m_samplerCacheMisses = 0;
+
+			//@}
+
+			/**
+			   \name Bindless resources
+
+			   When descriptor indexing is available, every texture lives in a single,
+			   partially bound array and material parameters live in a storage buffer.
+			   Both are bound once (set 1) and shaders index them using the material
+			   index passed in the draw push constants, so draws no longer need their own
+			   descriptor sets and can be batched together.
+
+			   Devices without descriptor indexing use one combined image sampler
+			   binding per material instead.
+			 */
+			//@{
+
+		private:
+			/**
+			   \brief Check if a device supports the descriptor indexing features required for bindless
+			 */
+			crimild::Bool checkBindlessSupport( VkPhysicalDevice device ) const
+			{
+				if ( !m_physicalDeviceProperties2Enabled ) {
+					return false;
+				}
+
+				// Bindless shaders are only available if glslc could build them
+				if ( !hasShader( "assets/shaders/unlit_texture_bindless.vert.spv" )
+					 || !hasShader( "assets/shaders/unlit_texture_bindless.frag.spv" ) ) {
+					CRIMILD_LOG_DEBUG( "Bindless disabled: shaders not found" );
+					return false;
+				}
+
+				crimild::UInt32 extensionCount;
+				vkEnumerateDeviceExtensionProperties( device, nullptr, &extensionCount, nullptr );
+				std::vector< VkExtensionProperties > availableExtensions( extensionCount );
+				vkEnumerateDeviceExtensionProperties( device, nullptr, &extensionCount, availableExtensions.data() );
+
+				std::set< std::string > requiredExtensions( std::begin( m_bindlessDeviceExtensions ), std::end( m_bindlessDeviceExtensions ) );
+				for ( const auto &extension : availableExtensions ) {
+					requiredExtensions.erase( extension.extensionName );
+				}
+				if ( !requiredExtensions.empty() ) {
+					CRIMILD_LOG_DEBUG( "Bindless disabled: descriptor indexing extensions not available" );
+					return false;
+				}
+
+				auto getFeatures2 = ( PFN_vkGetPhysicalDeviceFeatures2KHR ) vkGetInstanceProcAddr( _instance, "vkGetPhysicalDeviceFeatures2KHR" );
+				if ( getFeatures2 == nullptr ) {
+					return false;
+				}
+
+				auto indexingFeatures = VkPhysicalDeviceDescriptorIndexingFeaturesEXT {
+					.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_INDEXING_FEATURES_EXT,
+				};
+
+				auto features = VkPhysicalDeviceFeatures2KHR {
+					.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2_KHR,
+					.pNext = &indexingFeatures,
+				};
+
+				getFeatures2( device, &features );
+
+				auto supported = indexingFeatures.shaderSampledImageArrayNonUniformIndexing
+					&& indexingFeatures.descriptorBindingSampledImageUpdateAfterBind
+					&& indexingFeatures.descriptorBindingPartiallyBound
+					&& indexingFeatures.runtimeDescriptorArray;
+
+				CRIMILD_LOG_DEBUG( "Bindless ", supported ? "enabled" : "disabled: missing descriptor indexing features" );
+
+				return supported;
+			}
+
+			/**
+			   \brief Number of textures in the bindless array, clamped to device limits
+			 */
+			crimild::UInt32 computeBindlessTextureCount( void ) const
+			{
+				auto getProperties2 = ( PFN_vkGetPhysicalDeviceProperties2KHR ) vkGetInstanceProcAddr( _instance, "vkGetPhysicalDeviceProperties2KHR" );
+
+				auto indexingProperties = VkPhysicalDeviceDescriptorIndexingPropertiesEXT {
+					.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_INDEXING_PROPERTIES_EXT,
+				};
+
+				auto properties = VkPhysicalDeviceProperties2KHR {
+					.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2_KHR,
+					.pNext = &indexingProperties,
+				};
+
+				getProperties2( m_physicalDevice, &properties );
+
+				return std::min(
+					BINDLESS_MAX_TEXTURES,
+					std::min(
+						indexingProperties.maxDescriptorSetUpdateAfterBindSampledImages,
+						indexingProperties.maxPerStageDescriptorUpdateAfterBindSamplers
+					)
+				);
+			}
+
+			void createBindlessSetLayout( void )
+			{
+				m_bindlessTextureCount = computeBindlessTextureCount();
+
+				auto bindings = std::array< VkDescriptorSetLayoutBinding, 2 > {
+					VkDescriptorSetLayoutBinding {
+						.binding = 0,
+						.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+						.descriptorCount = 1,
+						.stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT,
+						.pImmutableSamplers = nullptr,
+					},
+					VkDescriptorSetLayoutBinding {
+						.binding = 1,
+						.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,
+						.descriptorCount = m_bindlessTextureCount,
+						.stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT,
+						.pImmutableSamplers = nullptr,
+					},
+				};
+
+				auto bindingFlags = std::array< VkDescriptorBindingFlagsEXT, 2 > {
+					0,
+					VK_DESCRIPTOR_BINDING_PARTIALLY_BOUND_BIT_EXT | VK_DESCRIPTOR_BINDING_UPDATE_AFTER_BIND_BIT_EXT,
+				};
+
+				auto bindingFlagsInfo = VkDescriptorSetLayoutBindingFlagsCreateInfoEXT {
+					.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_BINDING_FLAGS_CREATE_INFO_EXT,
+					.bindingCount = static_cast< uint32_t >( bindingFlags.size() ),
+					.pBindingFlags = bindingFlags.data(),
+				};
+
+				auto layoutInfo = VkDescriptorSetLayoutCreateInfo {
+					.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO,
+					.pNext = &bindingFlagsInfo,
+					.flags = VK_DESCRIPTOR_SET_LAYOUT_CREATE_UPDATE_AFTER_BIND_POOL_BIT_EXT,
+					.bindingCount = static_cast< uint32_t >( bindings.size() ),
+					.pBindings = bindings.data(),
+				};
+
+				if ( vkCreateDescriptorSetLayout( m_device, &layoutInfo, nullptr, &m_bindlessSetLayout ) != VK_SUCCESS ) {
+					throw RuntimeException( "Failed to create bindless descriptor set layout" );
+				}
+			}
+
+			void createBindlessResources( void )
+			{
+				if ( !m_bindlessEnabled ) {
+					return;
+				}
+
+				std::array< VkDescriptorPoolSize, 2 > poolSizes = {
+					VkDescriptorPoolSize {
+						.type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+						.descriptorCount = 1,
+					},
+					VkDescriptorPoolSize {
+						.type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,
+						.descriptorCount = m_bindlessTextureCount,
+					},
+				};
+
+				auto poolInfo = VkDescriptorPoolCreateInfo {
+					.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO,
+					.flags = VK_DESCRIPTOR_POOL_CREATE_UPDATE_AFTER_BIND_BIT_EXT,
+					.poolSizeCount = static_cast< uint32_t >( poolSizes.size() ),
+					.pPoolSizes = poolSizes.data(),
+					.maxSets = 1,
+				};
+
+				if ( vkCreateDescriptorPool( m_device, &poolInfo, nullptr, &m_bindlessPool ) != VK_SUCCESS ) {
+					throw RuntimeException( "Failed to create bindless descriptor pool" );
+				}
+
+				auto allocInfo = VkDescriptorSetAllocateInfo {
+					.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO,
+					.descriptorPool = m_bindlessPool,
+					.descriptorSetCount = 1,
+					.pSetLayouts = &m_bindlessSetLayout,
+				};
+
+				if ( vkAllocateDescriptorSets( m_device, &allocInfo, &m_bindlessSet ) != VK_SUCCESS ) {
+					throw RuntimeException( "Failed to allocate bindless descriptor set" );
+				}
+
+				createBuffer(
+					sizeof( MaterialRecord ) * BINDLESS_MAX_MATERIALS,
+					VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+					VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+					m_materialBuffer,
+					m_materialBufferMemory
+				);
+
+				writeDescriptorSet(
+					m_bindlessSet,
+					{
+						DescriptorBinding {
+							.binding = 0,
+							.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+							.buffer = m_materialBuffer,
+							.offset = 0,
+							.range = VK_WHOLE_SIZE,
+						},
+					}
+				);
+
+				for ( auto &texture : m_streamingTextures ) {
+					texture->bindlessIndex = registerBindlessTexture( texture->imageView, m_textureSampler );
+				}
+				m_mainTextureIndex = m_streamingTextures.empty()
+					? registerBindlessTexture( m_textureImageView, m_textureSampler )
+					: m_streamingTextures.front()->bindlessIndex;
+				m_mainMaterialIndex = registerMaterial(
+					MaterialRecord {
+						.color = Vector4f( 1.0f, 1.0f, 1.0f, 1.0f ),
+						.albedoTextureIndex = m_mainTextureIndex,
+					}
+				);
+			}
+
+			void cleanupBindlessResources( void )
+			{
+				if ( !m_bindlessEnabled ) {
+					return;
+				}
+
+				vkDestroyBuffer( m_device, m_materialBuffer, nullptr );
+				vkFreeMemory( m_device, m_materialBufferMemory, nullptr );
+				vkDestroyDescriptorPool( m_device, m_bindlessPool, nullptr );
+				vkDestroyDescriptorSetLayout( m_device, m_bindlessSetLayout, nullptr );
+			}
+
+			/**
+			   \brief Adds a texture to the bindless array
+			   \return Index of the texture in the array
+			 */
+			crimild::UInt32 registerBindlessTexture( VkImageView imageView, VkSampler sampler )
+			{
+				if ( m_bindlessTextureUsed >= m_bindlessTextureCount ) {
+					throw RuntimeException( "Too many bindless textures" );
+				}
+
+				auto index = m_bindlessTextureUsed++;
+				updateBindlessTexture( index, imageView, sampler );
+				return index;
+			}
+
+			void updateBindlessTexture( crimild::UInt32 index, VkImageView imageView, VkSampler sampler )
+			{
+				auto imageInfo = VkDescriptorImageInfo {
+					.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+					.imageView = imageView,
+					.sampler = sampler,
+				};
+
+				auto descriptorWrite = VkWriteDescriptorSet {
+					.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
+					.dstSet = m_bindlessSet,
+					.dstBinding = 1,
+					.dstArrayElement = index,
+					.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,
+					.descriptorCount = 1,
+					.pImageInfo = &imageInfo,
+				};
+
+				vkUpdateDescriptorSets( m_device, 1, &descriptorWrite, 0, nullptr );
+			}
+
+			/**
+			   \brief Adds a material record to the material buffer
+			   \return Index of the material, to be pushed as DrawPushConstants::materialIndex
+			 */
+			crimild::UInt32 registerMaterial( const MaterialRecord &material )
+			{
+				if ( m_materialCount >= BINDLESS_MAX_MATERIALS ) {
+					throw RuntimeException( "Too many bindless materials" );
+				}
+
+				auto index = m_materialCount++;
+
+				void *data;
+				vkMapMemory( m_device, m_materialBufferMemory, index * sizeof( MaterialRecord ), sizeof( MaterialRecord ), 0, &data );
+				memcpy( data, &material, sizeof( MaterialRecord ) );
+				vkUnmapMemory( m_device, m_materialBufferMemory );
+
+				return index;
+			}
+
+		private:
+			const std::vector< const char * > m_bindlessDeviceExtensions {
+				VK_KHR_MAINTENANCE3_EXTENSION_NAME,
+				VK_EXT_DESCRIPTOR_INDEXING_EXTENSION_NAME,
+			};
+			crimild::Bool m_bindlessEnabled = false;
+			crimild::UInt32 m_bindlessTextureCount = 0;
+			crimild::UInt32 m_bindlessTextureUsed = 0;
+			VkDescriptorSetLayout m_bindlessSetLayout = VK_NULL_HANDLE;
+			VkDescriptorPool m_bindlessPool = VK_NULL_HANDLE;
+			VkDescriptorSet m_bindlessSet = VK_NULL_HANDLE;
+			VkBuffer m_materialBuffer = VK_NULL_HANDLE;
+			VkDeviceMemory m_materialBufferMemory = VK_NULL_HANDLE;
+			crimild::UInt32 m_materialCount = 0;
+			crimild::UInt32 m_mainTextureIndex = 0;
+			crimild::UInt32 m_mainMaterialIndex = 0;
+
+			//@}
+
+			/**
+			   \name Model loading
+			 */
+			//@{
+
+		private:
+			/**
+			   \brief Parses the model into m_vertices and m_indices
+
+			   Runs as a job and must not make any Vulkan calls.
+			 */
+			void loadModel( void )
+			{
+				tinyobj::attrib_t attrib;
+				std::vector< tinyobj::shape_t > shapes;
+				std::vector< tinyobj::material_t > materials;
+				std::string err;
+
+				if ( !tinyobj::LoadObj(
+					&attrib,
+					&shapes,
+					&materials,
+					&err,
+					MODEL_PATH.c_str() ) ) {
+					throw RuntimeException( err );
+				}
+
+				std::unordered_map< Vertex, uint32_t > uniqueVertices = {};
+
+				for ( const auto &shape : shapes ) {
+					for ( const auto &index : shape.mesh.indices ) {
+						auto vertex = Vertex {
+							.pos = Vector3f(
+								attrib.vertices[ 3 * index.vertex_index + 0 ],
+								attrib.vertices[ 3 * index.vertex_index + 1 ],
+								attrib.vertices[ 3 * index.vertex_index + 2 ]
+							),
+							.texCoord = Vector2f(
+								attrib.texcoords[ 2 * index.texcoord_index + 0 ],
+								1.0f - attrib.texcoords[ 2 * index.texcoord_index + 1 ]
+							),
+							.color = Vector3f::ONE,
+						};
+
+						if ( uniqueVertices.count( vertex ) == 0 ) {
+							uniqueVertices[ vertex ] = static_cast< uint32_t >( m_vertices.size() );
+							m_vertices.push_back( vertex );
+						}
+
+						m_indices.push_back( uniqueVertices[ vertex ] );
+					}
+				}
+			}
+
+			/**
+			   \brief Registers renderables for the loaded model
+
+			   Runs after loadModel() is done and bindless resources exist, since
+			   renderables reference materials.
+			 */
+			void createRenderables( void )
+			{
+				m_renderables.push_back(
+					Renderable {
+						.indexCount = static_cast< uint32_t >( m_indices.size() ),
+						.firstIndex = 0,
+						.vertexOffset = 0,
+						.materialIndex = m_mainMaterialIndex,
+						.shaderFeatures = SHADER_FEATURE_TEXTURE,
+						.bounds = computeBoundingSphere( 0, static_cast< uint32_t >( m_indices.size() ), 0 ),
+						.albedoTexture = m_streamingTextures.empty() ? nullptr : m_streamingTextures.front().get(),
+					}
+				);
+			}
+
+			/**
+			   \brief Bounding sphere of the vertices referenced by a range of indices
+			 */
+			culling::Sphere computeBoundingSphere( uint32_t firstIndex, uint32_t indexCount, int32_t vertexOffset ) const
+			{
+				auto getPosition = [ & ]( uint32_t i, float *p ) {
+					const auto &pos = m_vertices[ m_indices[ firstIndex + i ] + vertexOffset ].pos;
+					p[ 0 ] = pos.x();
+					p[ 1 ] = pos.y();
+					p[ 2 ] = pos.z();
+				};
+
+				float min[ 3 ] = { std::numeric_limits< float >::max(), std::numeric_limits< float >::max(), std::numeric_limits< float >::max() };
+				float max[ 3 ] = { std::numeric_limits< float >::lowest(), std::numeric_limits< float >::lowest(), std::numeric_limits< float >::lowest() };
+				for ( uint32_t i = 0; i < indexCount; ++i ) {
+					float p[ 3 ];
+					getPosition( i, p );
+					for ( auto axis = 0; axis < 3; ++axis ) {
+						min[ axis ] = std::min( min[ axis ], p[ axis ] );
+						max[ axis ] = std::max( max[ axis ], p[ axis ] );
+					}
+				}
+
+				auto sphere = culling::Sphere { };
+				for ( auto axis = 0; axis < 3; ++axis ) {
+					sphere.center[ axis ] = indexCount > 0 ? 0.5f * ( min[ axis ] + max[ axis ] ) : 0.0f;
+				}
+
+				for ( uint32_t i = 0; i < indexCount; ++i ) {
+					float p[ 3 ];
+					getPosition( i, p );
+					auto dx = p[ 0 ] - sphere.center[ 0 ];
+					auto dy = p[ 1 ] - sphere.center[ 1 ];
+					auto dz = p[ 2 ] - sphere.center[ 2 ];
+					sphere.radius = std::max( sphere.radius, std::sqrt( dx * dx + dy * dy + dz * dz ) );
+				}
+
+				return sphere;
+			}
+
+			//@}
+
+			/**
+			   \name Scene
+
+			   Renderables describe what can be drawn. Every frame, the ones that
+			   should be drawn are collected into the draw list, which is then
+			   recorded into command buffers.
+			 */
+			//@{
+
+		private:
+			struct Renderable {
+				uint32_t indexCount;
+				uint32_t firstIndex;
+				int32_t vertexOffset;
+				uint32_t materialIndex;
+				crimild::UInt32 shaderFeatures = SHADER_FEATURE_DEFAULT;
+				Matrix4f model;
+				culling::Sphere bounds; //< In model space
+				StreamingTexture *albedoTexture = nullptr; //< Null unless streamed
+			};
+
+			/**
+			   \brief A single draw call
+
+			   Model and material index are pushed as constants. Draws reading
+			   them from the instance stream push the identity and 0 instead.
+			 */
+			struct DrawCommand {
+				uint32_t indexCount;
+				uint32_t firstIndex;
+				int32_t vertexOffset;
+				uint32_t materialIndex;
+				VkPipeline pipeline;
+				Matrix4f model;
+				uint32_t instanceCount;
+				uint32_t firstInstance;
+				culling::Sphere bounds;
+			};
+
+			/**
+			   \brief Animates renderables
+			 */
+			void updateScene( void )
+			{
+				static auto startTime = std::chrono::high_resolution_clock::now();
+
+				auto currentTime = std::chrono::high_resolution_clock::now();
+				auto time = ENABLE_ROTATION * std::chrono::duration< float, std::chrono::seconds::period >( currentTime - startTime ).count();
+
+				auto model = []( crimild::Real32 time ) {
+					Transformation t0;
+					t0.rotate().fromAxisAngle( Vector3f::UNIT_X, -Numericf::HALF_PI );
+					Transformation t1;
+					t1.rotate().fromAxisAngle( Vector3f::UNIT_Z, time * 35.0f * Numericf::DEG_TO_RAD );
+					Transformation t;
+					t.computeFrom( t0, t1 );
+					return t.computeModelMatrix();
+				}( time );
+
+				for ( auto &renderable : m_renderables ) {
+					renderable.model = model;
+				}
+			}
+
+			/**
+			   \brief Collects the renderables that should be drawn this frame
+
+			   World space bounds are gathered into structure-of-arrays form and
+			   tested against the camera frustum several at a time. Without CPU
+			   culling (i.e. when culling happens on the GPU), every renderable is
+			   considered visible.
+			 */
+			void cullRenderables( void )
+			{
+				const auto count = static_cast< crimild::UInt32 >( m_renderables.size() );
+				m_visibleRenderables.resize( count );
+
+				if ( !m_cpuCullingEnabled ) {
+					std::iota( m_visibleRenderables.begin(), m_visibleRenderables.end(), 0 );
+					return;
+				}
+
+				auto start = std::chrono::high_resolution_clock::now();
+
+				m_renderableBounds.clear();
+				m_renderableBounds.reserve( count );
+				for ( const auto &renderable : m_renderables ) {
+					std::array< crimild::Real32, 16 > model;
+					memcpy( model.data(), &renderable.model, sizeof( model ) );
+					m_renderableBounds.addSphere( culling::transformSphere( model.data(), renderable.bounds ) );
+				}
+
+				culling::Plane planes[ culling::PLANE_COUNT ];
+				culling::extractFrustumPlanes( computeCameraViewProjection().data(), planes );
+				m_visibleRenderables.resize( culling::cullSpheres( m_renderableBounds, planes, m_visibleRenderables.data() ) );
+
+				m_cullingStats.totalTime += std::chrono::duration< crimild::Real64, std::milli >( std::chrono::high_resolution_clock::now() - start ).count();
+				m_cullingStats.objects += count;
+				m_cullingStats.visible += m_visibleRenderables.size();
+				if ( ++m_cullingStats.frames == STATS_REPORT_INTERVAL ) {
+					CRIMILD_LOG_DEBUG(
+						"CPU culling: avg ", m_cullingStats.totalTime / m_cullingStats.frames, "ms, ",
+						m_cullingStats.objects / m_cullingStats.frames, " objects/frame, ",
+						m_cullingStats.visible / m_cullingStats.frames, " visible/frame"
+					);
+					m_cullingStats = CullingStats { };
+				}
+			}
+
+			/**
+			   \brief Collects draws, resolving the pipeline variant for each one
+
+			   Renderables sharing pipeline, material and mesh are merged into a
+			   single instanced draw, with their transforms written to the frame's
+			   instance buffer. Draws are sorted by pipeline so recording only
+			   binds each one once per command buffer.
+
+			   Multi-draw indirect can't change push constants between draws, so
+			   every draw goes through the instance stream in that case, and the
+			   resulting list is turned into indirect draw arguments.
+			 */
+			void buildDrawList( size_t frame )
+			{
+				cullRenderables();
+
+				// Only textures that are actually drawn get streamed in
+				for ( auto i : m_visibleRenderables ) {
+					if ( auto texture = m_renderables[ i ].albedoTexture ) {
+						markTextureSeen( *texture );
+					}
+				}
+
+				std::unordered_map< crimild::UInt32, VkPipeline > variants;
+
+				m_drawBatchKeys.clear();
+				for ( auto i : m_visibleRenderables ) {
+					const auto &renderable = m_renderables[ i ];
+
+					auto it = variants.find( renderable.shaderFeatures );
+					if ( it == variants.end() ) {
+						it = variants.insert( { renderable.shaderFeatures, getScenePipelineVariant( renderable.shaderFeatures ) } ).first;
+					}
+
+					m_drawBatchKeys.push_back(
+						DrawBatchKey {
+							.pipeline = it->second,
+							.materialIndex = renderable.materialIndex,
+							.firstIndex = renderable.firstIndex,
+							.indexCount = renderable.indexCount,
+							.vertexOffset = renderable.vertexOffset,
+							.renderable = i,
+						}
+					);
+				}
+
+				std::sort( m_drawBatchKeys.begin(), m_drawBatchKeys.end() );
+
+				// Worst case, every visible renderable is instanced (plus the identity at index 0)
+				reserveInstances( frame, static_cast< crimild::UInt32 >( m_visibleRenderables.size() ) + 1 );
+				auto instances = m_instanceBuffersMapped[ frame ];
+				crimild::UInt32 instanceCount = 1;
+
+				const auto minInstances = m_multiDrawIndirectEnabled ? 1 : INSTANCING_MIN_INSTANCES;
+
+				m_drawList.clear();
+				m_drawListInstanceCount = 0;
+				for ( size_t first = 0; first < m_drawBatchKeys.size(); ) {
+					auto last = first + 1;
+					while ( last < m_drawBatchKeys.size() && m_drawBatchKeys[ last ].isSameBatch( m_drawBatchKeys[ first ] ) ) {
+						++last;
+					}
+
+					const auto &key = m_drawBatchKeys[ first ];
+					const auto count = static_cast< crimild::UInt32 >( last - first );
+
+					auto draw = DrawCommand {
+						.indexCount = key.indexCount,
+						.firstIndex = key.firstIndex,
+						.vertexOffset = key.vertexOffset,
+						.materialIndex = key.materialIndex,
+						.pipeline = key.pipeline,
+						.model = m_renderables[ key.renderable ].model,
+						.instanceCount = 1,
+						.firstInstance = 0,
+						.bounds = m_renderables[ key.renderable ].bounds,
+					};
+
+					if ( count >= minInstances ) {
+						draw.model = IDENTITY_MATRIX;
+						draw.materialIndex = 0;
+						draw.instanceCount = count;
+						draw.firstInstance = instanceCount;
+						for ( auto i = first; i < last; ++i ) {
+							instances[ instanceCount++ ] = InstanceData {
+								.model = m_renderables[ m_drawBatchKeys[ i ].renderable ].model,
+								.materialIndex = key.materialIndex,
+							};
+						}
+						m_drawList.push_back( draw );
+					}
+					else {
+						for ( auto i = first; i < last; ++i ) {
+							draw.model = m_renderables[ m_drawBatchKeys[ i ].renderable ].model;
+							m_drawList.push_back( draw );
+						}
+					}
+
+					m_drawListInstanceCount += count;
+					first = last;
+				}
+
+				if ( m_gpuCullingEnabled ) {
+					buildCullObjects( frame );
+				}
+				else if ( m_multiDrawIndirectEnabled ) {
+					buildIndirectDraws( frame, instanceCount );
+				}
+			}
+
+		private:
+			/**
+			   \brief Sort key grouping renderables that can be drawn with a single instanced draw
+			 */
+			struct DrawBatchKey {
+				VkPipeline pipeline;
+				uint32_t materialIndex;
+				uint32_t firstIndex;
+				uint32_t indexCount;
+				int32_t vertexOffset;
+				crimild::UInt32 renderable;
+
+				bool isSameBatch( const DrawBatchKey &other ) const
+				{
+					return pipeline == other.pipeline
+						&& materialIndex == other.materialIndex
+						&& firstIndex == other.firstIndex
+						&& indexCount == other.indexCount
+						&& vertexOffset == other.vertexOffset;
+				}
+
+				bool operator<( const DrawBatchKey &other ) const
+				{
+					return std::tie( pipeline, materialIndex, firstIndex, indexCount, vertexOffset, renderable )
+						< std::tie( other.pipeline, other.materialIndex, other.firstIndex, other.indexCount, other.vertexOffset, other.renderable );
+				}
+			};
+
+			std::vector< Renderable > m_renderables;
+			std::vector< DrawBatchKey > m_drawBatchKeys;
+			crimild::Bool m_cpuCullingEnabled = false;
+			culling::BoundingVolumes m_renderableBounds;
+			std::vector< crimild::UInt32 > m_visibleRenderables;
+			std::vector< DrawCommand > m_drawList;
+			crimild::UInt32 m_drawListInstanceCount = 0;
+
+			//@}
+
+			/**
+			   \name Indirect draws
+
+			   With multi-draw indirect, draw arguments are written into a per-frame
+			   buffer and each pipeline is drawn with a single call, so the cost of
+			   recording no longer depends on the number of draws. All meshes live
+			   in the same vertex and index buffers, which are bound only once.
+
+			   Arguments are generated on the CPU by IndirectDrawBuilder, which is
+			   also the reference for any GPU-side generation. When available,
+			   VK_KHR_draw_indirect_count reads the number of draws for each batch
+			   from a buffer too, so it can be produced by the GPU as well.
+			 */
+			//@{
+
+		private:
+			crimild::Bool checkMultiDrawIndirectSupport( VkPhysicalDevice device ) const
+			{
+				VkPhysicalDeviceFeatures supportedFeatures;
+				vkGetPhysicalDeviceFeatures( device, &supportedFeatures );
+
+				// Indirect draws get their instance data through firstInstance
+				auto supported = supportedFeatures.multiDrawIndirect && supportedFeatures.drawIndirectFirstInstance;
+
+				CRIMILD_LOG_DEBUG( "Multi-draw indirect ", supported ? "enabled" : "disabled: feature not supported" );
+
+				return supported;
+			}
+
+			crimild::Bool checkDrawIndirectCountSupport( VkPhysicalDevice device ) const
+			{
+				crimild::UInt32 extensionCount;
+				vkEnumerateDeviceExtensionProperties( device, nullptr, &extensionCount, nullptr );
+				std::vector< VkExtensionProperties > availableExtensions( extensionCount );
+				vkEnumerateDeviceExtensionProperties( device, nullptr, &extensionCount, availableExtensions.data() );
+
+				auto supported = std::any_of( availableExtensions.begin(), availableExtensions.end(), []( const auto &extension ) {
+					return strcmp( extension.extensionName, VK_KHR_DRAW_INDIRECT_COUNT_EXTENSION_NAME ) == 0;
+				});
+
+				CRIMILD_LOG_DEBUG( "Indirect draw count ", supported ? "enabled" : "disabled: extension not available" );
+
+				return supported;
+			}
+
+			void createIndirectBuffers( void )
+			{
+				if ( !m_multiDrawIndirectEnabled ) {
+					return;
+				}
+
+				VkPhysicalDeviceProperties properties;
+				vkGetPhysicalDeviceProperties( m_physicalDevice, &properties );
+				m_indirectDraws.setMaxCommandsPerBatch( properties.limits.maxDrawIndirectCount );
+
+				m_indirectBuffers.assign( m_framesInFlight, IndirectBuffer { } );
+				for ( auto i = 0l; i < m_framesInFlight; ++i ) {
+					reserveIndirectCommands( i, INDIRECT_BUFFER_INITIAL_CAPACITY );
+				}
+			}
+
+			void cleanupIndirectBuffers( void )
+			{
+				for ( auto &indirect : m_indirectBuffers ) {
+					vkUnmapMemory( m_device, indirect.memory );
+					vkDestroyBuffer( m_device, indirect.buffer, nullptr );
+					vkFreeMemory( m_device, indirect.memory, nullptr );
+				}
+				m_indirectBuffers.clear();
+			}
+
+			/**
+			   \brief Makes sure the indirect buffer for a frame can hold count commands
+
+			   Commands and per-batch draw counts share the same buffer, with draw
+			   counts stored after the commands. Since there can't be more batches
+			   than commands, both regions have the same capacity.
+			 */
+			void reserveIndirectCommands( size_t frame, crimild::UInt32 count )
+			{
+				auto &indirect = m_indirectBuffers[ frame ];
+				if ( count <= indirect.capacity ) {
+					return;
+				}
+
+				auto capacity = std::max( INDIRECT_BUFFER_INITIAL_CAPACITY, indirect.capacity );
+				while ( capacity < count ) {
+					capacity *= 2;
+				}
+
+				if ( indirect.buffer != VK_NULL_HANDLE ) {
+					vkUnmapMemory( m_device, indirect.memory );
+					deferDestroy( indirect.buffer );
+					deferDestroy( indirect.memory );
+				}
+
+				auto usage = VkBufferUsageFlags( VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT );
+				if ( m_gpuCullingEnabled ) {
+					// Written by cull.comp
+					usage |= VK_BUFFER_USAGE_STORAGE_BUFFER_BIT;
+				}
+
+				// Capacity is always a multiple of 1024, so counts are aligned for storage buffer bindings
+				VkDeviceSize bufferSize = capacity * ( sizeof( DrawIndexedIndirectCommand ) + sizeof( crimild::UInt32 ) );
+				createBuffer(
+					bufferSize,
+					usage,
+					VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+					indirect.buffer,
+					indirect.memory
+				);
+
+				void *mapped;
+				vkMapMemory( m_device, indirect.memory, 0, bufferSize, 0, &mapped );
+				indirect.commands = static_cast< DrawIndexedIndirectCommand * >( mapped );
+				indirect.countsOffset = capacity * sizeof( DrawIndexedIndirectCommand );
+				indirect.counts = reinterpret_cast< crimild::UInt32 * >( static_cast< crimild::UInt8 * >( mapped ) + indirect.countsOffset );
+				indirect.capacity = capacity;
+
+				CRIMILD_LOG_DEBUG( "Indirect buffer for frame ", frame, " resized to ", capacity, " commands" );
+			}
+
+			/**
+			   \brief Generates indirect draw arguments for the current draw list
+
+			   Every draw is expected to read its data from the instance stream.
+			 */
+			void buildIndirectDraws( size_t frame, crimild::UInt32 instanceCount )
+			{
+				m_indirectDraws.clear();
+				for ( const auto &draw : m_drawList ) {
+					m_indirectDraws.add(
+						IndirectDrawBuilder< VkPipeline >::Draw {
+							.batchKey = draw.pipeline,
+							.indexCount = draw.indexCount,
+							.firstIndex = draw.firstIndex,
+							.vertexOffset = draw.vertexOffset,
+							.instanceCount = draw.instanceCount,
+							.firstInstance = draw.firstInstance,
+						}
+					);
+				}
+
+				const auto &commands = m_indirectDraws.getCommands();
+				const auto commandCount = static_cast< crimild::UInt32 >( commands.size() );
+
+#ifdef CRIMILD_DEBUG
+				validateIndirectCommands( commands.data(), commandCount, static_cast< crimild::UInt32 >( m_indices.size() ), instanceCount );
+#endif
+
+				reserveIndirectCommands( frame, commandCount );
+				auto &indirect = m_indirectBuffers[ frame ];
+				std::copy( commands.begin(), commands.end(), indirect.commands );
+				m_indirectDraws.writeDrawCounts( indirect.counts );
+			}
+
+			/**
+			   \brief Records one indirect draw call per batch
+			 */
+			void recordIndirectDraws( VkCommandBuffer commandBuffer, size_t frame )
+			{
+				bindDrawState( commandBuffer, frame );
+
+				// Everything else comes from the instance stream
+				auto pushConstants = DrawPushConstants {
+					.model = IDENTITY_MATRIX,
+					.materialIndex = 0,
+				};
+				vkCmdPushConstants( commandBuffer, m_pipelineLayout, m_drawPushConstantStages, 0, sizeof( DrawPushConstants ), &pushConstants );
+
+				const auto &indirect = m_indirectBuffers[ frame ];
+				const auto &batches = m_indirectDraws.getBatches();
+				for ( crimild::UInt32 i = 0; i < batches.size(); ++i ) {
+					const auto &batch = batches[ i ];
+
+					vkCmdBindPipeline( commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, batch.batchKey );
+
+					VkDeviceSize offset = batch.firstCommand * sizeof( DrawIndexedIndirectCommand );
+					if ( m_drawIndirectCountEnabled ) {
+						m_vkCmdDrawIndexedIndirectCount(
+							commandBuffer,
+							indirect.buffer,
+							offset,
+							indirect.buffer,
+							indirect.countsOffset + i * sizeof( crimild::UInt32 ),
+							batch.commandCount,
+							sizeof( DrawIndexedIndirectCommand )
+						);
+					}
+					else {
+						vkCmdDrawIndexedIndirect(
+							commandBuffer,
+							indirect.buffer,
+							offset,
+							batch.commandCount,
+							sizeof( DrawIndexedIndirectCommand )
+						);
+					}
+				}
+			}
+
+		private:
+			struct IndirectBuffer {
+				VkBuffer buffer = VK_NULL_HANDLE;
+				VkDeviceMemory memory = VK_NULL_HANDLE;
+				DrawIndexedIndirectCommand *commands = nullptr;
+				crimild::UInt32 *counts = nullptr;
+				VkDeviceSize countsOffset = 0;
+				crimild::UInt32 capacity = 0;
+			};
+
+			crimild::Bool m_multiDrawIndirectEnabled = false;
+			crimild::Bool m_drawIndirectCountEnabled = false;
+			PFN_vkCmdDrawIndexedIndirectCountKHR m_vkCmdDrawIndexedIndirectCount = nullptr;
+			IndirectDrawBuilder< VkPipeline > m_indirectDraws;
+			std::vector< IndirectBuffer > m_indirectBuffers;
+
+			//@}
+
+			/**
+			   \name GPU culling
+
+			   Every object (that is, every instance in the draw list) gets its own
+			   indirect command, and a compute pass writes only the visible ones into
+			   the indirect buffer, together with the number of draws for each batch.
+			   Objects are tested against the view frustum and, when supported,
+			   against a depth pyramid built from the previous frame's depth buffer.
+
+			   The pyramid is only valid for the camera that rendered it, so objects
+			   are projected with the previous frame's view-projection. Objects that
+			   moved since then may be culled for a frame.
+
+			   Setting CRIMILD_GPU_CULLING_VALIDATE compares results against the CPU
+			   reference in Culling.hpp once the GPU is done with each frame.
+			 */
+			//@{
+
+		private:
+			struct ComputePipeline {
+				VkPipeline pipeline = VK_NULL_HANDLE;
+				VkPipelineLayout layout = VK_NULL_HANDLE;
+				VkDescriptorSetLayout setLayout = VK_NULL_HANDLE;
+			};
+
+			/**
+			   \brief Must match push constants in depth_pyramid*.comp
+			 */
+			struct DepthPyramidParams {
+				crimild::UInt32 srcSize[ 2 ];
+				crimild::UInt32 dstSize[ 2 ];
+				crimild::UInt32 sampleCount;
+			};
+
+			crimild::Bool checkGpuCullingSupport( void ) const
+			{
+				if ( !hasShader( "assets/shaders/cull.comp.spv" ) ) {
+					CRIMILD_LOG_DEBUG( "GPU culling disabled: shaders not found" );
+					return false;
+				}
 
-				m_currentFrame = ( m_currentFrame + 1 ) % MAX_FRAMES_IN_FLIGHT;
+				CRIMILD_LOG_DEBUG( "GPU culling enabled" );
+				return true;
 			}
 
-		private:
-			size_t m_currentFrame = 0;
-			bool m_framebufferResized = false;
+			crimild::Bool checkOcclusionCullingSupport( void ) const
+			{
+				if ( !hasShader( getDepthPyramidInitShader() ) || !hasShader( "assets/shaders/depth_pyramid.comp.spv" ) ) {
+					CRIMILD_LOG_DEBUG( "Occlusion culling disabled: shaders not found" );
+					return false;
+				}
 
-			//@}
+				VkFormatProperties properties;
+				vkGetPhysicalDeviceFormatProperties( m_physicalDevice, findDepthFormat(), &properties );
+				if ( !( properties.optimalTilingFeatures & VK_FORMAT_FEATURE_SAMPLED_IMAGE_BIT ) ) {
+					CRIMILD_LOG_DEBUG( "Occlusion culling disabled: depth format can't be sampled" );
+					return false;
+				}
+
+				CRIMILD_LOG_DEBUG( "Occlusion culling enabled" );
+				return true;
+			}
 
 			/**
-			   \name Textures
-			 */
-			//@{
+			   \brief Shader reducing depth into the first pyramid level
 
-		private:
-			// TODO: use an image descriptor?
-			void createImage(
-				uint32_t width,
-				uint32_t height,
-				uint32_t mipLevels,
-				VkSampleCountFlagBits numSamples,
-				VkFormat format,
-				VkImageTiling tiling,
-				VkImageUsageFlags usage,
-				VkMemoryPropertyFlags properties,
-				VkImage &image,
-				VkDeviceMemory &imageMemory )
+			   Multisampled and single-sampled depth buffers need different sampler types.
+			 */
+			std::string getDepthPyramidInitShader( void ) const
 			{
-				auto imageInfo = VkImageCreateInfo {
-					.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO,
-					.imageType = VK_IMAGE_TYPE_2D,
-					.extent.width = width,
-					.extent.height = height,
-					.extent.depth = 1,
-					.mipLevels = mipLevels,
-					.arrayLayers = 1,
-					// Use same format for texels as the pixels in the buffer or copy will fail
-					.format = format,
-					.tiling = tiling,
-					.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED,
-					.usage = usage,
-					.sharingMode = VK_SHARING_MODE_EXCLUSIVE,
-					.samples = numSamples,
-					.flags = 0,
-				};
+				return m_msaaSamples == VK_SAMPLE_COUNT_1_BIT
+					? "assets/shaders/depth_pyramid_init_single.comp.spv"
+					: "assets/shaders/depth_pyramid_init.comp.spv";
+			}
 
-				if ( vkCreateImage( m_device, &imageInfo, nullptr, &image ) != VK_SUCCESS ) {
-					throw RuntimeException( "Failed to create image" );
-				}
+			ComputePipeline createComputePipeline( const std::string &filename )
+			{
+				const auto &reflection = getShaderReflection( filename );
+				auto layoutDescriptor = makePipelineLayoutDescriptor( reflection );
 
-				VkMemoryRequirements memRequirements;
-				vkGetImageMemoryRequirements( m_device, image, &memRequirements );
+				auto pipeline = ComputePipeline {
+					.layout = getPipelineLayout( layoutDescriptor ),
+					.setLayout = layoutDescriptor.setLayouts.front(),
+				};
 
-				auto allocInfo = VkMemoryAllocateInfo {
-					.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO,
-					.allocationSize = memRequirements.size,
-					.memoryTypeIndex = findMemoryType( memRequirements.memoryTypeBits, properties ),
+				auto pipelineInfo = VkComputePipelineCreateInfo {
+					.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO,
+					.stage = VkPipelineShaderStageCreateInfo {
+						.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO,
+						.stage = VK_SHADER_STAGE_COMPUTE_BIT,
+						.module = getShaderModule( filename ),
+						.pName = reflection.getEntryPoint().c_str(),
+					},
+					.layout = pipeline.layout,
 				};
 
-				if ( vkAllocateMemory( m_device, &allocInfo, nullptr, &imageMemory ) != VK_SUCCESS ) {
-					throw RuntimeException( "Failed to allocate image memory" );
+				if ( vkCreateComputePipelines( m_device, m_pipelineCache, 1, &pipelineInfo, nullptr, &pipeline.pipeline ) != VK_SUCCESS ) {
+					throw RuntimeException( "Failed to create compute pipeline for " + filename );
 				}
 
-				vkBindImageMemory( m_device, image, imageMemory, 0 );
+				return pipeline;
 			}
-			
-			void createTextureImage( void )
-			{
-				int texWidth, texHeight, texChannels;
-				auto pixels = stbi_load( TEXTURE_PATH.c_str(), &texWidth, &texHeight, &texChannels, STBI_rgb_alpha );
-				auto imageSize = texWidth * texHeight * 4;
 
-				if ( !pixels ) {
-					throw RuntimeException( "Failed to load texture image" );
+			void createCullingPipelines( void )
+			{
+				if ( !m_gpuCullingEnabled ) {
+					return;
 				}
 
-				// Compute number of mipmap levels
-				m_mipLevels = static_cast< uint32_t >( std::floor( std::log2( std::max( texWidth, texHeight ) ) ) ) + 1;
+				m_gpuCullingValidation = std::getenv( "CRIMILD_GPU_CULLING_VALIDATE" ) != nullptr;
 
-				// Use a staging buffer instead of a staging image which should be more efficient
-				VkBuffer stagingBuffer;
-				VkDeviceMemory stagingBufferMemory;
-				createBuffer(
-					imageSize,
-					VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
-					VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
-					stagingBuffer,
-					stagingBufferMemory
+				m_cullPipeline = createComputePipeline( "assets/shaders/cull.comp.spv" );
+
+				if ( m_occlusionCullingEnabled ) {
+					m_depthPyramidInitPipeline = createComputePipeline( getDepthPyramidInitShader() );
+					m_depthPyramidPipeline = createComputePipeline( "assets/shaders/depth_pyramid.comp.spv" );
+				}
+
+				// Pyramid levels are read with texelFetch, so no filtering at all
+				m_depthPyramidSampler = getSampler(
+					SamplerDescriptor {
+						.magFilter = VK_FILTER_NEAREST,
+						.minFilter = VK_FILTER_NEAREST,
+						.mipmapMode = VK_SAMPLER_MIPMAP_MODE_NEAREST,
+						.addressModeU = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE,
+						.addressModeV = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE,
+						.addressModeW = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE,
+						.maxAnisotropy = 1.0f,
+					}
 				);
+			}
 
-				void *data;
-				vkMapMemory( m_device, stagingBufferMemory, 0, imageSize, 0, &data );
-				memcpy( data, pixels, static_cast< size_t >( imageSize ) );
-				vkUnmapMemory( m_device, stagingBufferMemory );
+			void cleanupCullingPipelines( void )
+			{
+				// Layouts are owned by the pipeline layout cache
+				for ( auto pipeline : { &m_cullPipeline, &m_depthPyramidInitPipeline, &m_depthPyramidPipeline } ) {
+					if ( pipeline->pipeline != VK_NULL_HANDLE ) {
+						vkDestroyPipeline( m_device, pipeline->pipeline, nullptr );
+					}
+					*pipeline = ComputePipeline { };
+				}
+			}
 
-				// Cleanup original pixel data
-				stbi_image_free( pixels );
+			/**
+			   \brief Creates the depth pyramid for the current swapchain extent
+
+			   Without occlusion culling the pyramid is never built, but cull.comp
+			   still needs an image bound, so a single texel is created instead.
+			 */
+			void createDepthPyramid( void )
+			{
+				if ( !m_gpuCullingEnabled ) {
+					return;
+				}
+
+				m_depthPyramidExtent = m_occlusionCullingEnabled
+					? VkExtent2D { culling::previousPowerOfTwo( m_swapChainExtent.width ), culling::previousPowerOfTwo( m_swapChainExtent.height ) }
+					: VkExtent2D { 1, 1 };
+				m_depthPyramidLevels = culling::DepthPyramid::getLevelCount( m_depthPyramidExtent.width, m_depthPyramidExtent.height );
 
 				createImage(
-					texWidth,
-					texHeight,
-					m_mipLevels,
-					VK_SAMPLE_COUNT_1_BIT,					
-					VK_FORMAT_R8G8B8A8_UNORM,
+					m_depthPyramidExtent.width,
+					m_depthPyramidExtent.height,
+					m_depthPyramidLevels,
+					VK_SAMPLE_COUNT_1_BIT,
+					VK_FORMAT_R32_SFLOAT,
 					VK_IMAGE_TILING_OPTIMAL,
-					VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT,
+					VK_IMAGE_USAGE_STORAGE_BIT | VK_IMAGE_USAGE_SAMPLED_BIT,
 					VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
-					m_textureImage,
-					m_textureImageMemory
+					m_depthPyramid,
+					m_depthPyramidMemory
 				);
 
-				// Copy staging buffer to texture image
+				m_depthPyramidView = createImageView( m_depthPyramid, VK_FORMAT_R32_SFLOAT, VK_IMAGE_ASPECT_COLOR_BIT, m_depthPyramidLevels );
+
+				m_depthPyramidLevelViews.resize( m_depthPyramidLevels );
+				for ( crimild::UInt32 level = 0; level < m_depthPyramidLevels; ++level ) {
+					m_depthPyramidLevelViews[ level ] = createImageView( m_depthPyramid, VK_FORMAT_R32_SFLOAT, VK_IMAGE_ASPECT_COLOR_BIT, 1, 1, level );
+				}
+
+				// Both compute passes access the pyramid in the general layout, so it never changes
 				transitionImageLayout(
-					m_textureImage,
-					VK_FORMAT_R8G8B8A8_UNORM,
+					m_depthPyramid,
+					VK_FORMAT_R32_SFLOAT,
 					VK_IMAGE_LAYOUT_UNDEFINED,
-					VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
-					m_mipLevels
-				);
-				copyBufferToImage(
-					stagingBuffer,
-					m_textureImage,
-					static_cast< uint32_t >( texWidth ),
-					static_cast< uint32_t >( texHeight )
-				);
-
-				generateMipmaps(
-					m_textureImage,
-					VK_FORMAT_R8G8B8A8_UNORM,
-					texWidth,
-					texHeight,
-					m_mipLevels
+					VK_IMAGE_LAYOUT_GENERAL,
+					m_depthPyramidLevels
 				);
 
-				// cleanup
-				vkDestroyBuffer( m_device, stagingBuffer, nullptr );
-				vkFreeMemory( m_device, stagingBufferMemory, nullptr );
+				// Contents are undefined until the next frame builds it
+				m_depthPyramidValid = false;
 			}
 
-			void generateMipmaps(
-				VkImage image,
-				VkFormat imageFormat,
-				int32_t texWidth,
-				int32_t texHeight,
-				uint32_t mipLevels )
+			void cleanupDepthPyramid( void )
 			{
-				// Check if image format supports linear blitting
-				VkFormatProperties formatProperties;
-				vkGetPhysicalDeviceFormatProperties( m_physicalDevice, imageFormat, &formatProperties );
-				if ( !( formatProperties.optimalTilingFeatures & VK_FORMAT_FEATURE_SAMPLED_IMAGE_FILTER_LINEAR_BIT ) ) {
-					// TODO: either search for an image format that supports linear blitting
-					// Or implement mipmap generation in software (see stb_image_resize)
-					throw RuntimeException( "Texture image format does not support linear blitting" );
+				if ( m_depthPyramid == VK_NULL_HANDLE ) {
+					return;
 				}
-				
-				auto commandBuffer = beginSingleTimeCommands();
 
-				auto barrier = VkImageMemoryBarrier {
-					.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
-					.image = image,
-					.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
-					.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
-					.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
-					.subresourceRange.baseArrayLayer = 0,
-					.subresourceRange.layerCount = 1,
-					.subresourceRange.levelCount = 1,
-				};
+				for ( auto view : m_depthPyramidLevelViews ) {
+					deferDestroy( view );
+				}
+				m_depthPyramidLevelViews.clear();
 
-				auto mipWidth = texWidth;
-				auto mipHeight = texHeight;
+				deferDestroy( m_depthPyramidView );
+				deferDestroy( m_depthPyramid );
+				deferDestroy( m_depthPyramidMemory );
 
-				for ( uint32_t i = 1; i < mipLevels; ++i ) {
-					barrier.subresourceRange.baseMipLevel = i - 1;
-					barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
-					barrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
-					barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
-					barrier.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+				m_depthPyramidView = VK_NULL_HANDLE;
+				m_depthPyramid = VK_NULL_HANDLE;
+				m_depthPyramidMemory = VK_NULL_HANDLE;
+				m_depthPyramidValid = false;
+			}
 
-					vkCmdPipelineBarrier(
-						commandBuffer,
-						VK_PIPELINE_STAGE_TRANSFER_BIT,
-						VK_PIPELINE_STAGE_TRANSFER_BIT,
-						0,
-						0,
-						nullptr,
-						0,
-						nullptr,
-						1,
-						&barrier
-					);
+			void createCullingBuffers( void )
+			{
+				if ( !m_gpuCullingEnabled ) {
+					return;
+				}
 
-					auto blit = VkImageBlit {
-						.srcOffsets[ 0 ] = { 0, 0, 0 },
-						.srcOffsets[ 1 ] = { mipWidth, mipHeight, 1 },
-						.srcSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
-						.srcSubresource.mipLevel = i - 1,
-						.srcSubresource.baseArrayLayer = 0,
-						.srcSubresource.layerCount = 1,
-						.dstOffsets[ 0 ] = { 0, 0, 0 },
-						.dstOffsets[ 1 ] = {
-							mipWidth > 1 ? mipWidth / 2 : 1,
-							mipHeight > 1 ? mipHeight / 2 : 1,
-							1
-						},
-						.dstSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
-						.dstSubresource.mipLevel = i,
-						.dstSubresource.baseArrayLayer = 0,
-						.dstSubresource.layerCount = 1,
-					};
+				m_cullingBuffers.assign( m_framesInFlight, CullingBuffers { } );
+				for ( auto i = 0l; i < m_framesInFlight; ++i ) {
+					auto &buffers = m_cullingBuffers[ i ];
 
-					vkCmdBlitImage(
-						commandBuffer,
-						image,
-						VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
-						image,
-						VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
-						1,
-						&blit,
-						VK_FILTER_LINEAR
+					createBuffer(
+						sizeof( CullParams ),
+						VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT,
+						VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+						buffers.paramsBuffer,
+						buffers.paramsMemory
 					);
 
-					barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
-					barrier.newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
-					barrier.srcAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
-					barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+					void *mapped;
+					vkMapMemory( m_device, buffers.paramsMemory, 0, sizeof( CullParams ), 0, &mapped );
+					buffers.params = static_cast< CullParams * >( mapped );
 
-					vkCmdPipelineBarrier(
-						commandBuffer,
-						VK_PIPELINE_STAGE_TRANSFER_BIT,
-						VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
-						0,
-						0,
-						nullptr,
-						0,
-						nullptr,
-						1,
-						&barrier
-					);
+					reserveCullObjects( i, INSTANCE_BUFFER_INITIAL_CAPACITY );
+				}
+			}
 
-					// Handes cases where image is not squared. Make sure neither width nor height is zero
-					if ( mipWidth > 1 ) mipWidth /= 2;
-					if ( mipHeight > 1 ) mipHeight /= 2;
+			void cleanupCullingBuffers( void )
+			{
+				for ( auto &buffers : m_cullingBuffers ) {
+					vkUnmapMemory( m_device, buffers.paramsMemory );
+					vkDestroyBuffer( m_device, buffers.paramsBuffer, nullptr );
+					vkFreeMemory( m_device, buffers.paramsMemory, nullptr );
+
+					vkUnmapMemory( m_device, buffers.objectsMemory );
+					vkDestroyBuffer( m_device, buffers.objectsBuffer, nullptr );
+					vkFreeMemory( m_device, buffers.objectsMemory, nullptr );
+				}
+				m_cullingBuffers.clear();
+			}
+
+			/**
+			   \brief Makes sure the object buffer for a frame can hold count objects
+			 */
+			void reserveCullObjects( size_t frame, crimild::UInt32 count )
+			{
+				auto &buffers = m_cullingBuffers[ frame ];
+				if ( count <= buffers.capacity ) {
+					return;
+				}
+
+				auto capacity = std::max( INSTANCE_BUFFER_INITIAL_CAPACITY, buffers.capacity );
+				while ( capacity < count ) {
+					capacity *= 2;
 				}
 
-				// Transition last mip level
-				barrier.subresourceRange.baseMipLevel = mipLevels - 1;
-				barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
-				barrier.newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
-				barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
-				barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+				if ( buffers.objectsBuffer != VK_NULL_HANDLE ) {
+					vkUnmapMemory( m_device, buffers.objectsMemory );
+					deferDestroy( buffers.objectsBuffer );
+					deferDestroy( buffers.objectsMemory );
+				}
 
-				vkCmdPipelineBarrier(
-					commandBuffer,
-					VK_PIPELINE_STAGE_TRANSFER_BIT,
-					VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
-					0,
-					0,
-					nullptr,
-					0,
-					nullptr,
-					1,
-					&barrier
+				VkDeviceSize bufferSize = capacity * sizeof( culling::CullObject );
+				createBuffer(
+					bufferSize,
+					VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+					VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+					buffers.objectsBuffer,
+					buffers.objectsMemory
 				);
 
-				endSingleTimeCommands( commandBuffer );
+				void *mapped;
+				vkMapMemory( m_device, buffers.objectsMemory, 0, bufferSize, 0, &mapped );
+				buffers.objects = static_cast< culling::CullObject * >( mapped );
+				buffers.capacity = capacity;
+
+				CRIMILD_LOG_DEBUG( "Cull object buffer for frame ", frame, " resized to ", capacity, " objects" );
 			}
 
-			void transitionImageLayout(
-				VkImage image,
-				VkFormat format,
-				VkImageLayout oldLayout,
-				VkImageLayout newLayout,
-				uint32_t mipLevels )
+			std::array< crimild::Real32, 16 > computeCameraViewProjection( void ) const
 			{
-				auto commandBuffer = beginSingleTimeCommands();
+				std::array< crimild::Real32, 16 > view;
+				std::array< crimild::Real32, 16 > proj;
+				std::array< crimild::Real32, 16 > viewProj;
+				memcpy( view.data(), &m_cameraUniforms.view, sizeof( view ) );
+				memcpy( proj.data(), &m_cameraUniforms.proj, sizeof( proj ) );
+				culling::multiply( proj.data(), view.data(), viewProj.data() );
+				return viewProj;
+			}
 
-				auto barrier = VkImageMemoryBarrier {
-					.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
-					.oldLayout = oldLayout,
-					.newLayout = newLayout,
-					// we don't want to transfer queue family ownership
-					.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
-					.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
-					.image = image,
-					.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
-					.subresourceRange.baseMipLevel = 0,
-					.subresourceRange.levelCount = mipLevels,
-					.subresourceRange.baseArrayLayer = 0,
-					.subresourceRange.layerCount = 1,
-					.srcAccessMask = 0, // TODO
-					.dstAccessMask = 0, // TODO
-				};
+			/**
+			   \brief Expands the draw list into one object (and indirect command) per instance
 
-				// Transition barrier masks
-				VkPipelineStageFlags sourceStage;
-				VkPipelineStageFlags destinationStage;
+			   Every batch reserves a command for each of its objects, but draws only
+			   as many as cull.comp counts.
+			 */
+			void buildCullObjects( size_t frame )
+			{
+				reserveCullObjects( frame, m_drawListInstanceCount );
+
+				auto &buffers = m_cullingBuffers[ frame ];
+				const auto instances = m_instanceBuffersMapped[ frame ];
+				const auto &commands = m_indirectDraws.getCommands();
+				const auto &batches = m_indirectDraws.getBatches();
+
+				m_indirectDraws.clear();
+				crimild::UInt32 objectCount = 0;
+				for ( const auto &draw : m_drawList ) {
+					for ( auto instance = draw.firstInstance; instance < draw.firstInstance + draw.instanceCount; ++instance ) {
+						const auto commandCount = commands.size();
+						m_indirectDraws.add(
+							IndirectDrawBuilder< VkPipeline >::Draw {
+								.batchKey = draw.pipeline,
+								.indexCount = draw.indexCount,
+								.firstIndex = draw.firstIndex,
+								.vertexOffset = draw.vertexOffset,
+								.instanceCount = 1,
+								.firstInstance = instance,
+							}
+						);
+						if ( commands.size() == commandCount ) {
+							// Nothing to draw
+							continue;
+						}
 
-				if ( newLayout == VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL ) {
-					barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_DEPTH_BIT;
-					if ( hasStencilComponent( format ) ) {
-						barrier.subresourceRange.aspectMask |= VK_IMAGE_ASPECT_STENCIL_BIT;
+						std::array< crimild::Real32, 16 > model;
+						memcpy( model.data(), &instances[ instance ].model, sizeof( model ) );
+
+						buffers.objects[ objectCount++ ] = culling::CullObject {
+							.sphere = culling::transformSphere( model.data(), draw.bounds ),
+							.command = commands.back(),
+							.batch = static_cast< crimild::UInt32 >( batches.size() - 1 ),
+							.batchFirstCommand = batches.back().firstCommand,
+							.padding = 0,
+						};
 					}
 				}
 
-				if ( oldLayout == VK_IMAGE_LAYOUT_UNDEFINED && newLayout == VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL ) {
-					barrier.srcAccessMask = 0;
-					barrier.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
-					sourceStage = VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT;
-					destinationStage = VK_PIPELINE_STAGE_TRANSFER_BIT;
-				}
-				else if ( oldLayout == VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL && newLayout == VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL ) {
-					barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
-					barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
-					sourceStage = VK_PIPELINE_STAGE_TRANSFER_BIT;
-					destinationStage = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
-				}
-				else if ( oldLayout == VK_IMAGE_LAYOUT_UNDEFINED && newLayout == VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL ) {
-					barrier.srcAccessMask = 0;
-					barrier.dstAccessMask = VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
-					sourceStage = VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT;
-					destinationStage = VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT;
-				}
-				else if ( oldLayout == VK_IMAGE_LAYOUT_UNDEFINED && newLayout == VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL ) {
-					barrier.srcAccessMask = 0;
-					barrier.dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_READ_BIT | VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
-					sourceStage = VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT;
-					destinationStage = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
-				}
-				else {
-					throw std::invalid_argument( "Unsupported layout transition" );
+				const auto batchCount = static_cast< crimild::UInt32 >( batches.size() );
+
+				// There are never more batches than objects, so counts fit too
+				reserveIndirectCommands( frame, objectCount );
+				auto &indirect = m_indirectBuffers[ frame ];
+				std::fill( indirect.counts, indirect.counts + batchCount, 0 );
+
+				// Frustum for this frame, but occlusion against what the previous one rendered
+				auto params = CullParams {
+					.objectCount = objectCount,
+					.occlusionEnabled = m_occlusionCullingEnabled && m_depthPyramidValid,
+				};
+				culling::extractFrustumPlanes( computeCameraViewProjection().data(), params.planes );
+				std::copy( m_depthPyramidViewProj.begin(), m_depthPyramidViewProj.end(), params.pyramidViewProj );
+				*buffers.params = params;
+
+				buffers.objectCount = objectCount;
+				buffers.batchCount = batchCount;
+				buffers.pending = true;
+			}
+
+			void recordCulling( VkCommandBuffer commandBuffer, size_t frame )
+			{
+				const auto &buffers = m_cullingBuffers[ frame ];
+				const auto &indirect = m_indirectBuffers[ frame ];
+
+				if ( buffers.objectCount == 0 ) {
+					return;
 				}
 
+				// The previous frame's depth pyramid must be complete
+				auto pyramidBarrier = VkMemoryBarrier {
+					.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER,
+					.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT,
+					.dstAccessMask = VK_ACCESS_SHADER_READ_BIT,
+				};
+				vkCmdPipelineBarrier( commandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0, 1, &pyramidBarrier, 0, nullptr, 0, nullptr );
+
+				auto descriptorSet = getFrameDescriptorSet(
+					m_cullPipeline.setLayout,
+					{
+						DescriptorBinding {
+							.binding = 0,
+							.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER,
+							.buffer = buffers.paramsBuffer,
+							.offset = 0,
+							.range = sizeof( CullParams ),
+						},
+						DescriptorBinding {
+							.binding = 1,
+							.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+							.buffer = buffers.objectsBuffer,
+							.offset = 0,
+							.range = buffers.objectCount * sizeof( culling::CullObject ),
+						},
+						DescriptorBinding {
+							.binding = 2,
+							.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+							.buffer = indirect.buffer,
+							.offset = 0,
+							.range = indirect.countsOffset,
+						},
+						DescriptorBinding {
+							.binding = 3,
+							.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+							.buffer = indirect.buffer,
+							.offset = indirect.countsOffset,
+							.range = indirect.capacity * sizeof( crimild::UInt32 ),
+						},
+						DescriptorBinding {
+							.binding = 4,
+							.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,
+							.imageView = m_depthPyramidView,
+							.sampler = m_depthPyramidSampler,
+							.imageLayout = VK_IMAGE_LAYOUT_GENERAL,
+						},
+					}
+				);
+
+				vkCmdBindPipeline( commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, m_cullPipeline.pipeline );
+				vkCmdBindDescriptorSets( commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, m_cullPipeline.layout, 0, 1, &descriptorSet, 0, nullptr );
+				vkCmdDispatch( commandBuffer, ( buffers.objectCount + CULLING_WORKGROUP_SIZE - 1 ) / CULLING_WORKGROUP_SIZE, 1, 1 );
+
+				// Draw commands and counts are read as indirect arguments
+				auto indirectBarrier = VkMemoryBarrier {
+					.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER,
+					.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT,
+					.dstAccessMask = VK_ACCESS_INDIRECT_COMMAND_READ_BIT,
+				};
+				vkCmdPipelineBarrier( commandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT, 0, 1, &indirectBarrier, 0, nullptr, 0, nullptr );
+			}
+
+			/**
+			   \brief Reduces the depth buffer into the depth pyramid, to be used by the next frame
+			 */
+			void recordDepthPyramid( VkCommandBuffer commandBuffer )
+			{
+				auto depthFormat = findDepthFormat();
+				auto depthBarrier = VkImageMemoryBarrier {
+					.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
+					.oldLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL,
+					.newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+					.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+					.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+					.image = m_depthImage,
+					.subresourceRange = VkImageSubresourceRange {
+						.aspectMask = VkImageAspectFlags( VK_IMAGE_ASPECT_DEPTH_BIT | ( hasStencilComponent( depthFormat ) ? VK_IMAGE_ASPECT_STENCIL_BIT : 0 ) ),
+						.baseMipLevel = 0,
+						.levelCount = 1,
+						.baseArrayLayer = 0,
+						.layerCount = 1,
+					},
+					.srcAccessMask = VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT,
+					.dstAccessMask = VK_ACCESS_SHADER_READ_BIT,
+				};
+
+				// Compute is included so culling is done reading the pyramid before it's overwritten
 				vkCmdPipelineBarrier(
 					commandBuffer,
-					sourceStage,
-					destinationStage,
+					VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+					VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
 					0,
 					0,
 					nullptr,
 					0,
 					nullptr,
 					1,
-					&barrier
+					&depthBarrier
 				);
 
-				endSingleTimeCommands( commandBuffer );
-			}
+				auto params = DepthPyramidParams {
+					.srcSize = { m_renderExtent.width, m_renderExtent.height },
+					.dstSize = { m_depthPyramidExtent.width, m_depthPyramidExtent.height },
+					.sampleCount = static_cast< crimild::UInt32 >( m_msaaSamples ),
+				};
 
-			void copyBufferToImage( VkBuffer buffer, VkImage image, uint32_t width, uint32_t height )
-			{
-				auto commandBuffer = beginSingleTimeCommands();
+				auto descriptorSet = getFrameDescriptorSet(
+					m_depthPyramidInitPipeline.setLayout,
+					{
+						DescriptorBinding {
+							.binding = 0,
+							.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,
+							.imageView = m_depthImageView,
+							.sampler = m_depthPyramidSampler,
+							.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+						},
+						DescriptorBinding {
+							.binding = 1,
+							.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE,
+							.imageView = m_depthPyramidLevelViews[ 0 ],
+							.imageLayout = VK_IMAGE_LAYOUT_GENERAL,
+						},
+					}
+				);
 
-				auto region = VkBufferImageCopy {
-					.bufferOffset = 0,
-					.bufferRowLength = 0,
-					.bufferImageHeight = 0,
-					.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
-					.imageSubresource.mipLevel = 0,
-					.imageSubresource.baseArrayLayer = 0,
-					.imageSubresource.layerCount = 1,
-					.imageOffset = { 0, 0, 0 },
-					.imageExtent = { width, height, 1 },
-				};
+				vkCmdBindPipeline( commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, m_depthPyramidInitPipeline.pipeline );
+				vkCmdBindDescriptorSets( commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, m_depthPyramidInitPipeline.layout, 0, 1, &descriptorSet, 0, nullptr );
+				vkCmdPushConstants( commandBuffer, m_depthPyramidInitPipeline.layout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof( DepthPyramidParams ), &params );
+				dispatchDepthPyramidLevel( commandBuffer, params );
+
+				vkCmdBindPipeline( commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, m_depthPyramidPipeline.pipeline );
+				for ( crimild::UInt32 level = 1; level < m_depthPyramidLevels; ++level ) {
+					auto levelBarrier = VkMemoryBarrier {
+						.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER,
+						.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT,
+						.dstAccessMask = VK_ACCESS_SHADER_READ_BIT,
+					};
+					vkCmdPipelineBarrier( commandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0, 1, &levelBarrier, 0, nullptr, 0, nullptr );
+
+					params.srcSize[ 0 ] = params.dstSize[ 0 ];
+					params.srcSize[ 1 ] = params.dstSize[ 1 ];
+					params.dstSize[ 0 ] = std::max( 1u, m_depthPyramidExtent.width >> level );
+					params.dstSize[ 1 ] = std::max( 1u, m_depthPyramidExtent.height >> level );
+
+					descriptorSet = getFrameDescriptorSet(
+						m_depthPyramidPipeline.setLayout,
+						{
+							DescriptorBinding {
+								.binding = 0,
+								.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE,
+								.imageView = m_depthPyramidLevelViews[ level - 1 ],
+								.imageLayout = VK_IMAGE_LAYOUT_GENERAL,
+							},
+							DescriptorBinding {
+								.binding = 1,
+								.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE,
+								.imageView = m_depthPyramidLevelViews[ level ],
+								.imageLayout = VK_IMAGE_LAYOUT_GENERAL,
+							},
+						}
+					);
 
-				vkCmdCopyBufferToImage(
+					vkCmdBindDescriptorSets( commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, m_depthPyramidPipeline.layout, 0, 1, &descriptorSet, 0, nullptr );
+
+					// depth_pyramid.comp doesn't need the sample count
+					vkCmdPushConstants( commandBuffer, m_depthPyramidPipeline.layout, VK_SHADER_STAGE_COMPUTE_BIT, 0, offsetof( DepthPyramidParams, sampleCount ), &params );
+					dispatchDepthPyramidLevel( commandBuffer, params );
+				}
+
+				// Back to a depth attachment before the next frame renders into it
+				depthBarrier.oldLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+				depthBarrier.newLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
+				depthBarrier.srcAccessMask = 0;
+				depthBarrier.dstAccessMask = VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+				vkCmdPipelineBarrier(
 					commandBuffer,
-					buffer,
-					image,
-					// Assume image has already been transitioned to an optimal layout for copying pixels
-					VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+					VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+					VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT,
+					0,
+					0,
+					nullptr,
+					0,
+					nullptr,
 					1,
-					&region
+					&depthBarrier
 				);
 
-				endSingleTimeCommands( commandBuffer );
+				m_depthPyramidViewProj = computeCameraViewProjection();
+				m_depthPyramidValid = true;
 			}
 
-			void createTextureImageView( void )
+			void dispatchDepthPyramidLevel( VkCommandBuffer commandBuffer, const DepthPyramidParams &params )
 			{
-				m_textureImageView = createImageView(
-					m_textureImage,
-					VK_FORMAT_R8G8B8A8_UNORM,
-					VK_IMAGE_ASPECT_COLOR_BIT,
-					m_mipLevels
+				vkCmdDispatch(
+					commandBuffer,
+					( params.dstSize[ 0 ] + DEPTH_PYRAMID_WORKGROUP_SIZE - 1 ) / DEPTH_PYRAMID_WORKGROUP_SIZE,
+					( params.dstSize[ 1 ] + DEPTH_PYRAMID_WORKGROUP_SIZE - 1 ) / DEPTH_PYRAMID_WORKGROUP_SIZE,
+					1
 				);
 			}
 
-			void createTextureSampler( void )
+			/**
+			   \brief Gathers culling results once the GPU is done with a frame
+			 */
+			void collectCullingResults( size_t frame )
 			{
-				auto samplerInfo = VkSamplerCreateInfo {
-					.sType = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO,
-					.magFilter = VK_FILTER_LINEAR,
-					.minFilter = VK_FILTER_LINEAR,
-					.addressModeU = VK_SAMPLER_ADDRESS_MODE_REPEAT,
-					.addressModeV = VK_SAMPLER_ADDRESS_MODE_REPEAT,
-					.addressModeW = VK_SAMPLER_ADDRESS_MODE_REPEAT,
-					.anisotropyEnable = VK_TRUE,
-					.maxAnisotropy = 16,
-					.borderColor = VK_BORDER_COLOR_INT_OPAQUE_BLACK,
-					.unnormalizedCoordinates = VK_FALSE,
-					.compareEnable = VK_FALSE,
-					.compareOp = VK_COMPARE_OP_ALWAYS,
-					.mipmapMode = VK_SAMPLER_MIPMAP_MODE_LINEAR,
-					.mipLodBias = 0.0f,
-					.minLod = 0.0f,
-					.maxLod = static_cast< float >( m_mipLevels ),
-				};
+				if ( !m_gpuCullingEnabled ) {
+					return;
+				}
 
-				if ( vkCreateSampler( m_device, &samplerInfo, nullptr, &m_textureSampler ) != VK_SUCCESS ) {
-					throw RuntimeException( "Failed to create texture sampler" );
+				auto &buffers = m_cullingBuffers[ frame ];
+				if ( !buffers.pending ) {
+					return;
 				}
-			}
+				buffers.pending = false;
 
-		private:
-			uint32_t m_mipLevels;
-			VkImage m_textureImage;
-			VkDeviceMemory m_textureImageMemory;
-			VkImageView m_textureImageView;
-			VkSampler m_textureSampler;
+				const auto &indirect = m_indirectBuffers[ frame ];
+				auto visible = std::accumulate( indirect.counts, indirect.counts + buffers.batchCount, crimild::UInt64( 0 ) );
 
-			//@}
+				if ( m_gpuCullingValidation ) {
+					validateCullingResults( frame );
+				}
+
+				m_cullingStats.objects += buffers.objectCount;
+				m_cullingStats.visible += visible;
+				if ( ++m_cullingStats.frames == STATS_REPORT_INTERVAL ) {
+					CRIMILD_LOG_DEBUG(
+						"GPU culling: ",
+						m_cullingStats.objects / m_cullingStats.frames, " objects/frame, ",
+						m_cullingStats.visible / m_cullingStats.frames, " visible/frame",
+						m_gpuCullingValidation ? ", mismatches: " + std::to_string( m_cullingStats.mismatches ) : std::string()
+					);
+					m_cullingStats = CullingStats { };
+				}
+			}
 
 			/**
-			   \name Model loading
-			 */
-			//@{
+			   \brief Compares GPU culling results against the CPU reference
 
-		private:
-			void loadModel( void )
+			   Inputs are read back from the frame's buffers, so both use exactly the same
+			   data. There's no CPU copy of the depth pyramid, so the reference only does
+			   frustum culling. With occlusion enabled, the GPU must produce a subset of
+			   the reference. Otherwise, both must match exactly.
+			 */
+			void validateCullingResults( size_t frame )
 			{
-				tinyobj::attrib_t attrib;
-				std::vector< tinyobj::shape_t > shapes;
-				std::vector< tinyobj::material_t > materials;
-				std::string err;
-
-				if ( !tinyobj::LoadObj(
-					&attrib,
-					&shapes,
-					&materials,
-					&err,
-					MODEL_PATH.c_str() ) ) {
-					throw RuntimeException( err );
-				}
+				const auto &buffers = m_cullingBuffers[ frame ];
+				const auto &indirect = m_indirectBuffers[ frame ];
 
-				std::unordered_map< Vertex, uint32_t > uniqueVertices = {};
+				std::vector< DrawIndexedIndirectCommand > expected( buffers.objectCount );
+				std::vector< crimild::UInt32 > expectedCounts( buffers.batchCount, 0 );
+				culling::cullObjects( buffers.objects, buffers.objectCount, buffers.params->planes, nullptr, nullptr, expected.data(), expectedCounts.data() );
 
-				for ( const auto &shape : shapes ) {
-					for ( const auto &index : shape.mesh.indices ) {
-						auto vertex = Vertex {
-							.pos = Vector3f(
-								attrib.vertices[ 3 * index.vertex_index + 0 ],
-								attrib.vertices[ 3 * index.vertex_index + 1 ],
-								attrib.vertices[ 3 * index.vertex_index + 2 ]
-							),
-							.texCoord = Vector2f(
-								attrib.texcoords[ 2 * index.texcoord_index + 0 ],
-								1.0f - attrib.texcoords[ 2 * index.texcoord_index + 1 ]
-							),
-							.color = Vector3f::ONE,
-						};
+				std::vector< crimild::UInt32 > batchFirstCommands( buffers.batchCount, 0 );
+				for ( crimild::UInt32 i = 0; i < buffers.objectCount; ++i ) {
+					batchFirstCommands[ buffers.objects[ i ].batch ] = buffers.objects[ i ].batchFirstCommand;
+				}
 
-						if ( uniqueVertices.count( vertex ) == 0 ) {
-							uniqueVertices[ vertex ] = static_cast< uint32_t >( m_vertices.size() );
-							m_vertices.push_back( vertex );
-						}
+				const auto occlusion = buffers.params->occlusionEnabled != 0;
+
+				for ( crimild::UInt32 batch = 0; batch < buffers.batchCount; ++batch ) {
+					const auto first = batchFirstCommands[ batch ];
+					const auto count = indirect.counts[ batch ];
+					const auto expectedCount = expectedCounts[ batch ];
+
+					auto valid = occlusion ? count <= expectedCount : count == expectedCount;
+					if ( valid ) {
+						// The GPU appends commands in any order
+						culling::sortBatchCommands( indirect.commands, first, count );
+						culling::sortBatchCommands( expected.data(), first, expectedCount );
+						valid = std::includes(
+							expected.begin() + first,
+							expected.begin() + first + expectedCount,
+							indirect.commands + first,
+							indirect.commands + first + count,
+							culling::compareCommands
+						);
+					}
 
-						m_indices.push_back( uniqueVertices[ vertex ] );
+					if ( !valid ) {
+						++m_cullingStats.mismatches;
+						CRIMILD_LOG_ERROR(
+							"GPU culling doesn't match reference for batch ", batch, ": ",
+							count, " visible, expected ", occlusion ? "at most " : "", expectedCount
+						);
 					}
 				}
 			}
 
+		private:
+			/**
+			   \brief Must match CullParams in cull.comp (std140 layout)
+			 */
+			struct CullParams {
+				culling::Plane planes[ culling::PLANE_COUNT ];
+				crimild::Real32 pyramidViewProj[ 16 ];
+				crimild::UInt32 objectCount;
+				crimild::UInt32 occlusionEnabled;
+			};
+
+			struct CullingBuffers {
+				VkBuffer paramsBuffer = VK_NULL_HANDLE;
+				VkDeviceMemory paramsMemory = VK_NULL_HANDLE;
+				CullParams *params = nullptr;
+				VkBuffer objectsBuffer = VK_NULL_HANDLE;
+				VkDeviceMemory objectsMemory = VK_NULL_HANDLE;
+				culling::CullObject *objects = nullptr;
+				crimild::UInt32 capacity = 0;
+				crimild::UInt32 objectCount = 0;
+				crimild::UInt32 batchCount = 0;
+				crimild::Bool pending = false; //< Submitted, but results not collected yet
+			};
+
+			struct CullingStats {
+				crimild::UInt32 frames = 0;
+				crimild::UInt64 objects = 0;
+				crimild::UInt64 visible = 0;
+				crimild::UInt32 mismatches = 0;
+				crimild::Real64 totalTime = 0.0; //< CPU culling only
+			};
+
+			crimild::Bool m_gpuCullingEnabled = false;
+			crimild::Bool m_occlusionCullingEnabled = false;
+			crimild::Bool m_gpuCullingValidation = false;
+			ComputePipeline m_cullPipeline;
+			ComputePipeline m_depthPyramidInitPipeline;
+			ComputePipeline m_depthPyramidPipeline;
+			std::vector< CullingBuffers > m_cullingBuffers;
+			CullingStats m_cullingStats;
+
+			VkImage m_depthPyramid = VK_NULL_HANDLE;
+			VkDeviceMemory m_depthPyramidMemory = VK_NULL_HANDLE;
+			VkImageView m_depthPyramidView = VK_NULL_HANDLE;
+			std::vector< VkImageView > m_depthPyramidLevelViews;
+			VkExtent2D m_depthPyramidExtent = { 1, 1 };
+			crimild::UInt32 m_depthPyramidLevels = 0;
+			VkSampler m_depthPyramidSampler = VK_NULL_HANDLE;
+			std::array< crimild::Real32, 16 > m_depthPyramidViewProj = { };
+			crimild::Bool m_depthPyramidValid = false;
+
 			//@}
 
 			/**
@@ -2654,26 +8063,39 @@ namespace crimild {
 			void cleanup( void )
 			{
 				cleanupSwapChain();
+				cleanupRenderPass();
+				cleanupFrameResources();
 
-				vkDestroySampler( m_device, m_textureSampler, nullptr );
+				completeTextureResidency( true );
+				for ( auto &texture : m_streamingTextures ) {
+					destroyStreamingTexture( *texture );
+				}
+				m_streamingTextures.clear();
+
+				flushDeferredDestructions();
+
+				cleanupSamplers();
 				vkDestroyImageView( m_device, m_textureImageView, nullptr );
 				vkDestroyImage( m_device, m_textureImage, nullptr );
 				vkFreeMemory( m_device, m_textureImageMemory, nullptr );
 
-				vkDestroyDescriptorSetLayout( m_device, m_descriptorSetLayout, nullptr );
+				cleanupBindlessResources();
+				cleanupDescriptorAllocators();
+				cleanupDescriptorSetLayouts();
 
 				vkDestroyBuffer( m_device, m_vertexBuffer, nullptr );
 				vkFreeMemory( m_device, m_vertexBufferMemory, nullptr );
 				vkDestroyBuffer( m_device, m_indexBuffer, nullptr );
 				vkFreeMemory( m_device, m_indexBufferMemory, nullptr );
-				
-				for ( auto i = 0l; i < MAX_FRAMES_IN_FLIGHT; ++i ) {
-					vkDestroySemaphore( m_device, m_renderFinishedSemaphores[ i ], nullptr );
-					vkDestroySemaphore( m_device, m_imageAvailableSemaphores[ i ], nullptr );
-					vkDestroyFence( m_device, m_inFlightFences[ i ], nullptr );
-				}
 
 				vkDestroyCommandPool( m_device, m_commandPool, nullptr );
+
+				cleanupCullingPipelines();
+				cleanupPipelines();
+				cleanupPipelineCache();
+				cleanupShaders();
+				cleanupTimeline();
+				cleanupJobSystem();
 				
 				vkDestroyDevice( m_device, nullptr );
 				
@@ -0,0 +1,152 @@
+/*
+ * Copyright (c) 2002 - present, H. Hernan Saez
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the <organization> nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL <COPYRIGHT HOLDER> BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef CRIMILD_VULKAN_MAPPED_FILE_
+#define CRIMILD_VULKAN_MAPPED_FILE_
+
+#include <cstdint>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#if !defined( _WIN32 )
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace crimild {
+
+	namespace vulkan {
+
+		/**
+		   \brief Read-only view of a whole file
+
+		   Files are memory-mapped, so their contents can be handed to the driver
+		   without an intermediate copy. Platforms without mmap read the file into
+		   memory instead.
+		 */
+		class MappedFile {
+		public:
+			MappedFile( void ) = default;
+
+			explicit MappedFile( const std::string &filename )
+			{
+				open( filename );
+			}
+
+			MappedFile( const MappedFile & ) = delete;
+			MappedFile &operator=( const MappedFile & ) = delete;
+
+			~MappedFile( void )
+			{
+				close();
+			}
+
+			/**
+			   \brief Maps the file
+
+			   Throws if the file cannot be opened or is empty.
+			 */
+			void open( const std::string &filename )
+			{
+				close();
+
+#if !defined( _WIN32 )
+				auto fd = ::open( filename.c_str(), O_RDONLY );
+				if ( fd < 0 ) {
+					throw std::runtime_error( "Failed to open file: " + filename );
+				}
+
+				struct stat st;
+				if ( fstat( fd, &st ) != 0 || st.st_size <= 0 ) {
+					::close( fd );
+					throw std::runtime_error( "Failed to query file size: " + filename );
+				}
+
+				m_size = static_cast< std::size_t >( st.st_size );
+				auto mapped = mmap( nullptr, m_size, PROT_READ, MAP_PRIVATE, fd, 0 );
+				::close( fd );
+				if ( mapped == MAP_FAILED ) {
+					m_size = 0;
+					throw std::runtime_error( "Failed to map file: " + filename );
+				}
+				m_data = static_cast< const std::uint8_t * >( mapped );
+#else
+				std::ifstream file( filename, std::ios::ate | std::ios::binary );
+				if ( !file.is_open() ) {
+					throw std::runtime_error( "Failed to open file: " + filename );
+				}
+				m_fallbackStorage.resize( static_cast< std::size_t >( file.tellg() ) );
+				if ( m_fallbackStorage.empty() ) {
+					throw std::runtime_error( "Failed to query file size: " + filename );
+				}
+				file.seekg( 0 );
+				file.read( reinterpret_cast< char * >( m_fallbackStorage.data() ), m_fallbackStorage.size() );
+				m_data = m_fallbackStorage.data();
+				m_size = m_fallbackStorage.size();
+#endif
+			}
+
+			void close( void )
+			{
+#if !defined( _WIN32 )
+				if ( m_data != nullptr ) {
+					munmap( const_cast< std::uint8_t * >( m_data ), m_size );
+				}
+#else
+				m_fallbackStorage.clear();
+#endif
+				m_data = nullptr;
+				m_size = 0;
+			}
+
+			bool isOpen( void ) const { return m_data != nullptr; }
+
+			/**
+			   \brief Mapped contents
+
+			   Mappings are page-aligned, so the data can be read as 32-bit words.
+			 */
+			const std::uint8_t *getData( void ) const { return m_data; }
+			std::size_t getSize( void ) const { return m_size; }
+
+		private:
+			const std::uint8_t *m_data = nullptr;
+			std::size_t m_size = 0;
+#if defined( _WIN32 )
+			std::vector< std::uint8_t > m_fallbackStorage;
+#endif
+		};
+
+	}
+
+}
+
+#endif
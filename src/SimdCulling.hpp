@@ -0,0 +1,415 @@
+/*
+ * Copyright (c) 2002 - present, H. Hernan Saez
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the <organization> nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL <COPYRIGHT HOLDER> BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#ifndef CRIMILD_VULKAN_SIMD_CULLING_
+#define CRIMILD_VULKAN_SIMD_CULLING_
+
+#include "Culling.hpp"
+
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+#if defined( __AVX__ )
+#include <immintrin.h>
+#define CRIMILD_CULLING_AVX 1
+#endif
+
+#if defined( __SSE2__ ) || defined( _M_X64 ) || ( defined( _M_IX86_FP ) && _M_IX86_FP >= 2 )
+#include <emmintrin.h>
+#define CRIMILD_CULLING_SSE 1
+#endif
+
+#if defined( _MSC_VER )
+#include <intrin.h>
+#endif
+
+namespace crimild {
+
+	namespace vulkan {
+
+		namespace culling {
+
+			/**
+			   \brief World space bounding volumes stored as structure of arrays
+
+			   Every volume has both a bounding sphere and an axis-aligned box sharing
+			   the same center, so either test can be used. Arrays are padded to a
+			   multiple of SIMD_PADDING, so the SIMD paths can always load full
+			   registers.
+			 */
+			class BoundingVolumes {
+			public:
+				static constexpr std::uint32_t SIMD_PADDING = 8;
+
+				void clear( void )
+				{
+					m_count = 0;
+					for ( auto array : { &m_centerX, &m_centerY, &m_centerZ, &m_extentX, &m_extentY, &m_extentZ, &m_radius } ) {
+						array->clear();
+					}
+				}
+
+				void reserve( std::uint32_t count )
+				{
+					for ( auto array : { &m_centerX, &m_centerY, &m_centerZ, &m_extentX, &m_extentY, &m_extentZ, &m_radius } ) {
+						array->reserve( getPaddedCount( count ) );
+					}
+				}
+
+				/**
+				   \brief Adds a sphere, bounded by the cube enclosing it
+				 */
+				std::uint32_t addSphere( const Sphere &sphere )
+				{
+					return add( sphere.center, sphere.radius, sphere.radius, sphere.radius, sphere.radius );
+				}
+
+				/**
+				   \brief Adds a box, bounded by the sphere enclosing it
+				 */
+				std::uint32_t addBox( const float *min, const float *max )
+				{
+					const float center[ 3 ] = { 0.5f * ( min[ 0 ] + max[ 0 ] ), 0.5f * ( min[ 1 ] + max[ 1 ] ), 0.5f * ( min[ 2 ] + max[ 2 ] ) };
+					const float extent[ 3 ] = { 0.5f * ( max[ 0 ] - min[ 0 ] ), 0.5f * ( max[ 1 ] - min[ 1 ] ), 0.5f * ( max[ 2 ] - min[ 2 ] ) };
+					auto radius = std::sqrt( extent[ 0 ] * extent[ 0 ] + extent[ 1 ] * extent[ 1 ] + extent[ 2 ] * extent[ 2 ] );
+					return add( center, extent[ 0 ], extent[ 1 ], extent[ 2 ], radius );
+				}
+
+				std::uint32_t getCount( void ) const { return m_count; }
+
+				const float *getCenterX( void ) const { return m_centerX.data(); }
+				const float *getCenterY( void ) const { return m_centerY.data(); }
+				const float *getCenterZ( void ) const { return m_centerZ.data(); }
+				const float *getExtentX( void ) const { return m_extentX.data(); }
+				const float *getExtentY( void ) const { return m_extentY.data(); }
+				const float *getExtentZ( void ) const { return m_extentZ.data(); }
+				const float *getRadius( void ) const { return m_radius.data(); }
+
+			private:
+				static std::uint32_t getPaddedCount( std::uint32_t count )
+				{
+					return ( count + SIMD_PADDING - 1 ) / SIMD_PADDING * SIMD_PADDING;
+				}
+
+				std::uint32_t add( const float *center, float extentX, float extentY, float extentZ, float radius )
+				{
+					auto index = m_count++;
+					if ( m_radius.size() < getPaddedCount( m_count ) ) {
+						for ( auto array : { &m_centerX, &m_centerY, &m_centerZ, &m_extentX, &m_extentY, &m_extentZ, &m_radius } ) {
+							array->resize( getPaddedCount( m_count ), 0.0f );
+						}
+					}
+
+					m_centerX[ index ] = center[ 0 ];
+					m_centerY[ index ] = center[ 1 ];
+					m_centerZ[ index ] = center[ 2 ];
+					m_extentX[ index ] = extentX;
+					m_extentY[ index ] = extentY;
+					m_extentZ[ index ] = extentZ;
+					m_radius[ index ] = radius;
+					return index;
+				}
+
+			private:
+				std::uint32_t m_count = 0;
+				std::vector< float > m_centerX;
+				std::vector< float > m_centerY;
+				std::vector< float > m_centerZ;
+				std::vector< float > m_extentX;
+				std::vector< float > m_extentY;
+				std::vector< float > m_extentZ;
+				std::vector< float > m_radius;
+			};
+
+			/**
+			   \brief Appends the index of every set bit in a visibility mask
+			 */
+			inline std::uint32_t appendVisible( std::uint32_t mask, std::uint32_t base, std::uint32_t *visible, std::uint32_t visibleCount )
+			{
+				while ( mask != 0 ) {
+#if defined( _MSC_VER )
+					unsigned long bit;
+					_BitScanForward( &bit, mask );
+#else
+					auto bit = __builtin_ctz( mask );
+#endif
+					visible[ visibleCount++ ] = base + bit;
+					mask &= mask - 1;
+				}
+				return visibleCount;
+			}
+
+			inline std::uint32_t getTailMask( std::uint32_t remaining, std::uint32_t width )
+			{
+				return remaining >= width ? ( 1u << width ) - 1 : ( 1u << remaining ) - 1;
+			}
+
+			/**
+			   \brief Culls spheres one at a time
+
+			   Same test as isSphereInFrustum(). Writes the indices of visible volumes,
+			   in order, and returns how many there are.
+			 */
+			inline std::uint32_t cullSpheresScalar( const BoundingVolumes &volumes, const Plane *planes, std::uint32_t *visible )
+			{
+				std::uint32_t visibleCount = 0;
+				for ( std::uint32_t i = 0; i < volumes.getCount(); ++i ) {
+					auto inside = true;
+					for ( std::uint32_t p = 0; inside && p < PLANE_COUNT; ++p ) {
+						const auto &plane = planes[ p ];
+						auto distance = plane.normal[ 0 ] * volumes.getCenterX()[ i ]
+							+ plane.normal[ 1 ] * volumes.getCenterY()[ i ]
+							+ plane.normal[ 2 ] * volumes.getCenterZ()[ i ]
+							+ plane.distance;
+						inside = !( distance < -volumes.getRadius()[ i ] );
+					}
+					if ( inside ) {
+						visible[ visibleCount++ ] = i;
+					}
+				}
+				return visibleCount;
+			}
+
+			/**
+			   \brief Culls boxes one at a time
+
+			   A box is outside a plane when its center is farther behind it than the
+			   projection of its extents onto the plane normal.
+			 */
+			inline std::uint32_t cullBoxesScalar( const BoundingVolumes &volumes, const Plane *planes, std::uint32_t *visible )
+			{
+				std::uint32_t visibleCount = 0;
+				for ( std::uint32_t i = 0; i < volumes.getCount(); ++i ) {
+					auto inside = true;
+					for ( std::uint32_t p = 0; inside && p < PLANE_COUNT; ++p ) {
+						const auto &plane = planes[ p ];
+						auto distance = plane.normal[ 0 ] * volumes.getCenterX()[ i ]
+							+ plane.normal[ 1 ] * volumes.getCenterY()[ i ]
+							+ plane.normal[ 2 ] * volumes.getCenterZ()[ i ]
+							+ plane.distance;
+						auto radius = std::fabs( plane.normal[ 0 ] ) * volumes.getExtentX()[ i ]
+							+ std::fabs( plane.normal[ 1 ] ) * volumes.getExtentY()[ i ]
+							+ std::fabs( plane.normal[ 2 ] ) * volumes.getExtentZ()[ i ];
+						inside = !( distance < -radius );
+					}
+					if ( inside ) {
+						visible[ visibleCount++ ] = i;
+					}
+				}
+				return visibleCount;
+			}
+
+#if defined( CRIMILD_CULLING_SSE )
+			/**
+			   \brief Culls four spheres at a time with SSE2
+			 */
+			inline std::uint32_t cullSpheresSSE( const BoundingVolumes &volumes, const Plane *planes, std::uint32_t *visible )
+			{
+				__m128 nx[ PLANE_COUNT ], ny[ PLANE_COUNT ], nz[ PLANE_COUNT ], d[ PLANE_COUNT ];
+				for ( std::uint32_t p = 0; p < PLANE_COUNT; ++p ) {
+					nx[ p ] = _mm_set1_ps( planes[ p ].normal[ 0 ] );
+					ny[ p ] = _mm_set1_ps( planes[ p ].normal[ 1 ] );
+					nz[ p ] = _mm_set1_ps( planes[ p ].normal[ 2 ] );
+					d[ p ] = _mm_set1_ps( planes[ p ].distance );
+				}
+
+				const auto signMask = _mm_set1_ps( -0.0f );
+				std::uint32_t visibleCount = 0;
+				for ( std::uint32_t i = 0; i < volumes.getCount(); i += 4 ) {
+					auto cx = _mm_loadu_ps( volumes.getCenterX() + i );
+					auto cy = _mm_loadu_ps( volumes.getCenterY() + i );
+					auto cz = _mm_loadu_ps( volumes.getCenterZ() + i );
+					auto negRadius = _mm_xor_ps( _mm_loadu_ps( volumes.getRadius() + i ), signMask );
+
+					auto inside = _mm_castsi128_ps( _mm_set1_epi32( -1 ) );
+					for ( std::uint32_t p = 0; p < PLANE_COUNT; ++p ) {
+						auto distance = _mm_add_ps( _mm_add_ps( _mm_add_ps( _mm_mul_ps( nx[ p ], cx ), _mm_mul_ps( ny[ p ], cy ) ), _mm_mul_ps( nz[ p ], cz ) ), d[ p ] );
+						inside = _mm_and_ps( inside, _mm_cmpnlt_ps( distance, negRadius ) );
+					}
+
+					auto mask = std::uint32_t( _mm_movemask_ps( inside ) ) & getTailMask( volumes.getCount() - i, 4 );
+					visibleCount = appendVisible( mask, i, visible, visibleCount );
+				}
+				return visibleCount;
+			}
+
+			/**
+			   \brief Culls four boxes at a time with SSE2
+			 */
+			inline std::uint32_t cullBoxesSSE( const BoundingVolumes &volumes, const Plane *planes, std::uint32_t *visible )
+			{
+				__m128 nx[ PLANE_COUNT ], ny[ PLANE_COUNT ], nz[ PLANE_COUNT ], d[ PLANE_COUNT ];
+				__m128 ax[ PLANE_COUNT ], ay[ PLANE_COUNT ], az[ PLANE_COUNT ];
+				for ( std::uint32_t p = 0; p < PLANE_COUNT; ++p ) {
+					nx[ p ] = _mm_set1_ps( planes[ p ].normal[ 0 ] );
+					ny[ p ] = _mm_set1_ps( planes[ p ].normal[ 1 ] );
+					nz[ p ] = _mm_set1_ps( planes[ p ].normal[ 2 ] );
+					d[ p ] = _mm_set1_ps( planes[ p ].distance );
+					ax[ p ] = _mm_set1_ps( std::fabs( planes[ p ].normal[ 0 ] ) );
+					ay[ p ] = _mm_set1_ps( std::fabs( planes[ p ].normal[ 1 ] ) );
+					az[ p ] = _mm_set1_ps( std::fabs( planes[ p ].normal[ 2 ] ) );
+				}
+
+				const auto signMask = _mm_set1_ps( -0.0f );
+				std::uint32_t visibleCount = 0;
+				for ( std::uint32_t i = 0; i < volumes.getCount(); i += 4 ) {
+					auto cx = _mm_loadu_ps( volumes.getCenterX() + i );
+					auto cy = _mm_loadu_ps( volumes.getCenterY() + i );
+					auto cz = _mm_loadu_ps( volumes.getCenterZ() + i );
+					auto ex = _mm_loadu_ps( volumes.getExtentX() + i );
+					auto ey = _mm_loadu_ps( volumes.getExtentY() + i );
+					auto ez = _mm_loadu_ps( volumes.getExtentZ() + i );
+
+					auto inside = _mm_castsi128_ps( _mm_set1_epi32( -1 ) );
+					for ( std::uint32_t p = 0; p < PLANE_COUNT; ++p ) {
+						auto distance = _mm_add_ps( _mm_add_ps( _mm_add_ps( _mm_mul_ps( nx[ p ], cx ), _mm_mul_ps( ny[ p ], cy ) ), _mm_mul_ps( nz[ p ], cz ) ), d[ p ] );
+						auto radius = _mm_add_ps( _mm_add_ps( _mm_mul_ps( ax[ p ], ex ), _mm_mul_ps( ay[ p ], ey ) ), _mm_mul_ps( az[ p ], ez ) );
+						inside = _mm_and_ps( inside, _mm_cmpnlt_ps( distance, _mm_xor_ps( radius, signMask ) ) );
+					}
+
+					auto mask = std::uint32_t( _mm_movemask_ps( inside ) ) & getTailMask( volumes.getCount() - i, 4 );
+					visibleCount = appendVisible( mask, i, visible, visibleCount );
+				}
+				return visibleCount;
+			}
+#endif
+
+#if defined( CRIMILD_CULLING_AVX )
+			/**
+			   \brief Culls eight spheres at a time with AVX
+			 */
+			inline std::uint32_t cullSpheresAVX( const BoundingVolumes &volumes, const Plane *planes, std::uint32_t *visible )
+			{
+				__m256 nx[ PLANE_COUNT ], ny[ PLANE_COUNT ], nz[ PLANE_COUNT ], d[ PLANE_COUNT ];
+				for ( std::uint32_t p = 0; p < PLANE_COUNT; ++p ) {
+					nx[ p ] = _mm256_set1_ps( planes[ p ].normal[ 0 ] );
+					ny[ p ] = _mm256_set1_ps( planes[ p ].normal[ 1 ] );
+					nz[ p ] = _mm256_set1_ps( planes[ p ].normal[ 2 ] );
+					d[ p ] = _mm256_set1_ps( planes[ p ].distance );
+				}
+
+				const auto signMask = _mm256_set1_ps( -0.0f );
+				std::uint32_t visibleCount = 0;
+				for ( std::uint32_t i = 0; i < volumes.getCount(); i += 8 ) {
+					auto cx = _mm256_loadu_ps( volumes.getCenterX() + i );
+					auto cy = _mm256_loadu_ps( volumes.getCenterY() + i );
+					auto cz = _mm256_loadu_ps( volumes.getCenterZ() + i );
+					auto negRadius = _mm256_xor_ps( _mm256_loadu_ps( volumes.getRadius() + i ), signMask );
+
+					auto inside = _mm256_castsi256_ps( _mm256_set1_epi32( -1 ) );
+					for ( std::uint32_t p = 0; p < PLANE_COUNT; ++p ) {
+						auto distance = _mm256_add_ps( _mm256_add_ps( _mm256_add_ps( _mm256_mul_ps( nx[ p ], cx ), _mm256_mul_ps( ny[ p ], cy ) ), _mm256_mul_ps( nz[ p ], cz ) ), d[ p ] );
+						inside = _mm256_and_ps( inside, _mm256_cmp_ps( distance, negRadius, _CMP_NLT_UQ ) );
+					}
+
+					auto mask = std::uint32_t( _mm256_movemask_ps( inside ) ) & getTailMask( volumes.getCount() - i, 8 );
+					visibleCount = appendVisible( mask, i, visible, visibleCount );
+				}
+				return visibleCount;
+			}
+
+			/**
+			   \brief Culls eight boxes at a time with AVX
+			 */
+			inline std::uint32_t cullBoxesAVX( const BoundingVolumes &volumes, const Plane *planes, std::uint32_t *visible )
+			{
+				__m256 nx[ PLANE_COUNT ], ny[ PLANE_COUNT ], nz[ PLANE_COUNT ], d[ PLANE_COUNT ];
+				__m256 ax[ PLANE_COUNT ], ay[ PLANE_COUNT ], az[ PLANE_COUNT ];
+				for ( std::uint32_t p = 0; p < PLANE_COUNT; ++p ) {
+					nx[ p ] = _mm256_set1_ps( planes[ p ].normal[ 0 ] );
+					ny[ p ] = _mm256_set1_ps( planes[ p ].normal[ 1 ] );
+					nz[ p ] = _mm256_set1_ps( planes[ p ].normal[ 2 ] );
+					d[ p ] = _mm256_set1_ps( planes[ p ].distance );
+					ax[ p ] = _mm256_set1_ps( std::fabs( planes[ p ].normal[ 0 ] ) );
+					ay[ p ] = _mm256_set1_ps( std::fabs( planes[ p ].normal[ 1 ] ) );
+					az[ p ] = _mm256_set1_ps( std::fabs( planes[ p ].normal[ 2 ] ) );
+				}
+
+				const auto signMask = _mm256_set1_ps( -0.0f );
+				std::uint32_t visibleCount = 0;
+				for ( std::uint32_t i = 0; i < volumes.getCount(); i += 8 ) {
+					auto cx = _mm256_loadu_ps( volumes.getCenterX() + i );
+					auto cy = _mm256_loadu_ps( volumes.getCenterY() + i );
+					auto cz = _mm256_loadu_ps( volumes.getCenterZ() + i );
+					auto ex = _mm256_loadu_ps( volumes.getExtentX() + i );
+					auto ey = _mm256_loadu_ps( volumes.getExtentY() + i );
+					auto ez = _mm256_loadu_ps( volumes.getExtentZ() + i );
+
+					auto inside = _mm256_castsi256_ps( _mm256_set1_epi32( -1 ) );
+					for ( std::uint32_t p = 0; p < PLANE_COUNT; ++p ) {
+						auto distance = _mm256_add_ps( _mm256_add_ps( _mm256_add_ps( _mm256_mul_ps( nx[ p ], cx ), _mm256_mul_ps( ny[ p ], cy ) ), _mm256_mul_ps( nz[ p ], cz ) ), d[ p ] );
+						auto radius = _mm256_add_ps( _mm256_add_ps( _mm256_mul_ps( ax[ p ], ex ), _mm256_mul_ps( ay[ p ], ey ) ), _mm256_mul_ps( az[ p ], ez ) );
+						inside = _mm256_and_ps( inside, _mm256_cmp_ps( distance, _mm256_xor_ps( radius, signMask ), _CMP_NLT_UQ ) );
+					}
+
+					auto mask = std::uint32_t( _mm256_movemask_ps( inside ) ) & getTailMask( volumes.getCount() - i, 8 );
+					visibleCount = appendVisible( mask, i, visible, visibleCount );
+				}
+				return visibleCount;
+			}
+#endif
+
+			/**
+			   \brief Culls spheres with the widest instruction set available
+
+			   \param visible Receives the indices of visible volumes, in order. Must
+			   have room for volumes.getCount() entries
+			 */
+			inline std::uint32_t cullSpheres( const BoundingVolumes &volumes, const Plane *planes, std::uint32_t *visible )
+			{
+#if defined( CRIMILD_CULLING_AVX )
+				return cullSpheresAVX( volumes, planes, visible );
+#elif defined( CRIMILD_CULLING_SSE )
+				return cullSpheresSSE( volumes, planes, visible );
+#else
+				return cullSpheresScalar( volumes, planes, visible );
+#endif
+			}
+
+			/**
+			   \brief Culls boxes with the widest instruction set available
+			 */
+			inline std::uint32_t cullBoxes( const BoundingVolumes &volumes, const Plane *planes, std::uint32_t *visible )
+			{
+#if defined( CRIMILD_CULLING_AVX )
+				return cullBoxesAVX( volumes, planes, visible );
+#elif defined( CRIMILD_CULLING_SSE )
+				return cullBoxesSSE( volumes, planes, visible );
+#else
+				return cullBoxesScalar( volumes, planes, visible );
+#endif
+			}
+
+		}
+
+	}
+
+}
+
+#endif
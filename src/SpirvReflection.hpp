@@ -0,0 +1,739 @@
+/*
+ * Copyright (c) 2002 - present, H. Hernan Saez
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the <organization> nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL <COPYRIGHT HOLDER> BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef CRIMILD_VULKAN_SPIRV_REFLECTION_
+#define CRIMILD_VULKAN_SPIRV_REFLECTION_
+
+#include <algorithm>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace crimild {
+
+	namespace vulkan {
+
+		/**
+		   \brief Resource interface of a SPIR-V module
+
+		   Extracts descriptor bindings, push constants, vertex inputs and
+		   specialization constants straight from the binary, so layouts can be
+		   built from the shaders instead of being written by hand.
+
+		   Only the subset of SPIR-V produced by GLSL/HLSL front-ends for
+		   graphics and compute shaders is understood. Values for stages,
+		   descriptor types and formats match their Vulkan counterparts, so they
+		   can be cast directly without including Vulkan here.
+		 */
+		class ShaderReflection {
+		public:
+			/**
+			   \brief Values match VkShaderStageFlagBits
+			 */
+			enum Stage : std::uint32_t {
+				STAGE_VERTEX = 0x01,
+				STAGE_TESSELLATION_CONTROL = 0x02,
+				STAGE_TESSELLATION_EVALUATION = 0x04,
+				STAGE_GEOMETRY = 0x08,
+				STAGE_FRAGMENT = 0x10,
+				STAGE_COMPUTE = 0x20,
+			};
+
+			/**
+			   \brief Values match VkDescriptorType
+			 */
+			enum DescriptorType : std::uint32_t {
+				DESCRIPTOR_TYPE_SAMPLER = 0,
+				DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER = 1,
+				DESCRIPTOR_TYPE_SAMPLED_IMAGE = 2,
+				DESCRIPTOR_TYPE_STORAGE_IMAGE = 3,
+				DESCRIPTOR_TYPE_UNIFORM_TEXEL_BUFFER = 4,
+				DESCRIPTOR_TYPE_STORAGE_TEXEL_BUFFER = 5,
+				DESCRIPTOR_TYPE_UNIFORM_BUFFER = 6,
+				DESCRIPTOR_TYPE_STORAGE_BUFFER = 7,
+			};
+
+			/**
+			   \brief Values match VkFormat
+			 */
+			enum Format : std::uint32_t {
+				FORMAT_UNDEFINED = 0,
+				FORMAT_R32_UINT = 98,
+				FORMAT_R32_SINT = 99,
+				FORMAT_R32_SFLOAT = 100,
+				FORMAT_R32G32_UINT = 101,
+				FORMAT_R32G32_SINT = 102,
+				FORMAT_R32G32_SFLOAT = 103,
+				FORMAT_R32G32B32_UINT = 104,
+				FORMAT_R32G32B32_SINT = 105,
+				FORMAT_R32G32B32_SFLOAT = 106,
+				FORMAT_R32G32B32A32_UINT = 107,
+				FORMAT_R32G32B32A32_SINT = 108,
+				FORMAT_R32G32B32A32_SFLOAT = 109,
+			};
+
+			struct DescriptorBinding {
+				std::uint32_t set;
+				std::uint32_t binding;
+				std::uint32_t descriptorType;
+
+				/**
+				   Zero for runtime-sized arrays (i.e. bindless textures)
+				 */
+				std::uint32_t descriptorCount;
+
+				std::uint32_t stageFlags;
+				std::string name;
+			};
+
+			struct PushConstantRange {
+				std::uint32_t stageFlags;
+				std::uint32_t offset;
+				std::uint32_t size;
+			};
+
+			struct VertexInput {
+				std::uint32_t location;
+				std::uint32_t format;
+				std::string name;
+			};
+
+			struct SpecializationConstant {
+				std::uint32_t constantID;
+				std::uint32_t size;
+				std::string name;
+			};
+
+		public:
+			ShaderReflection( void ) = default;
+
+			/**
+			   \brief Reflects a SPIR-V binary
+
+			   Throws if the binary is malformed.
+			 */
+			ShaderReflection( const std::uint32_t *code, std::size_t wordCount )
+			{
+				parse( code, wordCount );
+			}
+
+			std::uint32_t getStage( void ) const { return m_stage; }
+			const std::string &getEntryPoint( void ) const { return m_entryPoint; }
+
+			/**
+			   \brief Descriptor bindings, sorted by set and binding
+			 */
+			const std::vector< DescriptorBinding > &getDescriptorBindings( void ) const { return m_descriptorBindings; }
+
+			const std::vector< PushConstantRange > &getPushConstantRanges( void ) const { return m_pushConstantRanges; }
+
+			/**
+			   \brief Vertex inputs (vertex stage only), sorted by location
+
+			   Built-ins like gl_VertexIndex are not included. Matrix inputs are
+			   listed once per column, since each column takes its own location.
+			 */
+			const std::vector< VertexInput > &getVertexInputs( void ) const { return m_vertexInputs; }
+
+			const std::vector< SpecializationConstant > &getSpecializationConstants( void ) const { return m_specializationConstants; }
+
+			/**
+			   \brief Combines the interfaces of every stage of a pipeline
+
+			   Bindings used by several stages are merged into one, with all those
+			   stages in their flags. Throws if stages disagree on the type of a
+			   binding.
+			 */
+			static ShaderReflection merge( const std::vector< const ShaderReflection * > &stages )
+			{
+				ShaderReflection merged;
+
+				for ( auto stage : stages ) {
+					merged.m_stage |= stage->m_stage;
+
+					for ( const auto &binding : stage->m_descriptorBindings ) {
+						auto it = std::find_if(
+							merged.m_descriptorBindings.begin(),
+							merged.m_descriptorBindings.end(),
+							[ &binding ]( const auto &other ) {
+								return other.set == binding.set && other.binding == binding.binding;
+							}
+						);
+
+						if ( it == merged.m_descriptorBindings.end() ) {
+							merged.m_descriptorBindings.push_back( binding );
+							continue;
+						}
+
+						if ( it->descriptorType != binding.descriptorType || it->descriptorCount != binding.descriptorCount ) {
+							throw std::runtime_error(
+								"Mismatched descriptor binding between shader stages (set "
+								+ std::to_string( binding.set ) + ", binding " + std::to_string( binding.binding ) + ")"
+							);
+						}
+
+						it->stageFlags |= binding.stageFlags;
+					}
+
+					for ( const auto &range : stage->m_pushConstantRanges ) {
+						merged.m_pushConstantRanges.push_back( range );
+					}
+
+					if ( stage->m_stage == STAGE_VERTEX ) {
+						merged.m_vertexInputs = stage->m_vertexInputs;
+					}
+
+					for ( const auto &constant : stage->m_specializationConstants ) {
+						auto exists = std::any_of(
+							merged.m_specializationConstants.begin(),
+							merged.m_specializationConstants.end(),
+							[ &constant ]( const auto &other ) { return other.constantID == constant.constantID; }
+						);
+						if ( !exists ) {
+							merged.m_specializationConstants.push_back( constant );
+						}
+					}
+				}
+
+				merged.sort();
+
+				return merged;
+			}
+
+		private:
+			enum Op : std::uint32_t {
+				OP_NAME = 5,
+				OP_ENTRY_POINT = 15,
+				OP_TYPE_BOOL = 20,
+				OP_TYPE_INT = 21,
+				OP_TYPE_FLOAT = 22,
+				OP_TYPE_VECTOR = 23,
+				OP_TYPE_MATRIX = 24,
+				OP_TYPE_IMAGE = 25,
+				OP_TYPE_SAMPLER = 26,
+				OP_TYPE_SAMPLED_IMAGE = 27,
+				OP_TYPE_ARRAY = 28,
+				OP_TYPE_RUNTIME_ARRAY = 29,
+				OP_TYPE_STRUCT = 30,
+				OP_TYPE_POINTER = 32,
+				OP_CONSTANT = 43,
+				OP_SPEC_CONSTANT_TRUE = 48,
+				OP_SPEC_CONSTANT_FALSE = 49,
+				OP_SPEC_CONSTANT = 50,
+				OP_VARIABLE = 59,
+				OP_DECORATE = 71,
+				OP_MEMBER_DECORATE = 72,
+			};
+
+			enum Decoration : std::uint32_t {
+				DECORATION_SPEC_ID = 1,
+				DECORATION_BUFFER_BLOCK = 3,
+				DECORATION_ARRAY_STRIDE = 6,
+				DECORATION_MATRIX_STRIDE = 7,
+				DECORATION_BUILT_IN = 11,
+				DECORATION_LOCATION = 30,
+				DECORATION_BINDING = 33,
+				DECORATION_DESCRIPTOR_SET = 34,
+				DECORATION_OFFSET = 35,
+			};
+
+			enum StorageClass : std::uint32_t {
+				STORAGE_CLASS_UNIFORM_CONSTANT = 0,
+				STORAGE_CLASS_INPUT = 1,
+				STORAGE_CLASS_UNIFORM = 2,
+				STORAGE_CLASS_PUSH_CONSTANT = 9,
+				STORAGE_CLASS_STORAGE_BUFFER = 12,
+			};
+
+			static constexpr std::uint32_t MAGIC_NUMBER = 0x07230203;
+			static constexpr std::uint32_t HEADER_WORD_COUNT = 5;
+			static constexpr std::uint32_t IMAGE_DIM_BUFFER = 5;
+
+			/**
+			   \brief Everything known about a single result id
+			 */
+			struct Id {
+				std::uint32_t opcode = 0;
+				std::vector< std::uint32_t > operands;
+				std::string name;
+
+				std::uint32_t set = 0;
+				std::uint32_t binding = 0;
+				std::uint32_t location = 0;
+				std::uint32_t specId = 0;
+				std::uint32_t arrayStride = 0;
+				bool hasBinding = false;
+				bool hasLocation = false;
+				bool hasSpecId = false;
+				bool isBuiltIn = false;
+				bool isBufferBlock = false;
+
+				std::vector< std::uint32_t > memberOffsets;
+				std::vector< std::uint32_t > memberMatrixStrides;
+			};
+
+			void parse( const std::uint32_t *code, std::size_t wordCount )
+			{
+				if ( code == nullptr || wordCount < HEADER_WORD_COUNT || code[ 0 ] != MAGIC_NUMBER ) {
+					throw std::runtime_error( "Invalid SPIR-V binary" );
+				}
+
+				const auto bound = code[ 3 ];
+				std::vector< Id > ids( bound );
+
+				auto getId = [ & ]( std::uint32_t id ) -> Id & {
+					if ( id >= bound ) {
+						throw std::runtime_error( "Invalid SPIR-V id" );
+					}
+					return ids[ id ];
+				};
+
+				for ( std::size_t offset = HEADER_WORD_COUNT; offset < wordCount; ) {
+					const auto opcode = code[ offset ] & 0xFFFF;
+					const auto length = code[ offset ] >> 16;
+					if ( length == 0 || offset + length > wordCount ) {
+						throw std::runtime_error( "Truncated SPIR-V instruction" );
+					}
+
+					const auto *operands = code + offset + 1;
+					const auto operandCount = length - 1;
+
+					switch ( opcode ) {
+						case OP_NAME: {
+							getId( operands[ 0 ] ).name = readString( operands + 1, operandCount - 1 );
+							break;
+						}
+
+						case OP_ENTRY_POINT: {
+							// Only the first entry point is reflected
+							if ( m_entryPoint.empty() ) {
+								m_stage = getStageFromExecutionModel( operands[ 0 ] );
+								m_entryPoint = readString( operands + 2, operandCount - 2 );
+							}
+							break;
+						}
+
+						case OP_DECORATE: {
+							auto &target = getId( operands[ 0 ] );
+							const auto value = operandCount > 2 ? operands[ 2 ] : 0;
+							switch ( operands[ 1 ] ) {
+								case DECORATION_SPEC_ID:
+									target.specId = value;
+									target.hasSpecId = true;
+									break;
+								case DECORATION_BUFFER_BLOCK:
+									target.isBufferBlock = true;
+									break;
+								case DECORATION_ARRAY_STRIDE:
+									target.arrayStride = value;
+									break;
+								case DECORATION_BUILT_IN:
+									target.isBuiltIn = true;
+									break;
+								case DECORATION_LOCATION:
+									target.location = value;
+									target.hasLocation = true;
+									break;
+								case DECORATION_BINDING:
+									target.binding = value;
+									target.hasBinding = true;
+									break;
+								case DECORATION_DESCRIPTOR_SET:
+									target.set = value;
+									break;
+								default:
+									break;
+							}
+							break;
+						}
+
+						case OP_MEMBER_DECORATE: {
+							auto &target = getId( operands[ 0 ] );
+							const auto member = operands[ 1 ];
+							const auto value = operandCount > 3 ? operands[ 3 ] : 0;
+							if ( operands[ 2 ] == DECORATION_BUILT_IN ) {
+								// Blocks made of built-ins (i.e. gl_PerVertex) are not resources
+								target.isBuiltIn = true;
+							}
+							else if ( operands[ 2 ] == DECORATION_OFFSET ) {
+								resizeFor( target.memberOffsets, member );
+								target.memberOffsets[ member ] = value;
+							}
+							else if ( operands[ 2 ] == DECORATION_MATRIX_STRIDE ) {
+								resizeFor( target.memberMatrixStrides, member );
+								target.memberMatrixStrides[ member ] = value;
+							}
+							break;
+						}
+
+						case OP_TYPE_BOOL:
+						case OP_TYPE_INT:
+						case OP_TYPE_FLOAT:
+						case OP_TYPE_VECTOR:
+						case OP_TYPE_MATRIX:
+						case OP_TYPE_IMAGE:
+						case OP_TYPE_SAMPLER:
+						case OP_TYPE_SAMPLED_IMAGE:
+						case OP_TYPE_ARRAY:
+						case OP_TYPE_RUNTIME_ARRAY:
+						case OP_TYPE_STRUCT:
+						case OP_TYPE_POINTER: {
+							auto &type = getId( operands[ 0 ] );
+							type.opcode = opcode;
+							type.operands.assign( operands + 1, operands + operandCount );
+							break;
+						}
+
+						case OP_CONSTANT:
+						case OP_SPEC_CONSTANT:
+						case OP_SPEC_CONSTANT_TRUE:
+						case OP_SPEC_CONSTANT_FALSE: {
+							// Result type comes first for constants
+							auto &constant = getId( operands[ 1 ] );
+							constant.opcode = opcode;
+							constant.operands.assign( operands, operands + operandCount );
+							break;
+						}
+
+						case OP_VARIABLE: {
+							auto &variable = getId( operands[ 1 ] );
+							variable.opcode = opcode;
+							variable.operands.assign( operands, operands + operandCount );
+							break;
+						}
+
+						default:
+							break;
+					}
+
+					offset += length;
+				}
+
+				for ( std::uint32_t id = 0; id < bound; ++id ) {
+					const auto &entry = ids[ id ];
+					if ( entry.opcode == OP_VARIABLE ) {
+						reflectVariable( ids, entry );
+					}
+					else if ( entry.hasSpecId && entry.opcode >= OP_SPEC_CONSTANT_TRUE && entry.opcode <= OP_SPEC_CONSTANT ) {
+						m_specializationConstants.push_back(
+							SpecializationConstant {
+								entry.specId,
+								getTypeSize( ids, entry.operands[ 0 ] ),
+								entry.name,
+							}
+						);
+					}
+				}
+
+				sort();
+			}
+
+			void reflectVariable( const std::vector< Id > &ids, const Id &variable )
+			{
+				const auto &pointer = ids[ variable.operands[ 0 ] ];
+				if ( pointer.opcode != OP_TYPE_POINTER ) {
+					return;
+				}
+
+				const auto storageClass = variable.operands[ 2 ];
+				auto typeId = pointer.operands[ 1 ];
+
+				switch ( storageClass ) {
+					case STORAGE_CLASS_INPUT: {
+						if ( m_stage != STAGE_VERTEX || variable.isBuiltIn || !variable.hasLocation || ids[ typeId ].isBuiltIn ) {
+							return;
+						}
+
+						// Matrices take one location per column
+						auto locationCount = 1u;
+						if ( ids[ typeId ].opcode == OP_TYPE_MATRIX ) {
+							locationCount = ids[ typeId ].operands[ 1 ];
+							typeId = ids[ typeId ].operands[ 0 ];
+						}
+
+						for ( std::uint32_t i = 0; i < locationCount; ++i ) {
+							m_vertexInputs.push_back(
+								VertexInput {
+									variable.location + i,
+									getVertexFormat( ids, typeId ),
+									variable.name,
+								}
+							);
+						}
+						break;
+					}
+
+					case STORAGE_CLASS_PUSH_CONSTANT: {
+						m_pushConstantRanges.push_back(
+							PushConstantRange {
+								m_stage,
+								getStructOffset( ids, typeId ),
+								getTypeSize( ids, typeId ) - getStructOffset( ids, typeId ),
+							}
+						);
+						break;
+					}
+
+					case STORAGE_CLASS_UNIFORM_CONSTANT:
+					case STORAGE_CLASS_UNIFORM:
+					case STORAGE_CLASS_STORAGE_BUFFER: {
+						if ( !variable.hasBinding ) {
+							return;
+						}
+
+						std::uint32_t count = 1;
+						if ( ids[ typeId ].opcode == OP_TYPE_ARRAY ) {
+							count = getConstantValue( ids, ids[ typeId ].operands[ 1 ] );
+							typeId = ids[ typeId ].operands[ 0 ];
+						}
+						else if ( ids[ typeId ].opcode == OP_TYPE_RUNTIME_ARRAY ) {
+							count = 0;
+							typeId = ids[ typeId ].operands[ 0 ];
+						}
+
+						m_descriptorBindings.push_back(
+							DescriptorBinding {
+								variable.set,
+								variable.binding,
+								getDescriptorType( ids, typeId, storageClass ),
+								count,
+								m_stage,
+								!variable.name.empty() ? variable.name : ids[ typeId ].name,
+							}
+						);
+						break;
+					}
+
+					default:
+						break;
+				}
+			}
+
+			static std::uint32_t getDescriptorType( const std::vector< Id > &ids, std::uint32_t typeId, std::uint32_t storageClass )
+			{
+				const auto &type = ids[ typeId ];
+
+				if ( storageClass == STORAGE_CLASS_STORAGE_BUFFER ) {
+					return DESCRIPTOR_TYPE_STORAGE_BUFFER;
+				}
+
+				if ( storageClass == STORAGE_CLASS_UNIFORM ) {
+					// Older compilers mark storage buffers as BufferBlock in the Uniform storage class
+					return type.isBufferBlock ? DESCRIPTOR_TYPE_STORAGE_BUFFER : DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+				}
+
+				switch ( type.opcode ) {
+					case OP_TYPE_SAMPLER:
+						return DESCRIPTOR_TYPE_SAMPLER;
+
+					case OP_TYPE_SAMPLED_IMAGE:
+						return DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+
+					case OP_TYPE_IMAGE: {
+						// Operands: sampled type, dim, depth, arrayed, MS, sampled, format
+						const auto isBuffer = type.operands[ 1 ] == IMAGE_DIM_BUFFER;
+						const auto isStorage = type.operands[ 5 ] == 2;
+						if ( isBuffer ) {
+							return isStorage ? DESCRIPTOR_TYPE_STORAGE_TEXEL_BUFFER : DESCRIPTOR_TYPE_UNIFORM_TEXEL_BUFFER;
+						}
+						return isStorage ? DESCRIPTOR_TYPE_STORAGE_IMAGE : DESCRIPTOR_TYPE_SAMPLED_IMAGE;
+					}
+
+					default:
+						throw std::runtime_error( "Unsupported SPIR-V descriptor type" );
+				}
+			}
+
+			static std::uint32_t getVertexFormat( const std::vector< Id > &ids, std::uint32_t typeId )
+			{
+				auto componentCount = 1u;
+				auto componentTypeId = typeId;
+				if ( ids[ typeId ].opcode == OP_TYPE_VECTOR ) {
+					componentTypeId = ids[ typeId ].operands[ 0 ];
+					componentCount = ids[ typeId ].operands[ 1 ];
+				}
+
+				const auto &component = ids[ componentTypeId ];
+				if ( componentCount < 1 || componentCount > 4 || component.operands.empty() || component.operands[ 0 ] != 32 ) {
+					return FORMAT_UNDEFINED;
+				}
+
+				// Formats for each component type are three values apart
+				const auto offset = 3 * ( componentCount - 1 );
+				if ( component.opcode == OP_TYPE_FLOAT ) {
+					return FORMAT_R32_SFLOAT + offset;
+				}
+				if ( component.opcode == OP_TYPE_INT ) {
+					const auto isSigned = component.operands[ 1 ] != 0;
+					return ( isSigned ? FORMAT_R32_SINT : FORMAT_R32_UINT ) + offset;
+				}
+
+				return FORMAT_UNDEFINED;
+			}
+
+			/**
+			   \brief Size in bytes of a type, following the explicit layout decorations
+			 */
+			static std::uint32_t getTypeSize( const std::vector< Id > &ids, std::uint32_t typeId )
+			{
+				const auto &type = ids[ typeId ];
+				switch ( type.opcode ) {
+					case OP_TYPE_BOOL:
+						return 4;
+
+					case OP_TYPE_INT:
+					case OP_TYPE_FLOAT:
+						return type.operands[ 0 ] / 8;
+
+					case OP_TYPE_VECTOR:
+						return type.operands[ 1 ] * getTypeSize( ids, type.operands[ 0 ] );
+
+					case OP_TYPE_MATRIX:
+						return type.operands[ 1 ] * getTypeSize( ids, type.operands[ 0 ] );
+
+					case OP_TYPE_ARRAY: {
+						const auto count = getConstantValue( ids, type.operands[ 1 ] );
+						const auto stride = type.arrayStride > 0 ? type.arrayStride : getTypeSize( ids, type.operands[ 0 ] );
+						return count * stride;
+					}
+
+					case OP_TYPE_STRUCT: {
+						std::uint32_t size = 0;
+						for ( std::uint32_t member = 0; member < type.operands.size(); ++member ) {
+							const auto memberTypeId = type.operands[ member ];
+							const auto memberOffset = member < type.memberOffsets.size() ? type.memberOffsets[ member ] : size;
+							auto memberSize = getTypeSize( ids, memberTypeId );
+							if ( ids[ memberTypeId ].opcode == OP_TYPE_MATRIX
+								 && member < type.memberMatrixStrides.size()
+								 && type.memberMatrixStrides[ member ] > 0 ) {
+								memberSize = ids[ memberTypeId ].operands[ 1 ] * type.memberMatrixStrides[ member ];
+							}
+							size = std::max( size, memberOffset + memberSize );
+						}
+						return size;
+					}
+
+					default:
+						return 0;
+				}
+			}
+
+			/**
+			   \brief Offset of the first member of a block
+
+			   Push constant blocks for different stages usually start where
+			   the previous stage's block ends.
+			 */
+			static std::uint32_t getStructOffset( const std::vector< Id > &ids, std::uint32_t typeId )
+			{
+				const auto &type = ids[ typeId ];
+				if ( type.opcode != OP_TYPE_STRUCT || type.memberOffsets.empty() ) {
+					return 0;
+				}
+				return *std::min_element( type.memberOffsets.begin(), type.memberOffsets.end() );
+			}
+
+			static std::uint32_t getConstantValue( const std::vector< Id > &ids, std::uint32_t constantId )
+			{
+				const auto &constant = ids[ constantId ];
+				if ( constant.opcode != OP_CONSTANT && constant.opcode != OP_SPEC_CONSTANT ) {
+					throw std::runtime_error( "Unsupported SPIR-V array length" );
+				}
+				// Operands: result type, result id, value
+				return constant.operands[ 2 ];
+			}
+
+			static std::uint32_t getStageFromExecutionModel( std::uint32_t executionModel )
+			{
+				switch ( executionModel ) {
+					case 0: return STAGE_VERTEX;
+					case 1: return STAGE_TESSELLATION_CONTROL;
+					case 2: return STAGE_TESSELLATION_EVALUATION;
+					case 3: return STAGE_GEOMETRY;
+					case 4: return STAGE_FRAGMENT;
+					case 5: return STAGE_COMPUTE;
+					default:
+						throw std::runtime_error( "Unsupported SPIR-V execution model" );
+				}
+			}
+
+			static std::string readString( const std::uint32_t *words, std::size_t wordCount )
+			{
+				const auto *chars = reinterpret_cast< const char * >( words );
+				std::size_t length = 0;
+				while ( length < wordCount * 4 && chars[ length ] != '\0' ) {
+					++length;
+				}
+				return std::string( chars, length );
+			}
+
+			static void resizeFor( std::vector< std::uint32_t > &values, std::uint32_t index )
+			{
+				if ( values.size() <= index ) {
+					values.resize( index + 1, 0 );
+				}
+			}
+
+			void sort( void )
+			{
+				std::sort(
+					m_descriptorBindings.begin(),
+					m_descriptorBindings.end(),
+					[]( const auto &a, const auto &b ) {
+						return a.set != b.set ? a.set < b.set : a.binding < b.binding;
+					}
+				);
+
+				std::sort(
+					m_vertexInputs.begin(),
+					m_vertexInputs.end(),
+					[]( const auto &a, const auto &b ) { return a.location < b.location; }
+				);
+
+				std::sort(
+					m_specializationConstants.begin(),
+					m_specializationConstants.end(),
+					[]( const auto &a, const auto &b ) { return a.constantID < b.constantID; }
+				);
+			}
+
+		private:
+			std::uint32_t m_stage = 0;
+			std::string m_entryPoint;
+			std::vector< DescriptorBinding > m_descriptorBindings;
+			std::vector< PushConstantRange > m_pushConstantRanges;
+			std::vector< VertexInput > m_vertexInputs;
+			std::vector< SpecializationConstant > m_specializationConstants;
+		};
+
+	}
+
+}
+
+#endif
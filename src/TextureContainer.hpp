@@ -0,0 +1,296 @@
+/*
+ * Copyright (c) 2002 - present, H. Hernan Saez
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the <organization> nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL <COPYRIGHT HOLDER> BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef CRIMILD_VULKAN_TEXTURE_CONTAINER_
+#define CRIMILD_VULKAN_TEXTURE_CONTAINER_
+
+#include "MappedFile.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace crimild {
+
+	namespace vulkan {
+
+		/**
+		   \brief GPU-ready texture container
+
+		   Follows the layout of KTX2 (identifier, header, level index and level data)
+		   without the data format descriptor and key/value blocks. Pixels are stored
+		   exactly as the GPU expects them, so the file can be memory-mapped and copied
+		   into a staging buffer as is, uploading every level and layer with a single
+		   vkCmdCopyBufferToImage.
+
+		   File layout:
+		   - Identifier (12 bytes)
+		   - Header
+		   - Level index (one entry per mip level, level 0 first)
+		   - Level data (smallest level first, so streaming can read the tail first)
+
+		   Each level stores all its array layers contiguously. Level data offsets are
+		   aligned to LEVEL_ALIGNMENT, which satisfies both the 4-byte requirement for
+		   bufferOffset and the texel size of every supported format.
+		 */
+		class TextureContainer {
+		public:
+			static constexpr std::uint8_t IDENTIFIER[ 12 ] = {
+				0xAB, 'C', 'T', 'X', ' ', '1', '0', 0xBB, '\r', '\n', 0x1A, '\n',
+			};
+
+			static constexpr std::uint64_t LEVEL_ALIGNMENT = 16;
+
+			/**
+			   \brief Values match VkFormat so they can be used directly when creating images
+			 */
+			enum Format : std::uint32_t {
+				FORMAT_R8G8B8A8_UNORM = 37,
+				FORMAT_R8G8B8A8_SRGB = 43,
+			};
+
+			enum SupercompressionScheme : std::uint32_t {
+				SUPERCOMPRESSION_NONE = 0,
+			};
+
+			struct Header {
+				std::uint32_t vkFormat;
+				std::uint32_t typeSize;
+				std::uint32_t pixelWidth;
+				std::uint32_t pixelHeight;
+				std::uint32_t layerCount;
+				std::uint32_t levelCount;
+				std::uint32_t supercompressionScheme;
+				std::uint32_t reserved;
+			};
+
+			struct LevelIndex {
+				std::uint64_t byteOffset;
+				std::uint64_t byteLength;
+				std::uint64_t uncompressedByteLength;
+			};
+
+			static std::uint32_t getTexelSize( std::uint32_t format )
+			{
+				switch ( format ) {
+					case FORMAT_R8G8B8A8_UNORM:
+					case FORMAT_R8G8B8A8_SRGB:
+						return 4;
+
+					default:
+						return 0;
+				}
+			}
+
+			static std::uint32_t getLevelExtent( std::uint32_t baseExtent, std::uint32_t level )
+			{
+				auto extent = baseExtent >> level;
+				return extent > 0 ? extent : 1;
+			}
+
+			static std::uint64_t alignOffset( std::uint64_t offset )
+			{
+				return ( offset + LEVEL_ALIGNMENT - 1 ) & ~( LEVEL_ALIGNMENT - 1 );
+			}
+
+		public:
+			TextureContainer( void ) = default;
+
+			TextureContainer( const TextureContainer & ) = delete;
+			TextureContainer &operator=( const TextureContainer & ) = delete;
+
+			~TextureContainer( void )
+			{
+				close();
+			}
+
+			/**
+			   \brief Maps a container file and validates its header and level index
+
+			   Throws if the file cannot be opened or if its contents are not valid.
+			   Level data is not touched until requested, so opening a large file
+			   is cheap.
+			 */
+			void open( const std::string &filename )
+			{
+				close();
+
+				m_file.open( filename );
+
+				try {
+					validate( filename );
+				}
+				catch ( ... ) {
+					close();
+					throw;
+				}
+			}
+
+			void close( void )
+			{
+				m_file.close();
+				m_header = nullptr;
+				m_levels.clear();
+			}
+
+			bool isOpen( void ) const { return m_file.isOpen(); }
+
+			const Header &getHeader( void ) const { return *m_header; }
+
+			std::uint32_t getLevelCount( void ) const { return m_header->levelCount; }
+			std::uint32_t getLayerCount( void ) const { return m_header->layerCount; }
+
+			const LevelIndex &getLevelIndex( std::uint32_t level ) const { return m_levels[ level ]; }
+
+			/**
+			   \brief Size in bytes of a single layer for the given level
+			 */
+			std::uint64_t getLayerSize( std::uint32_t level ) const
+			{
+				return std::uint64_t( getLevelExtent( m_header->pixelWidth, level ) )
+					* getLevelExtent( m_header->pixelHeight, level )
+					* m_header->typeSize;
+			}
+
+			/**
+			   \brief Pointer to the mapped data for a given level (all layers)
+			 */
+			const std::uint8_t *getLevelData( std::uint32_t level ) const
+			{
+				return m_file.getData() + m_levels[ level ].byteOffset;
+			}
+
+			/**
+			   \brief Range covering level data for levels [ firstLevel, endLevel )
+
+			   Since levels are stored smallest first, any run of consecutive levels
+			   (and, in particular, any mip tail) is a single contiguous block of the file.
+			 */
+			void getLevelRange( std::uint32_t firstLevel, std::uint32_t endLevel, std::uint64_t &offset, std::uint64_t &length ) const
+			{
+				auto begin = m_levels[ endLevel - 1 ].byteOffset;
+				auto end = m_levels[ firstLevel ].byteOffset + m_levels[ firstLevel ].byteLength;
+				offset = begin;
+				length = end - begin;
+			}
+
+			const std::uint8_t *getData( void ) const { return m_file.getData(); }
+
+		private:
+			void validate( const std::string &filename )
+			{
+				auto fail = [ &filename ]( const std::string &reason ) {
+					throw std::runtime_error( "Invalid texture container " + filename + ": " + reason );
+				};
+
+				const auto data = m_file.getData();
+				const auto size = m_file.getSize();
+
+				if ( size < sizeof( IDENTIFIER ) + sizeof( Header ) ) {
+					fail( "file too small" );
+				}
+
+				if ( std::memcmp( data, IDENTIFIER, sizeof( IDENTIFIER ) ) != 0 ) {
+					fail( "bad identifier" );
+				}
+
+				m_header = reinterpret_cast< const Header * >( data + sizeof( IDENTIFIER ) );
+
+				if ( m_header->pixelWidth == 0 || m_header->pixelHeight == 0 ) {
+					fail( "invalid extent" );
+				}
+
+				if ( m_header->layerCount == 0 ) {
+					fail( "invalid layer count" );
+				}
+
+				auto maxLevels = 1u;
+				for ( auto extent = std::max( m_header->pixelWidth, m_header->pixelHeight ); extent > 1; extent >>= 1 ) {
+					++maxLevels;
+				}
+				if ( m_header->levelCount == 0 || m_header->levelCount > maxLevels ) {
+					fail( "invalid level count" );
+				}
+
+				if ( getTexelSize( m_header->vkFormat ) == 0 || getTexelSize( m_header->vkFormat ) != m_header->typeSize ) {
+					fail( "unsupported format" );
+				}
+
+				if ( m_header->supercompressionScheme != SUPERCOMPRESSION_NONE ) {
+					fail( "unsupported supercompression scheme" );
+				}
+
+				// Level 0 is the largest, so sizes of every level fit if this one does
+				constexpr auto maxSize = std::numeric_limits< std::uint64_t >::max();
+				auto levelSize = std::uint64_t( m_header->pixelWidth ) * m_header->pixelHeight;
+				if ( levelSize > maxSize / m_header->typeSize || levelSize * m_header->typeSize > maxSize / m_header->layerCount ) {
+					fail( "extent too large" );
+				}
+
+				auto indexOffset = sizeof( IDENTIFIER ) + sizeof( Header );
+				if ( size < indexOffset + m_header->levelCount * sizeof( LevelIndex ) ) {
+					fail( "truncated level index" );
+				}
+
+				// The index is only 4-byte aligned in the file, so copy it
+				m_levels.resize( m_header->levelCount );
+				std::memcpy( m_levels.data(), data + indexOffset, m_header->levelCount * sizeof( LevelIndex ) );
+
+				auto dataStart = indexOffset + m_header->levelCount * sizeof( LevelIndex );
+				for ( std::uint32_t level = 0; level < m_header->levelCount; ++level ) {
+					const auto &index = m_levels[ level ];
+					if ( index.byteOffset < dataStart || index.byteOffset % LEVEL_ALIGNMENT != 0 ) {
+						fail( "misplaced level data" );
+					}
+					if ( index.byteLength != getLayerSize( level ) * m_header->layerCount
+						 || index.uncompressedByteLength != index.byteLength ) {
+						fail( "unexpected level size" );
+					}
+					if ( index.byteOffset > size || index.byteLength > size - index.byteOffset ) {
+						fail( "truncated level data" );
+					}
+					if ( level > 0 && index.byteOffset >= m_levels[ level - 1 ].byteOffset ) {
+						fail( "levels must be stored smallest first" );
+					}
+				}
+			}
+
+		private:
+			MappedFile m_file;
+			const Header *m_header = nullptr;
+			std::vector< LevelIndex > m_levels;
+		};
+
+	}
+
+}
+
+#endif
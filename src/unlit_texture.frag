@@ -1,6 +1,10 @@
 #version 450
 #extension GL_ARB_separate_shader_objects : enable
 
+// Shader features, set per material when the pipeline is created
+layout ( constant_id = 0 ) const bool USE_TEXTURE = true;
+layout ( constant_id = 1 ) const bool USE_VERTEX_COLOR = false;
+
 layout ( location = 0 ) in vec3 fragColor;
 layout ( location = 1 ) in vec2 fragTexCoord;
 
@@ -10,5 +14,13 @@ layout ( location = 0 ) out vec4 outColor;
 
 void main()
 {
-	outColor = texture( texSampler, fragTexCoord );
+	outColor = vec4( 1.0 );
+
+	if ( USE_TEXTURE ) {
+		outColor *= texture( texSampler, fragTexCoord );
+	}
+
+	if ( USE_VERTEX_COLOR ) {
+		outColor.rgb *= fragColor;
+	}
 }
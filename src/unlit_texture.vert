@@ -5,19 +5,25 @@ layout ( location = 0 ) in vec3 inPosition;
 layout ( location = 1 ) in vec3 inColor;
 layout ( location = 2 ) in vec2 inTexCoord;
 
+// Per-instance transform (identity for non-instanced draws)
+layout ( location = 3 ) in mat4 inInstanceModel;
+
 layout ( binding = 0 ) uniform UniformBufferObject {
-    mat4 model;
 	mat4 view;
 	mat4 proj;
 } ubo;
 
+layout ( push_constant ) uniform DrawConstants {
+	mat4 model;
+	uint materialIndex;
+} draw;
+
 layout ( location = 0 ) out vec3 fragColor;
 layout ( location = 1 ) out vec2 fragTexCoord;
 
 void main()
 {
-	gl_Position = ubo.proj * ubo.view * ubo.model * vec4( inPosition, 1.0 );
+	gl_Position = ubo.proj * ubo.view * draw.model * inInstanceModel * vec4( inPosition, 1.0 );
 	fragColor = inColor;
 	fragTexCoord = inTexCoord;
 }
-
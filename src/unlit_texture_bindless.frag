@@ -0,0 +1,41 @@
+#version 450
+#extension GL_ARB_separate_shader_objects : enable
+#extension GL_EXT_nonuniform_qualifier : enable
+
+// Shader features, set per material when the pipeline is created
+layout ( constant_id = 0 ) const bool USE_TEXTURE = true;
+layout ( constant_id = 1 ) const bool USE_VERTEX_COLOR = false;
+
+layout ( location = 0 ) in vec3 fragColor;
+layout ( location = 1 ) in vec2 fragTexCoord;
+layout ( location = 2 ) flat in uint fragMaterialIndex;
+
+struct Material {
+	vec4 color;
+	uint albedoTextureIndex;
+	uint padding0;
+	uint padding1;
+	uint padding2;
+};
+
+layout ( std430, set = 1, binding = 0 ) readonly buffer Materials {
+	Material materials[];
+};
+
+layout ( set = 1, binding = 1 ) uniform sampler2D textures[];
+
+layout ( location = 0 ) out vec4 outColor;
+
+void main()
+{
+	Material material = materials[ fragMaterialIndex ];
+	outColor = material.color;
+
+	if ( USE_TEXTURE ) {
+		outColor *= texture( textures[ nonuniformEXT( material.albedoTextureIndex ) ], fragTexCoord );
+	}
+
+	if ( USE_VERTEX_COLOR ) {
+		outColor.rgb *= fragColor;
+	}
+}
@@ -0,0 +1,32 @@
+#version 450
+#extension GL_ARB_separate_shader_objects : enable
+
+layout ( location = 0 ) in vec3 inPosition;
+layout ( location = 1 ) in vec3 inColor;
+layout ( location = 2 ) in vec2 inTexCoord;
+
+// Per-instance data (identity and 0 for non-instanced draws)
+layout ( location = 3 ) in mat4 inInstanceModel;
+layout ( location = 7 ) in uint inInstanceMaterialIndex;
+
+layout ( set = 0, binding = 0 ) uniform UniformBufferObject {
+	mat4 view;
+	mat4 proj;
+} ubo;
+
+layout ( push_constant ) uniform DrawConstants {
+	mat4 model;
+	uint materialIndex;
+} draw;
+
+layout ( location = 0 ) out vec3 fragColor;
+layout ( location = 1 ) out vec2 fragTexCoord;
+layout ( location = 2 ) flat out uint fragMaterialIndex;
+
+void main()
+{
+	gl_Position = ubo.proj * ubo.view * draw.model * inInstanceModel * vec4( inPosition, 1.0 );
+	fragColor = inColor;
+	fragTexCoord = inTexCoord;
+	fragMaterialIndex = draw.materialIndex + inInstanceMaterialIndex;
+}
@@ -0,0 +1,179 @@
+/*
+ * Copyright (c) 2002 - present, H. Hernan Saez
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the <organization> nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL <COPYRIGHT HOLDER> BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+/**
+   \brief Measures CPU frustum culling throughput
+
+   Usage: crimild-culling-benchmark [objectCount] [iterations]
+
+   Culls random bounding volumes (1M by default) against a perspective
+   frustum with every implementation compiled in, and checks that all of
+   them produce the same visible set as the scalar one.
+ */
+
+#include "SimdCulling.hpp"
+
+#include <chrono>
+#include <functional>
+#include <iostream>
+#include <random>
+#include <string>
+
+using namespace crimild::vulkan;
+
+namespace {
+
+	/**
+	   \brief Perspective projection with Vulkan conventions (y down, depth in [0, 1])
+	 */
+	void computeProjection( float fovY, float aspect, float near, float far, float *proj )
+	{
+		auto f = 1.0f / std::tan( 0.5f * fovY );
+		std::fill( proj, proj + 16, 0.0f );
+		proj[ 0 ] = f / aspect;
+		proj[ 5 ] = -f;
+		proj[ 10 ] = far / ( near - far );
+		proj[ 11 ] = -1.0f;
+		proj[ 14 ] = near * far / ( near - far );
+	}
+
+	using CullFunction = std::function< std::uint32_t( const culling::BoundingVolumes &, const culling::Plane *, std::uint32_t * ) >;
+
+	struct Implementation {
+		std::string name;
+		CullFunction spheres;
+		CullFunction boxes;
+	};
+
+	std::uint32_t run(
+		const Implementation &implementation,
+		const CullFunction &cull,
+		const char *volumeName,
+		const culling::BoundingVolumes &volumes,
+		const culling::Plane *planes,
+		std::uint32_t iterations,
+		std::vector< std::uint32_t > &visible )
+	{
+		// Warm up caches before measuring
+		auto visibleCount = cull( volumes, planes, visible.data() );
+
+		auto start = std::chrono::high_resolution_clock::now();
+		for ( std::uint32_t i = 0; i < iterations; ++i ) {
+			visibleCount = cull( volumes, planes, visible.data() );
+		}
+		auto elapsed = std::chrono::duration< double, std::milli >( std::chrono::high_resolution_clock::now() - start ).count() / iterations;
+
+		std::cout << implementation.name << " " << volumeName << ": "
+				  << elapsed << "ms, "
+				  << volumes.getCount() / ( elapsed * 1000.0 ) << "M objects/s, "
+				  << visibleCount << " visible"
+				  << std::endl;
+
+		return visibleCount;
+	}
+
+	bool matches( const std::vector< std::uint32_t > &expected, std::uint32_t expectedCount, const std::vector< std::uint32_t > &visible, std::uint32_t visibleCount )
+	{
+		return expectedCount == visibleCount && std::equal( expected.begin(), expected.begin() + expectedCount, visible.begin() );
+	}
+
+}
+
+int main( int argc, char **argv )
+{
+	std::uint32_t objectCount = argc > 1 ? std::stoul( argv[ 1 ] ) : 1000000;
+	std::uint32_t iterations = argc > 2 ? std::stoul( argv[ 2 ] ) : 100;
+
+	if ( objectCount == 0 || iterations == 0 ) {
+		std::cerr << "Usage: " << argv[ 0 ] << " [objectCount] [iterations]" << std::endl;
+		return 1;
+	}
+
+	// Camera at the origin looking down -Z, so only a small fraction of the objects is visible
+	float proj[ 16 ];
+	computeProjection( 45.0f * 3.14159265f / 180.0f, 16.0f / 9.0f, 0.1f, 1000.0f, proj );
+	culling::Plane planes[ culling::PLANE_COUNT ];
+	culling::extractFrustumPlanes( proj, planes );
+
+	std::mt19937 generator( 1234 );
+	std::uniform_real_distribution< float > position( -1000.0f, 1000.0f );
+	std::uniform_real_distribution< float > size( 0.5f, 5.0f );
+
+	culling::BoundingVolumes volumes;
+	volumes.reserve( objectCount );
+	for ( std::uint32_t i = 0; i < objectCount; ++i ) {
+		const float center[ 3 ] = { position( generator ), position( generator ), position( generator ) };
+		const float extent[ 3 ] = { size( generator ), size( generator ), size( generator ) };
+		const float min[ 3 ] = { center[ 0 ] - extent[ 0 ], center[ 1 ] - extent[ 1 ], center[ 2 ] - extent[ 2 ] };
+		const float max[ 3 ] = { center[ 0 ] + extent[ 0 ], center[ 1 ] + extent[ 1 ], center[ 2 ] + extent[ 2 ] };
+		volumes.addBox( min, max );
+	}
+
+	std::vector< Implementation > implementations = {
+		{ "scalar", culling::cullSpheresScalar, culling::cullBoxesScalar },
+#if defined( CRIMILD_CULLING_SSE )
+		{ "sse2", culling::cullSpheresSSE, culling::cullBoxesSSE },
+#endif
+#if defined( CRIMILD_CULLING_AVX )
+		{ "avx", culling::cullSpheresAVX, culling::cullBoxesAVX },
+#endif
+	};
+
+	std::cout << "Culling " << objectCount << " objects, " << iterations << " iterations" << std::endl;
+
+	std::vector< std::uint32_t > expectedSpheres( objectCount );
+	std::vector< std::uint32_t > expectedBoxes( objectCount );
+	std::vector< std::uint32_t > visible( objectCount );
+	std::uint32_t expectedSphereCount = 0;
+	std::uint32_t expectedBoxCount = 0;
+
+	auto success = true;
+	for ( const auto &implementation : implementations ) {
+		auto isReference = &implementation == &implementations.front();
+
+		auto sphereCount = run( implementation, implementation.spheres, "spheres", volumes, planes, iterations, isReference ? expectedSpheres : visible );
+		if ( isReference ) {
+			expectedSphereCount = sphereCount;
+		}
+		else if ( !matches( expectedSpheres, expectedSphereCount, visible, sphereCount ) ) {
+			std::cerr << implementation.name << " spheres don't match scalar results" << std::endl;
+			success = false;
+		}
+
+		auto boxCount = run( implementation, implementation.boxes, "boxes", volumes, planes, iterations, isReference ? expectedBoxes : visible );
+		if ( isReference ) {
+			expectedBoxCount = boxCount;
+		}
+		else if ( !matches( expectedBoxes, expectedBoxCount, visible, boxCount ) ) {
+			std::cerr << implementation.name << " boxes don't match scalar results" << std::endl;
+			success = false;
+		}
+	}
+
+	return success ? 0 : 1;
+}
@@ -0,0 +1,265 @@
+/*
+ * Copyright (c) 2002 - present, H. Hernan Saez
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the <organization> nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL <COPYRIGHT HOLDER> BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+   \brief Bakes images into GPU-ready texture containers
+
+   Usage: crimild-texture-bake [--srgb] [--no-mips] -o output.ctex input0 [input1 ...]
+
+   Each input becomes one array layer, so all inputs must share the same size.
+   The renderer only streams single-layer containers for now, since its
+   shaders don't sample texture arrays.
+   Mipmaps are computed offline with a box filter, which removes the need
+   for blitting levels at load time.
+ */
+
+#define STB_IMAGE_IMPLEMENTATION
+#include "stb_image.h"
+
+#include "TextureContainer.hpp"
+
+#include <cmath>
+#include <iostream>
+
+using namespace crimild::vulkan;
+
+namespace {
+
+	struct Image {
+		std::uint32_t width;
+		std::uint32_t height;
+		std::vector< std::uint8_t > pixels;
+	};
+
+	Image loadImage( const std::string &filename )
+	{
+		int width, height, channels;
+		auto pixels = stbi_load( filename.c_str(), &width, &height, &channels, STBI_rgb_alpha );
+		if ( pixels == nullptr ) {
+			throw std::runtime_error( "Failed to load image: " + filename );
+		}
+
+		auto image = Image {
+			static_cast< std::uint32_t >( width ),
+			static_cast< std::uint32_t >( height ),
+			std::vector< std::uint8_t >( pixels, pixels + width * height * 4 ),
+		};
+
+		stbi_image_free( pixels );
+
+		return image;
+	}
+
+	float srgbToLinear( std::uint8_t value )
+	{
+		auto c = value / 255.0f;
+		return c <= 0.04045f ? c / 12.92f : std::pow( ( c + 0.055f ) / 1.055f, 2.4f );
+	}
+
+	std::uint8_t linearToSrgb( float value )
+	{
+		auto c = value <= 0.0031308f ? value * 12.92f : 1.055f * std::pow( value, 1.0f / 2.4f ) - 0.055f;
+		return static_cast< std::uint8_t >( std::clamp( c * 255.0f + 0.5f, 0.0f, 255.0f ) );
+	}
+
+	/**
+	   \brief Computes the next mip level using a 2x2 box filter
+
+	   Odd dimensions clamp to the last row/column, so non power-of-two images
+	   are supported too. sRGB color channels are averaged in linear space,
+	   since averaging encoded values darkens every level. Alpha is always linear.
+	 */
+	Image downsample( const Image &src, bool srgb )
+	{
+		auto dst = Image {
+			TextureContainer::getLevelExtent( src.width, 1 ),
+			TextureContainer::getLevelExtent( src.height, 1 ),
+			{},
+		};
+		dst.pixels.resize( dst.width * dst.height * 4 );
+
+		// Decoding is done once per possible value instead of once per texel
+		float toLinear[ 256 ];
+		for ( auto i = 0; i < 256; ++i ) {
+			toLinear[ i ] = srgbToLinear( static_cast< std::uint8_t >( i ) );
+		}
+
+		for ( std::uint32_t y = 0; y < dst.height; ++y ) {
+			auto y0 = std::min( 2 * y, src.height - 1 );
+			auto y1 = std::min( 2 * y + 1, src.height - 1 );
+			for ( std::uint32_t x = 0; x < dst.width; ++x ) {
+				auto x0 = std::min( 2 * x, src.width - 1 );
+				auto x1 = std::min( 2 * x + 1, src.width - 1 );
+				for ( std::uint32_t c = 0; c < 4; ++c ) {
+					const std::uint8_t texels[ 4 ] = {
+						src.pixels[ ( y0 * src.width + x0 ) * 4 + c ],
+						src.pixels[ ( y0 * src.width + x1 ) * 4 + c ],
+						src.pixels[ ( y1 * src.width + x0 ) * 4 + c ],
+						src.pixels[ ( y1 * src.width + x1 ) * 4 + c ],
+					};
+					auto &result = dst.pixels[ ( y * dst.width + x ) * 4 + c ];
+					if ( srgb && c < 3 ) {
+						auto sum = toLinear[ texels[ 0 ] ] + toLinear[ texels[ 1 ] ] + toLinear[ texels[ 2 ] ] + toLinear[ texels[ 3 ] ];
+						result = linearToSrgb( 0.25f * sum );
+					}
+					else {
+						auto sum = std::uint32_t( texels[ 0 ] ) + texels[ 1 ] + texels[ 2 ] + texels[ 3 ];
+						result = static_cast< std::uint8_t >( ( sum + 2 ) / 4 );
+					}
+				}
+			}
+		}
+
+		return dst;
+	}
+
+	void bake( const std::vector< std::string > &inputs, const std::string &output, bool srgb, bool generateMips )
+	{
+		// levels[ level ][ layer ]
+		std::vector< std::vector< Image >> levels( 1 );
+		for ( const auto &input : inputs ) {
+			levels[ 0 ].push_back( loadImage( input ) );
+			const auto &base = levels[ 0 ].front();
+			const auto &layer = levels[ 0 ].back();
+			if ( layer.width != base.width || layer.height != base.height ) {
+				throw std::runtime_error( "All layers must have the same size: " + input );
+			}
+		}
+
+		const auto width = levels[ 0 ][ 0 ].width;
+		const auto height = levels[ 0 ][ 0 ].height;
+
+		if ( generateMips ) {
+			while ( levels.back()[ 0 ].width > 1 || levels.back()[ 0 ].height > 1 ) {
+				std::vector< Image > next;
+				for ( const auto &layer : levels.back() ) {
+					next.push_back( downsample( layer, srgb ) );
+				}
+				levels.push_back( std::move( next ) );
+			}
+		}
+
+		const auto levelCount = static_cast< std::uint32_t >( levels.size() );
+		const auto layerCount = static_cast< std::uint32_t >( inputs.size() );
+
+		auto header = TextureContainer::Header {
+			srgb ? TextureContainer::FORMAT_R8G8B8A8_SRGB : TextureContainer::FORMAT_R8G8B8A8_UNORM,
+			4,
+			width,
+			height,
+			layerCount,
+			levelCount,
+			TextureContainer::SUPERCOMPRESSION_NONE,
+			0,
+		};
+
+		// Smallest levels go first so streaming can load the mip tail with a single read
+		std::vector< TextureContainer::LevelIndex > index( levelCount );
+		std::uint64_t offset = sizeof( TextureContainer::IDENTIFIER )
+			+ sizeof( TextureContainer::Header )
+			+ levelCount * sizeof( TextureContainer::LevelIndex );
+		for ( auto level = levelCount; level-- > 0; ) {
+			offset = TextureContainer::alignOffset( offset );
+			auto length = std::uint64_t( levels[ level ][ 0 ].pixels.size() ) * layerCount;
+			index[ level ] = TextureContainer::LevelIndex { offset, length, length };
+			offset += length;
+		}
+
+		std::ofstream file( output, std::ios::binary | std::ios::trunc );
+		if ( !file.is_open() ) {
+			throw std::runtime_error( "Failed to open output file: " + output );
+		}
+
+		file.write( reinterpret_cast< const char * >( TextureContainer::IDENTIFIER ), sizeof( TextureContainer::IDENTIFIER ) );
+		file.write( reinterpret_cast< const char * >( &header ), sizeof( header ) );
+		file.write( reinterpret_cast< const char * >( index.data() ), index.size() * sizeof( TextureContainer::LevelIndex ) );
+
+		for ( auto level = levelCount; level-- > 0; ) {
+			static const char padding[ TextureContainer::LEVEL_ALIGNMENT ] = {};
+			auto position = static_cast< std::uint64_t >( file.tellp() );
+			file.write( padding, index[ level ].byteOffset - position );
+			for ( const auto &layer : levels[ level ] ) {
+				file.write( reinterpret_cast< const char * >( layer.pixels.data() ), layer.pixels.size() );
+			}
+		}
+
+		if ( !file.good() ) {
+			throw std::runtime_error( "Failed to write output file: " + output );
+		}
+
+		std::cout << "Baked " << output << ": "
+				  << width << "x" << height << ", "
+				  << levelCount << " levels, "
+				  << layerCount << " layers, "
+				  << offset << " bytes"
+				  << std::endl;
+	}
+
+}
+
+int main( int argc, char **argv )
+{
+	std::vector< std::string > inputs;
+	std::string output;
+	auto srgb = false;
+	auto generateMips = true;
+
+	for ( auto i = 1; i < argc; ++i ) {
+		std::string arg = argv[ i ];
+		if ( arg == "--srgb" ) {
+			srgb = true;
+		}
+		else if ( arg == "--no-mips" ) {
+			generateMips = false;
+		}
+		else if ( arg == "-o" && i + 1 < argc ) {
+			output = argv[ ++i ];
+		}
+		else {
+			inputs.push_back( arg );
+		}
+	}
+
+	if ( inputs.empty() || output.empty() ) {
+		std::cerr << "Usage: " << argv[ 0 ] << " [--srgb] [--no-mips] -o output.ctex input0 [input1 ...]" << std::endl;
+		return 1;
+	}
+
+	try {
+		bake( inputs, output, srgb, generateMips );
+
+		// Make sure the result is readable by the runtime loader
+		TextureContainer container;
+		container.open( output );
+	}
+	catch ( const std::exception &e ) {
+		std::cerr << e.what() << std::endl;
+		return 1;
+	}
+
+	return 0;
+}